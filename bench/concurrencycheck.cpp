@@ -0,0 +1,363 @@
+﻿/*! \file concurrencycheck.cpp
+    \brief 並列に実行した固有値の検索とSCFが、一つずつ実行した結果と一致するかを確かめるテスト
+
+    まず、H原子の各軌道の固有値の検索を一つずつ解き、次に同じ設定の検索をrepeat回ずつ、
+    grainsize = 1のparallel_forで一つの検索を一つのタスクにして同時に解いて、
+    根を挟む区間と固有値がビット単位で一致するかを確かめる
+    次に、SCF全体（He原子、Li原子、Ne原子）を同じように一つずつと同時に解いて、固有値と密度が
+    ビット単位で一致するか、及びTBBを使わずに解いた結果と許容誤差の範囲で一致するかを確かめる
+    どの計算も決まった手順で進むので、タスクの割り振りによらず結果は同じになるはずである
+    一致しないものがあれば、その差を表示して0以外の終了コードを返す
+    使い方: concurrencycheck [同時に解く回数（デフォルト = 8）]
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "../src/eigenvaluesearch.h"
+#include "../src/scfloop.h"
+#include "../src/shellscf.h"
+#include <algorithm>                // for std::max
+#include <cmath>                    // for std::exp, std::fabs
+#include <cstdint>                  // for std::int32_t
+#include <cstdio>                   // for std::printf
+#include <cstdlib>                  // for std::atoi
+#include <filesystem>               // for std::filesystem
+#include <fstream>                  // for std::ofstream
+#include <memory>                   // for std::make_shared
+#include <string>                   // for std::string
+#include <utility>                  // for std::make_pair
+#include <vector>                   // for std::vector
+#include <boost/format.hpp>         // for boost::format
+#include <tbb/blocked_range.h>      // for tbb::blocked_range
+#include <tbb/parallel_for.h>       // for tbb::parallel_for
+#include <tbb/partitioner.h>        // for tbb::simple_partitioner
+
+namespace {
+    //! A global variable.
+    /*!
+        何も書き出さないストリーム（計算中のメッセージを捨てる）
+    */
+    std::ostream nullos(nullptr);
+
+    //! A global variable (constant expression).
+    /*!
+        固有値の差の許容誤差
+    */
+    auto constexpr EIGEN_TOLERANCE = 1.0E-9;
+
+    //! A global variable (constant expression).
+    /*!
+        密度の差の許容誤差（密度の最大値に対する比率）
+    */
+    auto constexpr RHO_TOLERANCE = 1.0E-7;
+
+    //! A struct.
+    /*!
+        一つの殻の計算結果
+    */
+    struct Orbital final {
+        //! A public member variable.
+        /*!
+            固有値
+        */
+        double E;
+
+        //! A public member variable.
+        /*!
+            規格化された動径波動関数の2乗（密度）
+        */
+        std::vector<double> rho;
+    };
+
+    //! A struct.
+    /*!
+        一回の固有値の検索の結果
+    */
+    struct Search final {
+        //! A public member variable.
+        /*!
+            固有値が見つかったかどうか
+        */
+        bool ok;
+
+        //! A public member variable.
+        /*!
+            大まかな検索で求めた、根を挟む区間の小さい方
+        */
+        double Emin;
+
+        //! A public member variable.
+        /*!
+            大まかな検索で求めた、根を挟む区間の大きい方
+        */
+        double Emax;
+
+        //! A public member variable.
+        /*!
+            固有値
+        */
+        double E;
+    };
+
+    //! A function.
+    /*!
+        インプットファイルを作成する
+        \param symbol 元素記号
+        \param orbital 軌道
+        \return 作成したインプットファイル名
+    */
+    std::string make_input(std::string const & symbol, std::string const & orbital)
+    {
+        auto const filename = (std::filesystem::temp_directory_path() /
+            (boost::format("concurrencycheck_%s_%s.inp") % symbol % orbital).str()).string();
+
+        std::ofstream ofs(filename);
+        ofs << "chemical.symbol " << symbol << '\n'
+            << "orbital " << orbital << '\n'
+            << "spin.orbital alpha\n"
+            << "eq.type sch\n"
+            << "grid.xmin -10.0\n"
+            << "grid.xmax 4.0\n"
+            << "grid.num 4000\n"
+            << "eps 1.0E-10\n"
+            << "solver.type Numerov\n"
+            << "potential.table Yes\n"
+            << "search.LowerE Auto\n"
+            << "num.of.partition 300\n"
+            << "matching.point.ratio 0.67\n"
+            << "rho0.c Auto\n"
+            << "rho0.alpha Auto\n"
+            << "scf.maxIter 200\n"
+            << "scf.Mixing.Weight 0.5\n"
+            << "scf.criterion 1.0E-10\n";
+
+        return filename;
+    }
+
+    //! A function.
+    /*!
+        インプットファイルの設定で、TBBを使って固有値を一回検索する（H原子のみ）
+        \param inpname インプットファイル名
+        \return 検索の結果
+    */
+    Search search(std::string const & inpname)
+    {
+        using namespace schrac;
+
+        auto const pdata = ScfLoop::read_input(std::make_pair(inpname, true), nullos);
+
+        // ScfLoop::initialize()と同じメッシュを作る
+        auto const pdiffdata = std::make_shared<DiffData>(pdata);
+        pdiffdata->r_mesh_.reserve(pdata->grid_num_ + 1);
+        for (auto i = 0; i <= pdata->grid_num_; i++) {
+            pdiffdata->r_mesh_.push_back(std::exp(pdata->xmin_ + static_cast<double>(i) * pdiffdata->dx_));
+        }
+
+        pdiffdata->psimpson_ = std::make_shared<Simpson>(pdiffdata->dx_, pdiffdata->r_mesh_);
+
+        EigenValueSearch evs(pdata, pdiffdata, nullptr, nullptr);
+        auto const ok = evs.search();
+        auto const [Emin, Emax] = evs.PBracket();
+
+        return { ok, Emin, Emax, evs.PDiffSolver()->E_ };
+    }
+
+    //! A template function.
+    /*!
+        size個の計算をrepeat回ずつ、一つの計算を一つのタスクにして同時に実行する
+        \param size 計算の種類の数
+        \param repeat 同じ計算を繰り返す回数
+        \param func i番目の計算を実行する関数
+        \return 計算の結果（i * size + j番目がj番目の計算のi回目の結果）
+    */
+    template <typename Result, typename Function>
+    std::vector<Result> run_concurrently(std::size_t size, std::int32_t repeat, Function const & func)
+    {
+        std::vector<Result> results(size * static_cast<std::size_t>(repeat));
+
+        // grainsize = 1とsimple_partitionerで、タスクをまとめずにできるだけ多くの計算を同時に走らせる
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, results.size(), 1),
+            [&results, &func, size](tbb::blocked_range<std::size_t> const & range) {
+                for (auto i = range.begin(); i != range.end(); ++i) {
+                    results[i] = func(i % size);
+                }
+            },
+            tbb::simple_partitioner());
+
+        return results;
+    }
+
+    //! A function.
+    /*!
+        インプットファイルを解いて、各殻の固有値と密度を返す
+        \param inpname インプットファイル名
+        \param usetbb TBBを使用するかどうか
+        \return 内側の殻から順に並べた、各殻の計算結果
+    */
+    std::vector<Orbital> run(std::string const & inpname, bool usetbb)
+    {
+        using namespace schrac;
+
+        auto const pdata = ScfLoop::read_input(std::make_pair(inpname, usetbb), nullos);
+
+        std::vector<ScfLoop::mypair> results;
+        if (pdata->shells_.empty()) {
+            ScfLoop sl(pdata);
+            results.push_back(sl());
+        }
+        else {
+            ShellScf ss(pdata);
+            results = ss();
+        }
+
+        std::vector<Orbital> orbitals;
+        for (auto const & [pdiffdata, wavefunctions] : results) {
+            Orbital orbital{ pdiffdata->E_, wavefunctions.at("2 Eigen function") };
+            for (auto && rf : orbital.rho) {
+                rf *= rf;
+            }
+
+            orbitals.push_back(std::move(orbital));
+        }
+
+        return orbitals;
+    }
+
+    //! A function.
+    /*!
+        一つずつ実行した検索と同時に実行した検索の、根を挟む区間と固有値がビット単位で一致するかを調べる
+        \param name 比較する計算の名前
+        \param alone 一つずつ実行した検索の結果
+        \param concurrent 同時に実行した検索の結果
+        \return 一致したかどうか
+    */
+    bool compare_exact(std::string const & name, Search const & alone, Search const & concurrent)
+    {
+        auto const ok = alone.ok && concurrent.ok &&
+                        alone.Emin == concurrent.Emin &&
+                        alone.Emax == concurrent.Emax &&
+                        alone.E == concurrent.E;
+
+        std::printf("%s\t%s\t[%.15f, %.15f]\tE = %.15f\n",
+            name.c_str(), ok ? "OK" : "NG", concurrent.Emin, concurrent.Emax, concurrent.E);
+
+        return ok;
+    }
+
+    //! A function.
+    /*!
+        一つずつ実行したSCFと同時に実行したSCFの、各殻の固有値と密度がビット単位で一致するかを調べる
+        \param name 比較する計算の名前
+        \param alone 一つずつ実行したSCFの結果
+        \param concurrent 同時に実行したSCFの結果
+        \return 一致したかどうか
+    */
+    bool compare_exact(std::string const & name, std::vector<Orbital> const & alone, std::vector<Orbital> const & concurrent)
+    {
+        auto ok = alone.size() == concurrent.size();
+        for (auto i = 0U; ok && i < alone.size(); i++) {
+            ok = alone[i].E == concurrent[i].E && alone[i].rho == concurrent[i].rho;
+        }
+
+        std::printf("%s\t%s\n", name.c_str(), ok ? "OK" : "NG");
+
+        return ok;
+    }
+
+    //! A function.
+    /*!
+        TBBを使わずに解いた結果とTBBを使って解いた結果を、許容誤差の範囲で比較する
+        \param name 比較する計算の名前
+        \param serial TBBを使わずに解いた結果
+        \param parallel TBBを使って解いた結果
+        \return 一致したかどうか
+    */
+    bool compare(std::string const & name, std::vector<Orbital> const & serial, std::vector<Orbital> const & parallel)
+    {
+        if (serial.size() != parallel.size()) {
+            std::printf("%s\tNG\t殻の数が異なります（%zu != %zu）\n", name.c_str(), serial.size(), parallel.size());
+            return false;
+        }
+
+        auto ok = true;
+        for (auto i = 0U; i < serial.size(); i++) {
+            auto const & s = serial[i];
+            auto const & p = parallel[i];
+
+            auto rhomax = 0.0;
+            auto drho = 0.0;
+            for (auto j = 0U; j < s.rho.size() && j < p.rho.size(); j++) {
+                rhomax = std::max(rhomax, std::fabs(s.rho[j]));
+                drho = std::max(drho, std::fabs(s.rho[j] - p.rho[j]));
+            }
+
+            auto const dE = std::fabs(s.E - p.E);
+            auto const thisok = s.rho.size() == p.rho.size() &&
+                                dE <= EIGEN_TOLERANCE &&
+                                drho <= RHO_TOLERANCE * rhomax;
+
+            std::printf("%s\t%u\t%s\tE = %.12f\tdE = %.1e\tdrho = %.1e\n",
+                name.c_str(), i, thisok ? "OK" : "NG", s.E, dE, rhomax > 0.0 ? drho / rhomax : drho);
+
+            ok = ok && thisok;
+        }
+
+        return ok;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    auto const repeat = argc > 1 ? std::max(1, std::atoi(argv[1])) : 8;
+    auto ok = true;
+
+    // 固有値の検索だけを、同じ設定で同時に繰り返す（H原子の各軌道）
+    std::vector<std::string> const orbitals = { "1s", "2s", "2p", "3s" };
+
+    std::vector<std::string> searchinps;
+    std::vector<Search> searchalone;
+    for (auto const & orbital : orbitals) {
+        searchinps.push_back(make_input("H", orbital));
+        searchalone.push_back(search(searchinps.back()));
+    }
+
+    auto const searchconcurrent = run_concurrently<Search>(searchinps.size(), repeat, [&searchinps](std::size_t i) {
+        return search(searchinps[i]);
+    });
+
+    for (auto i = 0U; i < searchconcurrent.size(); i++) {
+        auto const j = i % searchinps.size();
+        ok = compare_exact("search H " + orbitals[j], searchalone[j], searchconcurrent[i]) && ok;
+    }
+
+    // SCF全体を同時に繰り返す（一つの軌道を解く場合と、複数の殻を解く場合）
+    std::vector<std::pair<std::string, std::string>> const atoms = {
+        { "He", "1s" }, { "Li", "2s" }, { "Ne", "2p" }
+    };
+
+    std::vector<std::string> scfinps;
+    std::vector<std::vector<Orbital>> scfalone;
+    for (auto const & [symbol, orbital] : atoms) {
+        scfinps.push_back(make_input(symbol, orbital));
+        scfalone.push_back(run(scfinps.back(), true));
+
+        // TBBを使うかどうかで計算の順番が変わるので、TBBを使わない結果とは許容誤差の範囲で比べる
+        ok = compare(symbol + ' ' + orbital, run(scfinps.back(), false), scfalone.back()) && ok;
+    }
+
+    auto const scfconcurrent = run_concurrently<std::vector<Orbital>>(scfinps.size(), repeat, [&scfinps](std::size_t i) {
+        return run(scfinps[i], true);
+    });
+
+    for (auto i = 0U; i < scfconcurrent.size(); i++) {
+        auto const j = i % scfinps.size();
+        auto const & [symbol, orbital] = atoms[j];
+        ok = compare_exact("scf " + symbol + ' ' + orbital, scfalone[j], scfconcurrent[i]) && ok;
+    }
+
+    std::printf(ok ? "All results match.\n" : "Some results do not match.\n");
+
+    return ok ? 0 : 1;
+}
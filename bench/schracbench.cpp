@@ -0,0 +1,471 @@
+﻿/*! \file schracbench.cpp
+    \brief 数値計算のカーネルと、SCF全体の実行時間を計測するベンチマーク
+
+    結果は「名前<TAB>条件<TAB>値<TAB>単位」の形式で、常に同じ順番で書き出すので、
+    異なるビルドの結果をそのままdiffで比較できる
+    使い方: schracbench [結果を書き出すファイル名] [比較する過去の結果のファイル名]
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "../src/diffsolver.h"
+#include "../src/energy.h"
+#include "../src/normalization.h"
+#include "../src/readinputfile.h"
+#include "../src/scfloop.h"
+#include "../src/schnormalize.h"
+#include "../src/simpson.h"
+#include "../src/solvestats.h"
+#include <algorithm>                // for std::max, std::min
+#include <atomic>                   // for std::atomic
+#include <chrono>                   // for std::chrono
+#include <cmath>                    // for std::exp
+#include <cstdint>                  // for std::int32_t, std::uint64_t
+#include <cstdio>                   // for std::fprintf, std::printf
+#include <cstdlib>                  // for std::free, std::malloc
+#include <filesystem>               // for std::filesystem
+#include <fstream>                  // for std::ifstream, std::ofstream
+#include <map>                      // for std::map
+#include <memory>                   // for std::make_shared, std::shared_ptr
+#include <new>                      // for std::bad_alloc
+#include <sstream>                  // for std::istringstream
+#include <string>                   // for std::string
+#include <utility>                  // for std::move
+#include <vector>                   // for std::vector
+#include <boost/container/flat_map.hpp>  // for boost::container::flat_map
+#include <boost/format.hpp>         // for boost::format
+
+namespace {
+    //! A global variable.
+    /*!
+        計測した関数の戻り値を書き込む変数（最適化で呼び出しが消えないようにする）
+    */
+    volatile double sink;
+
+    //! A global variable.
+    /*!
+        operator newが呼ばれた回数（ヒープ確保の回数を数えるためのフック）
+    */
+    std::atomic<std::uint64_t> allocations(0);
+
+    //! A global variable.
+    /*!
+        何も書き出さないストリーム（計算中のメッセージを捨てる）
+    */
+    std::ostream nullos(nullptr);
+
+    //! A global variable.
+    /*!
+        比較する過去の結果（名前と条件の組から値への写像）
+    */
+    std::map<std::string, double> reference;
+
+    //! A global variable.
+    /*!
+        結果を書き出すファイル
+    */
+    std::ofstream output;
+
+    //! A function.
+    /*!
+        関数オブジェクトを繰り返し呼び出し、一回あたりの時間を返す
+        一回の計測がおよそtargetミリ秒になるように繰り返し回数を決め、repeat回計測した中の最小値を返す
+        \param func 計測する関数オブジェクト
+        \param target 一回の計測の目安の時間（ミリ秒）
+        \param repeat 計測の回数
+        \return 一回あたりの時間（ミリ秒）
+    */
+    template <typename Func>
+    double measure(Func const & func, double target = 100.0, std::int32_t repeat = 5)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // 一度呼び出して（キャッシュなどを温めて）、繰り返し回数を決める
+        auto start = clock::now();
+        auto sum = func();
+        auto const once = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        auto const loop = std::max(1, static_cast<std::int32_t>(target / std::max(once, 1.0E-6)));
+
+        auto best = once;
+        for (auto i = 0; i < repeat; i++) {
+            start = clock::now();
+            for (auto j = 0; j < loop; j++) {
+                sum += func();
+            }
+            best = std::min(best, std::chrono::duration<double, std::milli>(clock::now() - start).count() / static_cast<double>(loop));
+        }
+        sink = sum;
+
+        return best;
+    }
+
+    //! A function.
+    /*!
+        関数オブジェクトを一度呼び出したときの、ヒープ確保の回数を返す
+        最初の呼び出しで確保して使い回す領域は数えないように、二回目の呼び出しで数える
+        \param func 計測する関数オブジェクト
+        \return ヒープ確保の回数
+    */
+    template <typename Func>
+    double count_allocations(Func const & func)
+    {
+        sink = func();
+
+        auto const before = allocations.load(std::memory_order_relaxed);
+        sink = func();
+
+        return static_cast<double>(allocations.load(std::memory_order_relaxed) - before);
+    }
+
+    //! A function.
+    /*!
+        結果を一行表示し、ファイルに書き出す
+        \param name ベンチマークの名前
+        \param param ベンチマークの条件
+        \param value 値
+        \param unit 値の単位
+    */
+    void record(std::string const & name, std::string const & param, double value, char const * unit)
+    {
+        auto const line = (boost::format("%s\t%s\t%.6g\t%s") % name % param % value % unit).str();
+
+        if (auto const itr = reference.find(name + '\t' + param); itr != reference.end() && itr->second != 0.0) {
+            std::printf("%s\t(ratio = %.3f)\n", line.c_str(), value / itr->second);
+        }
+        else {
+            std::printf("%s\n", line.c_str());
+        }
+        std::fflush(stdout);
+
+        if (output) {
+            output << line << '\n';
+        }
+    }
+
+    //! A function.
+    /*!
+        比較する過去の結果を読み込む
+        \param filename 過去の結果のファイル名
+    */
+    void read_reference(std::string const & filename)
+    {
+        std::ifstream ifs(filename);
+        std::string line;
+        while (std::getline(ifs, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            std::istringstream iss(line);
+            std::string name, param, value;
+            if (std::getline(iss, name, '\t') && std::getline(iss, param, '\t') && std::getline(iss, value, '\t')) {
+                reference[name + '\t' + param] = std::stod(value);
+            }
+        }
+    }
+
+    //! A function.
+    /*!
+        インプットファイルを作成する
+        \param symbol 元素記号
+        \param eqtype 方程式のタイプ
+        \param solvertype ソルバーのタイプ
+        \param poissontype Poisson方程式の解法
+        \param grid_num グリッドの数
+        \return 作成したインプットファイル名
+    */
+    std::string make_input(
+        std::string const & symbol,
+        std::string const & eqtype,
+        std::string const & solvertype,
+        std::string const & poissontype,
+        std::int32_t grid_num)
+    {
+        auto const filename = (std::filesystem::temp_directory_path() /
+            (boost::format("schracbench_%s_%s_%s_%s_%d.inp") % symbol % eqtype % solvertype % poissontype % grid_num).str()).string();
+
+        std::ofstream ofs(filename);
+        ofs << "chemical.symbol " << symbol << '\n'
+            << "orbital 1s\n"
+            << "spin.orbital alpha\n"
+            << "eq.type " << eqtype << '\n'
+            << "grid.xmin -8.0\n"
+            << "grid.xmax 6.0\n"
+            << "grid.num " << grid_num << '\n'
+            << "eps 1.0E-10\n"
+            << "solver.type " << solvertype << '\n'
+            << "potential.table Yes\n"
+            << "poisson.type " << poissontype << '\n'
+            << "search.LowerE Auto\n"
+            << "num.of.partition 300\n"
+            << "matching.point.ratio 0.67\n"
+            << "rho0.c Auto\n"
+            << "rho0.alpha Auto\n"
+            << "scf.maxIter 100\n"
+            << "scf.Mixing.Weight 1.0\n"
+            << "scf.criterion 1.0E-12\n";
+
+        return filename;
+    }
+
+    //! A struct.
+    /*!
+        ScfLoopの初期化と同じ手順で、最初のSCFのステップの直前の状態を作る
+    */
+    struct Kernel final {
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param inpname インプットファイル名
+        */
+        explicit Kernel(std::string const & inpname)
+        {
+            using namespace schrac;
+
+            ReadInputFile rif(std::make_pair(inpname, false));
+            rif.readFile();
+            pdata = rif.PData;
+            pdata->pout_ = &nullos;
+
+            pdiffdata = std::make_shared<DiffData>(pdata);
+            pdiffdata->r_mesh_.reserve(pdata->grid_num_ + 1);
+            for (auto i = 0; i <= pdata->grid_num_; i++) {
+                pdiffdata->r_mesh_.push_back(std::exp(pdata->xmin_ + static_cast<double>(i) * pdiffdata->dx_));
+            }
+            pdiffdata->psimpson_ = std::make_shared<Simpson>(pdiffdata->dx_, pdiffdata->r_mesh_);
+
+            prho = std::make_shared<Rho>(pdiffdata);
+            prho->init();
+            pvh = std::make_shared<Vhartree>(pdiffdata->r_mesh_);
+            pdiffsolver = std::make_shared<DiffSolver>(pdata, pdiffdata, prho, pvh);
+
+            pdiffsolver->solve_poisson();
+            auto const & rho = prho->PRho();
+            dvector const one(rho.size(), 1.0);
+            pvh->set_vhartree_boundary_condition((*pdiffdata->psimpson_)(rho, one, 3));
+            pvh->vhart_init(*pdiffdata->parena_);
+        }
+
+        //! A public member function.
+        /*!
+            EigenValueSearch::func_Dと同じく、一つのエネルギーで微分方程式を解く
+            \param E エネルギー
+            \return 整合点でのLの値
+        */
+        double solve(double E)
+        {
+            pdiffsolver->initialize(E);
+            pdiffsolver->solve_diff_equ();
+
+            return pdiffsolver->getMPval().first[0];
+        }
+
+        std::shared_ptr<schrac::Data> pdata;
+        std::shared_ptr<schrac::DiffData> pdiffdata;
+        std::shared_ptr<schrac::Rho> prho;
+        std::shared_ptr<schrac::Vhartree> pvh;
+        std::shared_ptr<schrac::DiffSolver> pdiffsolver;
+    };
+
+    //! A constant.
+    /*!
+        微分方程式を解くときのエネルギー（He原子の1s軌道の固有値の近く）
+    */
+    auto constexpr ETRIAL = -0.9;
+}
+
+//! A function.
+/*!
+    ヒープ確保の回数を数えるために置き換えたoperator new
+    （インライン展開されると、g++がnewとdeleteの組み合わせを誤って警告するので、
+    このファイルのoperator newとoperator deleteは展開しない）
+    \param size 確保するバイト数
+    \return 確保した領域へのポインタ
+*/
+[[gnu::noinline]] void * operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto const p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+//! A function.
+/*!
+    置き換えたoperator newに対応するoperator delete
+    \param p 解放する領域へのポインタ
+*/
+[[gnu::noinline]] void operator delete(void * p) noexcept
+{
+    std::free(p);
+}
+
+//! A function.
+/*!
+    置き換えたoperator newに対応するoperator delete（サイズ付き）
+    \param p 解放する領域へのポインタ
+*/
+[[gnu::noinline]] void operator delete(void * p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace schrac;
+
+    if (argc > 1) {
+        output.open(argv[1]);
+    }
+    if (argc > 2) {
+        read_reference(argv[2]);
+    }
+
+    std::printf("# name\tparam\tvalue\tunit\n");
+    if (output) {
+        output << "# name\tparam\tvalue\tunit\n";
+    }
+
+    // 右辺の評価のスループット（刻み幅を制御するソルバーで一回解くときの、右辺一回あたりの時間）
+    for (auto const eqtype : { "sch", "sdirac", "dirac" }) {
+        Kernel k(make_input("He", eqtype, "Controlled_Runge_Kutta", "ODE", 20000));
+        auto const param = (boost::format("eq=%s,grid=20000") % eqtype).str();
+
+        auto const t = measure([&k] { return k.solve(ETRIAL); });
+
+        SolveStats::enable(true);
+        k.pdiffsolver->stats_ = SolveStats();
+        k.solve(ETRIAL);
+        SolveStats::enable(false);
+        auto const derivs = static_cast<double>(k.pdiffsolver->stats_.derivs);
+
+        record("derivs.count", param, derivs, "evals/solve");
+        record("derivs.time", param, t * 1.0E6 / derivs, "ns/eval");
+    }
+
+    // 一つのエネルギーで微分方程式を解く時間（EigenValueSearch::func_Dの一回分）
+    for (auto const solvertype : { "Adams_Bashforth_Moulton", "Bulirsch_Stoer", "Controlled_Runge_Kutta", "Numerov" }) {
+        Kernel k(make_input("He", "sch", solvertype, "ODE", 20000));
+
+        record("func_D", (boost::format("solver=%s,grid=20000") % solvertype).str(),
+            measure([&k] { return k.solve(ETRIAL); }), "ms/call");
+    }
+
+    // ヒープ確保の回数（エネルギーを変えて解き直すときと、SCFのループで使い回す領域を数える）
+    for (auto const solvertype : { "Adams_Bashforth_Moulton", "Controlled_Runge_Kutta", "Numerov" }) {
+        Kernel k(make_input("He", "sch", solvertype, "ODE", 20000));
+
+        record("alloc.func_D", (boost::format("solver=%s,grid=20000") % solvertype).str(),
+            count_allocations([&k] { return k.solve(ETRIAL); }), "allocs/call");
+    }
+
+    for (auto const eqtype : { "sch", "dirac" }) {
+        Kernel k(make_input("He", eqtype, "Numerov", "ODE", 20000));
+        k.solve(ETRIAL);
+        k.pdiffsolver->E_ = ETRIAL;
+
+        if (std::string(eqtype) == "sch") {
+            record("alloc.energy_correction", "eq=sch,grid=20000",
+                count_allocations([&k] { return SchNormalize(k.pdiffsolver).energy_correction(); }), "allocs/call");
+        }
+
+        // ScfLoopと同じく、前の結果の配列は作業領域に返却する
+        record("alloc.normalization", (boost::format("eq=%s,grid=20000") % eqtype).str(),
+            count_allocations([&k] {
+                auto wavefunctions = nomalization(k.pdiffsolver);
+                auto const rf0 = wavefunctions.at("2 Eigen function")[0];
+                for (auto && wf : wavefunctions) {
+                    k.pdiffdata->pworkspace_->release(std::move(wf.second));
+                }
+
+                return rf0;
+            }), "allocs/call");
+    }
+
+    {
+        auto const inpname = make_input("He", "sch", "Numerov", "ODE", 20000);
+        auto iteration = 0;
+        auto const n = count_allocations([&] {
+            ScfLoop sl(std::make_pair(inpname, false), nullos);
+            auto const result = sl();
+            iteration = sl.PIteration;
+
+            return result.second.at("2 Eigen function")[0];
+        });
+
+        record("alloc.scf", "atom=He,grid=20000", n, "allocs/run");
+        record("alloc.scf.iteration", "atom=He,grid=20000", n / static_cast<double>(std::max(iteration, 1)), "allocs/iteration");
+    }
+
+    // Simpsonの公式（重みをキャッシュする実装）
+    for (auto const grid_num : { 5000, 20000, 100000 }) {
+        Kernel k(make_input("He", "sch", "Numerov", "Direct", grid_num));
+        auto const & rho = k.prho->PRho();
+        dvector const one(rho.size(), 1.0);
+        auto const & simpson = *k.pdiffdata->psimpson_;
+
+        record("simpson", (boost::format("grid=%d") % grid_num).str(),
+            measure([&] { return simpson(rho, one, 3); }) * 1.0E3, "us/call");
+    }
+
+    // スプライン補間（微分方程式を解くときと同じく、rの小さい方から順に評価する）
+    {
+        Kernel k(make_input("He", "sch", "Controlled_Runge_Kutta", "ODE", 20000));
+        auto const & r = k.pdiffdata->r_mesh_;
+        auto const n = r.size() - 1;
+
+        auto const tvh = measure([&] {
+            auto sum = 0.0;
+            for (auto i = 0U; i < n; i++) {
+                sum += k.pvh->vhartree(0.5 * (r[i] + r[i + 1]));
+            }
+            return sum;
+        });
+        record("spline.vhartree", "grid=20000", tvh * 1.0E6 / static_cast<double>(n), "ns/eval");
+
+        auto const trho = measure([&] {
+            auto sum = 0.0;
+            for (auto i = 0U; i < n; i++) {
+                sum += (*k.prho)(0.5 * (r[i] + r[i + 1]));
+            }
+            return sum;
+        });
+        record("spline.rho", "grid=20000", trho * 1.0E6 / static_cast<double>(n), "ns/eval");
+    }
+
+    // Poisson方程式
+    for (auto const poissontype : { "ODE", "Direct" }) {
+        Kernel k(make_input("He", "sch", "Numerov", poissontype, 20000));
+
+        record("solve_poisson", (boost::format("poisson=%s,grid=20000") % poissontype).str(),
+            measure([&k] { k.pdiffsolver->solve_poisson(); return 0.0; }), "ms/call");
+    }
+
+    // SCF全体（H原子とHe原子の1s軌道）
+    for (auto const symbol : { "H", "He" }) {
+        for (auto const grid_num : { 20000, 100000 }) {
+            auto const inpname = make_input(symbol, "sch", "Numerov", "ODE", grid_num);
+            auto const param = (boost::format("atom=%s,grid=%d") % symbol % grid_num).str();
+
+            auto Etotal = 0.0;
+            auto const t = measure([&] {
+                ScfLoop sl(std::make_pair(inpname, false), nullos);
+                auto [pdiffdata, wavefunctions] = sl();
+                Etotal = Energy(
+                    pdiffdata,
+                    wavefunctions.at("2 Eigen function"),
+                    pdiffdata->pdata_->Z_).express_energy(sl.PEhartree);
+
+                return Etotal;
+            }, 0.0, 3);
+
+            record("scf.time", param, t, "ms/run");
+            record("scf.energy", param, Etotal, "hartree");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+﻿/*! \file simpsonbench.cpp
+    \brief Simpsonの公式の、std::powを使う実装と重みをキャッシュする実装を比較するマイクロベンチマーク
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "../src/simpson.h"
+#include <chrono>       // for std::chrono
+#include <cmath>        // for std::exp, std::fabs
+#include <cstdint>      // for std::int32_t
+#include <cstdio>       // for std::printf
+#include <vector>       // for std::vector
+
+namespace {
+    //! A global variable.
+    /*!
+        計測した関数の戻り値を書き込む変数（最適化で呼び出しが消えないようにする）
+    */
+    volatile double sink;
+
+    //! A function.
+    /*!
+        関数オブジェクトを繰り返し呼び出し、一回あたりの時間を返す
+        \param func 計測する関数オブジェクト
+        \param loop 繰り返し回数
+        \return 一回あたりの時間（ミリ秒）
+    */
+    template <typename Func>
+    double measure(Func const & func, std::int32_t loop)
+    {
+        auto sum = 0.0;
+        auto const start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < loop; i++) {
+            sum += func();
+        }
+        auto const end = std::chrono::steady_clock::now();
+        sink = sum;
+
+        return std::chrono::duration<double, std::milli>(end - start).count() / static_cast<double>(loop);
+    }
+}
+
+int main()
+{
+    using namespace schrac;
+
+    auto const xmin = -8.0;
+    auto const xmax = 6.0;
+
+    std::printf("# grid.num  n  pow(ms)  cached(ms)  speedup  reldiff\n");
+
+    for (auto const grid_num : { 20000, 100000, 1000000 }) {
+        auto const dx = (xmax - xmin) / static_cast<double>(grid_num - 1);
+
+        std::vector<double> r, f, g;
+        r.reserve(grid_num + 1);
+        f.reserve(grid_num + 1);
+        g.reserve(grid_num + 1);
+        for (auto i = 0; i <= grid_num; i++) {
+            r.push_back(std::exp(xmin + static_cast<double>(i) * dx));
+            f.push_back(std::exp(-r.back()));
+            g.push_back(std::exp(-2.0 * r.back()));
+        }
+
+        Simpson const simpson(dx);
+        Simpson const cached(dx, r);
+
+        // 全体で同程度の時間になるように繰り返し回数を決める
+        auto const loop = 200000000 / grid_num;
+
+        for (auto const n : { 1, 2, 3 }) {
+            // 誤差を調べるための値（重みはコンストラクタで作ってあるので、計測には含まれない）
+            auto const ref = simpson(f, g, r, n);
+            auto const val = cached(f, g, n);
+
+            auto const tpow = measure([&] { return simpson(f, g, r, n); }, loop / 10);
+            auto const tcached = measure([&] { return cached(f, g, n); }, loop);
+
+            std::printf("%10d  %d  %.4f  %.4f  %.1f  %.1e\n",
+                grid_num, n, tpow, tcached, tpow / tcached, std::fabs((val - ref) / ref));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,275 @@
+﻿/*! \file batchrun.cpp
+    \brief 複数のインプットファイルをまとめて計算するクラスの実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "batchrun.h"
+#include "checkpoint/checkpoint.h"
+#include "energy.h"
+#include "scfloop.h"
+#include "shellscf.h"
+#include <algorithm>                    // for std::sort
+#include <cstdio>                       // for std::fclose, std::fopen, std::fprintf
+#include <filesystem>                   // for std::filesystem
+#include <fstream>                      // for std::ifstream, std::ofstream
+#include <iostream>                     // for std::cerr, std::cout
+#include <memory>                       // for std::unique_ptr
+#include <stdexcept>                    // for std::runtime_error
+#include <boost/algorithm/string.hpp>   // for boost::algorithm::trim
+#include <boost/format.hpp>             // for boost::format
+#include <tbb/task_arena.h>             // for tbb::task_arena, tbb::this_task_arena::isolate
+#include <tbb/task_group.h>             // for tbb::task_group
+
+namespace schrac {
+    // #region staticメンバ変数
+
+    std::string const BatchRun::SUMMARYFILENAME = "batch_summary.csv";
+
+    // #endregion staticメンバ変数
+
+    // #region コンストラクタ
+
+    BatchRun::BatchRun(
+        std::vector<std::string> const & joblist,
+        std::int32_t jobs,
+        bool usetbb,
+        WaveFunctionSave::Output_type output_type,
+        std::string const & summaryfilename) :
+        Results([this]{ return std::cref(results_); }, nullptr),
+        joblist_(joblist),
+        jobs_(jobs > 0 ? jobs : static_cast<std::int32_t>(tbb::task_arena::automatic)),
+        summaryfilename_(summaryfilename),
+        output_type_(output_type),
+        usetbb_(usetbb)
+    {
+    }
+
+    // #endregion コンストラクタ
+
+    // #region publicメンバ関数
+
+    bool BatchRun::operator()()
+    {
+        auto const size = joblist_.size();
+
+        std::cout << size << "個のジョブを実行します。" << std::endl;
+
+        results_.assign(size, JobResult());
+        std::size_t finished = 0;
+
+        // 各ジョブは独立なので、一つのtask_arenaの中でまとめてスケジュールする
+        // （ジョブの中の並列処理を待つ間に、別のジョブを横取りして入れ子にしないように隔離する）
+        tbb::task_arena arena(jobs_);
+        arena.execute([&] {
+            tbb::task_group tg;
+            for (auto i = 0U; i < size; i++) {
+                tg.run([&, i] {
+                    tbb::this_task_arena::isolate([&, i] { results_[i] = run_job(joblist_[i]); });
+
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    std::cout << boost::format("[%d/%d] %s: %s (%.4f msec)")
+                        % ++finished % size % joblist_[i] % (results_[i].ok ? "OK" : "NG") % results_[i].time
+                        << std::endl;
+                });
+            }
+            tg.wait();
+        });
+
+        write_summary();
+
+        return std::all_of(results_.begin(), results_.end(), [](auto const & result) { return result.ok; });
+    }
+
+    std::vector<std::string> BatchRun::make_joblist(std::string const & batchname)
+    {
+        namespace fs = std::filesystem;
+
+        std::vector<std::string> joblist;
+
+        if (fs::is_directory(batchname)) {
+            // ディレクトリが指定された場合は、その中の*.inpファイルをすべて実行する
+            for (auto const & entry : fs::directory_iterator(batchname)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".inp") {
+                    joblist.push_back(entry.path().string());
+                }
+            }
+
+            std::sort(joblist.begin(), joblist.end());
+        }
+        else {
+            // ファイルが指定された場合は、一行に一つのインプットファイル名が書かれているとみなす
+            // （空行と#で始まる行は無視し、相対パスはそのファイルの場所からのパスとする）
+            std::ifstream ifs(batchname);
+            if (!ifs) {
+                throw std::runtime_error(batchname + " が開けませんでした");
+            }
+
+            auto const dir = fs::path(batchname).parent_path();
+            std::string line;
+            while (std::getline(ifs, line)) {
+                boost::algorithm::trim(line);
+                if (line.empty() || line[0] == '#') {
+                    continue;
+                }
+
+                fs::path const inp(line);
+                joblist.push_back((inp.is_absolute() ? inp : dir / inp).string());
+            }
+        }
+
+        if (joblist.empty()) {
+            throw std::runtime_error(batchname + " に実行するインプットファイルがありません");
+        }
+
+        return joblist;
+    }
+
+    // #endregion publicメンバ関数
+
+    // #region privateメンバ関数
+
+    BatchRun::JobResult BatchRun::run_job(std::string const & inpname) const
+    {
+        namespace fs = std::filesystem;
+
+        JobResult result;
+        result.inpname = inpname;
+
+        checkpoint::CheckPoint cp;
+        cp.checkpoint("処理開始", __LINE__);
+
+        // 計算結果はインプットファイル名から拡張子を除いたディレクトリに書き出す
+        auto const outdir = fs::path(inpname).replace_extension();
+        std::error_code ec;
+        fs::create_directories(outdir, ec);
+        if (ec) {
+            result.message = outdir.string() + " が作成できませんでした";
+            cp.checkpoint("ディレクトリ作成処理", __LINE__);
+            result.time = cp.totalelapsedtime();
+
+            return result;
+        }
+
+        std::ofstream log((outdir / "schrac.log").string());
+
+        try {
+            auto const pdata = ScfLoop::read_input(std::make_pair(inpname, usetbb_), log);
+
+            // メッシュの自動決定を含めて、実際に使うメッシュと許容誤差を記録する
+            result.grid_num = pdata->grid_num_;
+            result.eps = pdata->eps_;
+            result.xmax = pdata->xmax_;
+            result.xmin = pdata->xmin_;
+
+            if (!pdata->shells_.empty()) {
+                // 電子が複数の殻を占有している場合は、すべての殻を解き、orbitalの殻の固有値を結果とする
+                ShellScf ss(pdata);
+
+                cp.checkpoint("初期化処理", __LINE__);
+
+                auto const results = ss();
+
+                cp.checkpoint("微分方程式の積分と固有値探索処理及び規格化処理", __LINE__);
+
+                result.Etotal = ss.express_energy();
+                for (auto const & [pdiffdata, wavefunctions] : results) {
+                    if (pdiffdata->pdata_->orbital_ == pdata->orbital_) {
+                        result.E = pdiffdata->E_;
+                    }
+                }
+                result.iteration = ss.PIteration;
+
+                cp.checkpoint("エネルギー出力処理", __LINE__);
+
+                result.ok = true;
+                for (auto const & [pdiffdata, wavefunctions] : results) {
+                    result.ok = WaveFunctionSave(wavefunctions, pdiffdata->pdata_, output_type_, outdir)() && result.ok;
+                }
+            }
+            else {
+                ScfLoop sl(pdata);
+
+                cp.checkpoint("初期化処理", __LINE__);
+
+                auto [pdiffdata, wavefunctions] = sl();
+
+                cp.checkpoint("微分方程式の積分と固有値探索処理及び規格化処理", __LINE__);
+
+                result.Etotal = Energy(
+                    pdiffdata,
+                    wavefunctions.at("2 Eigen function"),
+                    pdiffdata->pdata_->Z_).express_energy(sl.PEhartree);
+                result.E = pdiffdata->E_;
+                result.iteration = sl.PIteration;
+
+                cp.checkpoint("エネルギー出力処理", __LINE__);
+
+                result.ok = WaveFunctionSave(wavefunctions, pdiffdata->pdata_, output_type_, outdir)();
+            }
+
+            if (!result.ok) {
+                result.message = "波動関数のファイルが書き込めませんでした";
+            }
+
+            cp.checkpoint("ファイル書き込み処理", __LINE__);
+        }
+        catch (std::exception const & e) {
+            // 一つのジョブが失敗しても、他のジョブは続ける
+            result.message = e.what();
+            log << e.what() << std::endl;
+            cp.checkpoint("エラー処理", __LINE__);
+        }
+
+        cp.checkpoint_print(log);
+        cp.totalpassageoftime(log);
+        result.time = cp.totalelapsedtime();
+        result.peakmem = checkpoint::peakmem();
+
+        return result;
+    }
+
+    void BatchRun::write_summary() const
+    {
+        std::cout << boost::format("\n%-40s %-6s %-22s %-22s %-5s %-12s %s\n")
+            % "Input file" % "Status" % "Eigenvalue" % "Total energy" % "Iter." % "Time (msec)" % "Peak memory (kB)";
+
+        for (auto const & result : results_) {
+            if (result.ok) {
+                std::cout << boost::format("%-40s %-6s %-22.15f %-22.15f %-5d %-12.4f %d\n")
+                    % result.inpname % "OK" % result.E % result.Etotal % result.iteration % result.time % result.peakmem;
+            }
+            else {
+                std::cout << boost::format("%-40s %-6s %s\n")
+                    % result.inpname % "NG" % result.message;
+            }
+        }
+
+        std::unique_ptr<FILE, decltype(&fclose)> fp(
+            std::fopen(summaryfilename_.c_str(), "w"),
+            fclose);
+
+        if (!fp) {
+            std::cerr << summaryfilename_ << " が作成できませんでした。" << std::endl;
+            return;
+        }
+
+        std::fputs("Input file,Status,Eigenvalue,Total energy,Iterations,Time (msec),Peak memory (kB),Message\n", fp.get());
+        for (auto const & result : results_) {
+            std::fprintf(fp.get(), "%s,%s,%.15f,%.15f,%d,%.4f,%u,\"%s\"\n",
+                result.inpname.c_str(),
+                result.ok ? "OK" : "NG",
+                result.E,
+                result.Etotal,
+                result.iteration,
+                result.time,
+                result.peakmem,
+                result.message.c_str());
+        }
+
+        std::cout << '\n' << summaryfilename_ << " にジョブの結果の一覧を書き込みました。" << std::endl;
+    }
+
+    // #endregion privateメンバ関数
+}
@@ -0,0 +1,262 @@
+﻿/*! \file batchrun.h
+    \brief 複数のインプットファイルをまとめて計算するクラスの宣言
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _BATCHRUN_H_
+#define _BATCHRUN_H_
+
+#pragma once
+
+#include "property.h"
+#include "wavefunctionsave.h"
+#include <cstdint>      // for std::int32_t
+#include <mutex>        // for std::mutex
+#include <string>       // for std::string
+#include <vector>       // for std::vector
+
+namespace schrac {
+    //! A class.
+    /*!
+        複数のインプットファイルをまとめて計算するクラス
+        各ジョブは一つのTBBのtask_arenaの中で並列に実行され、
+        結果はインプットファイルと同じ場所の、拡張子を除いた名前のディレクトリに書き出される
+    */
+    class BatchRun final {
+        // #region 構造体
+
+    public:
+        //! A struct.
+        /*!
+            一つのジョブの結果
+        */
+        struct JobResult final {
+            //! A public member variable.
+            /*!
+                インプットファイル名
+            */
+            std::string inpname;
+
+            //! A public member variable.
+            /*!
+                計算に成功したかどうか
+            */
+            bool ok = false;
+
+            //! A public member variable.
+            /*!
+                固有値
+            */
+            double E = 0.0;
+
+            //! A public member variable.
+            /*!
+                全エネルギー
+            */
+            double Etotal = 0.0;
+
+            //! A public member variable.
+            /*!
+                SCFのループ回数
+            */
+            std::int32_t iteration = 0;
+
+            //! A public member variable.
+            /*!
+                メッシュの数
+            */
+            std::int32_t grid_num = 0;
+
+            //! A public member variable.
+            /*!
+                許容誤差
+            */
+            double eps = 0.0;
+
+            //! A public member variable.
+            /*!
+                メッシュの最大値（x = ln(r)）
+            */
+            double xmax = 0.0;
+
+            //! A public member variable.
+            /*!
+                メッシュの最小値（x = ln(r)）
+            */
+            double xmin = 0.0;
+
+            //! A public member variable.
+            /*!
+                ジョブ終了時のプロセスのメモリ使用量の最大値（kB）
+            */
+            std::uint32_t peakmem = 0;
+
+            //! A public member variable.
+            /*!
+                ジョブの経過時間（ミリ秒）
+            */
+            double time = 0.0;
+
+            //! A public member variable.
+            /*!
+                失敗した場合のエラーメッセージ
+            */
+            std::string message;
+        };
+
+        // #endregion 構造体
+
+        // #region コンストラクタ・デストラクタ
+
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param joblist 実行するインプットファイル名の可変長配列
+            \param jobs 同時に実行するジョブの数（0以下なら自動）
+            \param usetbb 各ジョブの中でもTBBを使用するかどうか
+            \param output_type 波動関数を書き出すファイルの形式
+            \param summaryfilename ジョブの結果の一覧を書き出すファイル名
+        */
+        BatchRun(
+            std::vector<std::string> const & joblist,
+            std::int32_t jobs,
+            bool usetbb,
+            WaveFunctionSave::Output_type output_type,
+            std::string const & summaryfilename = SUMMARYFILENAME);
+
+        //! A destructor.
+        /*!
+            デフォルトデストラクタ
+        */
+        ~BatchRun() = default;
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ関数
+
+        //! A public member function.
+        /*!
+            すべてのジョブを実行し、結果の一覧を書き出す
+            \return すべてのジョブが成功したかどうか
+        */
+        bool operator()();
+
+        //! A public static member function.
+        /*!
+            実行するインプットファイルの一覧を作る
+            \param batchname インプットファイルの一覧が書かれたファイル名、またはインプットファイルのあるディレクトリ名
+            \return インプットファイル名の可変長配列
+        */
+        static std::vector<std::string> make_joblist(std::string const & batchname);
+
+    private:
+        //! A private member function (const).
+        /*!
+            一つのジョブを実行する
+            \param inpname インプットファイル名
+            \return ジョブの結果
+        */
+        JobResult run_job(std::string const & inpname) const;
+
+        //! A private member function (const).
+        /*!
+            ジョブの結果の一覧を表示し、ファイルに書き出す
+        */
+        void write_summary() const;
+
+        // #endregion メンバ関数
+
+        // #region プロパティ
+
+    public:
+        //! A property.
+        /*!
+            ジョブの結果の可変長配列を得る
+            \return ジョブの結果の可変長配列
+        */
+        Property<std::vector<JobResult>> const Results;
+
+        // #endregion プロパティ
+
+        // #region メンバ変数
+
+        //! A public static member variable (constant).
+        /*!
+            デフォルトの、ジョブの結果の一覧を書き出すファイル名
+        */
+        static std::string const SUMMARYFILENAME;
+
+    private:
+        //! A private member variable (constant).
+        /*!
+            実行するインプットファイル名の可変長配列
+        */
+        std::vector<std::string> const joblist_;
+
+        //! A private member variable (constant).
+        /*!
+            同時に実行するジョブの数
+        */
+        std::int32_t const jobs_;
+
+        //! A private member variable.
+        /*!
+            進行状況の表示を排他制御するミューテックス
+        */
+        mutable std::mutex mutex_;
+
+        //! A private member variable.
+        /*!
+            ジョブの結果の可変長配列
+        */
+        std::vector<JobResult> results_;
+
+        //! A private member variable (constant).
+        /*!
+            ジョブの結果の一覧を書き出すファイル名
+        */
+        std::string const summaryfilename_;
+
+        //! A private member variable (constant).
+        /*!
+            波動関数を書き出すファイルの形式
+        */
+        WaveFunctionSave::Output_type const output_type_;
+
+        //! A private member variable (constant).
+        /*!
+            各ジョブの中でもTBBを使用するかどうか
+        */
+        bool const usetbb_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        BatchRun() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        BatchRun(BatchRun const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        BatchRun & operator=(BatchRun const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _BATCHRUN_H_
@@ -0,0 +1,308 @@
+﻿/*! \file arena.h
+    \brief 任意の大きさとアラインメントのメモリを確保し、まとめて解放するアリーナクラスと、
+           そのSTLのアロケーターの宣言と実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#pragma once
+
+#include <algorithm>            // for std::max
+#include <cstddef>              // for std::size_t
+#include <memory>               // for std::align, std::unique_ptr
+#include <mutex>                // for std::lock_guard, std::mutex
+#include <vector>               // for std::vector
+#include <boost/assert.hpp>     // for BOOST_ASSERT
+
+namespace checkpoint {
+    //! A class.
+    /*!
+        任意の大きさとアラインメントのメモリを、チャンクの先頭から順に切り出して確保するアリーナクラス
+        ArraiedAllocatorと違い、個々のメモリは解放せず、reset()でまとめて解放する
+        チャンクはreset()しても手放さないので、同じ使い方を繰り返せば二回目からはヒープを確保しない
+    */
+    class Arena final
+    {
+        // #region クラス内クラスの宣言と実装
+
+        //! A structure.
+        /*!
+            アリーナが切り出すメモリの塊
+        */
+        struct Chunk {
+            //! A public member variable.
+            /*!
+                メモリの先頭
+            */
+            std::unique_ptr<char[]> data_;
+
+            //! A public member variable.
+            /*!
+                メモリの大きさ（バイト）
+            */
+            std::size_t size_;
+        };
+
+        // #endregion クラス内クラスの宣言と実装
+
+    public:
+        // #region コンストラクタ・デストラクタ
+
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param chunksize 一つのチャンクの大きさ（バイト、これより大きい要求にはその大きさのチャンクを確保する）
+        */
+        explicit Arena(std::size_t chunksize) : chunksize_(chunksize) {}
+
+        //! A destructor.
+        /*!
+            デフォルトデストラクタ
+        */
+        ~Arena() = default;
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ関数
+
+        //! A public member function.
+        /*!
+            メモリを確保してそのアドレスを返す
+            今のチャンクに収まらなければ次のチャンクを使い、チャンクを使い切っている場合はヒープから確保する
+            \param size 確保するメモリの大きさ（バイト）
+            \param alignment アラインメント（2のべき乗）
+            \return 確保されたメモリのアドレス
+        */
+        void * allocate(std::size_t size, std::size_t alignment)
+        {
+            BOOST_ASSERT(alignment > 0 && !(alignment & (alignment - 1)));
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            for (; current_ < chunks_.size(); current_++, offset_ = 0) {
+                if (auto const p = bump(chunks_[current_], size, alignment)) {
+                    return p;
+                }
+            }
+
+            // アラインメントを合わせるためにずらす分も含めて確保する
+            auto const chunksize = std::max(chunksize_, size + alignment);
+            chunks_.push_back({ std::unique_ptr<char[]>(new char[chunksize]), chunksize });
+
+            return bump(chunks_.back(), size, alignment);
+        }
+
+        //! A public member function.
+        /*!
+            T型の要素n個分のメモリを確保してそのアドレスを返す
+            \param n 要素の数
+            \return 確保されたメモリのアドレス
+        */
+        template <typename T>
+        T * allocate(std::size_t n)
+        {
+            return static_cast<T *>(allocate(sizeof(T) * n, alignof(T)));
+        }
+
+        //! A public member function.
+        /*!
+            確保したメモリをすべて解放する（チャンクは次の確保で使い回す）
+            確保したメモリを使っているオブジェクトが残っていてはならない
+        */
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            current_ = 0;
+            offset_ = 0;
+        }
+
+        // #endregion メンバ関数
+
+    private:
+        // #region メンバ関数
+
+        //! A private member function.
+        /*!
+            チャンクの未使用の部分の先頭からメモリを切り出す
+            \param chunk チャンク
+            \param size 確保するメモリの大きさ（バイト）
+            \param alignment アラインメント
+            \return 確保されたメモリのアドレス（チャンクに収まらなければnullptr）
+        */
+        void * bump(Chunk const & chunk, std::size_t size, std::size_t alignment)
+        {
+            void * p = chunk.data_.get() + offset_;
+            auto space = chunk.size_ - offset_;
+            if (!std::align(alignment, size, p, space)) {
+                return nullptr;
+            }
+
+            offset_ = chunk.size_ - space + size;
+
+            return p;
+        }
+
+        // #endregion メンバ関数
+
+        // #region メンバ変数
+
+        //! A private member variable (constant).
+        /*!
+            一つのチャンクの大きさ（バイト）
+        */
+        std::size_t const chunksize_;
+
+        //! A private member variable.
+        /*!
+            確保したチャンク
+        */
+        std::vector<Chunk> chunks_;
+
+        //! A private member variable.
+        /*!
+            今切り出しているチャンクの添字
+        */
+        std::size_t current_ = 0;
+
+        //! A private member variable.
+        /*!
+            複数のスレッドから確保・解放するときの排他制御用のミューテックス
+        */
+        std::mutex mutex_;
+
+        //! A private member variable.
+        /*!
+            今切り出しているチャンクの、未使用の部分の先頭の位置（バイト）
+        */
+        std::size_t offset_ = 0;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        Arena() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        Arena(Arena const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト（未使用）
+        */
+        Arena & operator=(Arena const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+
+    //! A template class.
+    /*!
+        Arenaからメモリを確保するSTLのアロケータークラス
+        deallocate()は何もせず、メモリはArena::reset()でまとめて解放される
+        （libstdc++のコンテナはアロケーターを継承するので、finalにはしない）
+        \param T 確保する型
+    */
+    template <typename T>
+    class ArenaAllocator
+    {
+        template <typename U>
+        friend class ArenaAllocator;
+
+    public:
+        // #region 型エイリアス
+
+        using value_type = T;
+
+        // #endregion 型エイリアス
+
+        // #region コンストラクタ・デストラクタ
+
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param arena メモリを確保するアリーナ
+        */
+        explicit ArenaAllocator(Arena & arena) noexcept : parena_(&arena) {}
+
+        //! A constructor.
+        /*!
+            別の型のアロケーターから、同じアリーナを使うアロケーターを作る
+            \param other 別の型のアロケーター
+        */
+        template <typename U>
+        ArenaAllocator(ArenaAllocator<U> const & other) noexcept : parena_(other.parena_) {}
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ関数
+
+        //! A public member function.
+        /*!
+            T型の要素n個分のメモリを確保する
+            \param n 要素の数
+            \return 確保されたメモリのアドレス
+        */
+        T * allocate(std::size_t n)
+        {
+            return parena_->template allocate<T>(n);
+        }
+
+        //! A public member function.
+        /*!
+            何もしない（メモリはアリーナが解放する）
+        */
+        void deallocate(T *, std::size_t) noexcept {}
+
+        //! A public member function (const).
+        /*!
+            二つのアロケーターが同じアリーナを使っているかどうかを返す
+            \param other 比較するアロケーター
+            \return 同じアリーナを使っていればtrue
+        */
+        template <typename U>
+        bool operator==(ArenaAllocator<U> const & other) const noexcept
+        {
+            return parena_ == other.parena_;
+        }
+
+        //! A public member function (const).
+        /*!
+            二つのアロケーターが異なるアリーナを使っているかどうかを返す
+            \param other 比較するアロケーター
+            \return 異なるアリーナを使っていればtrue
+        */
+        template <typename U>
+        bool operator!=(ArenaAllocator<U> const & other) const noexcept
+        {
+            return parena_ != other.parena_;
+        }
+
+        // #endregion メンバ関数
+
+    private:
+        // #region メンバ変数
+
+        //! A private member variable.
+        /*!
+            メモリを確保するアリーナ
+        */
+        Arena * parena_;
+
+        // #endregion メンバ変数
+    };
+}
+
+#endif // _ARENA_H_
@@ -12,6 +12,8 @@
 
 #include <cstddef>                  // for std::size_t
 #include <cstdint>                  // for std::uint32_t
+#include <mutex>                    // for std::lock_guard, std::mutex
+#include <new>                      // for ::operator new, ::operator delete
 #include <boost/static_assert.hpp>  // for BOOST_STATIC_ASSERT
 
 namespace checkpoint {
@@ -63,9 +65,15 @@ namespace checkpoint {
         //! A public static member function.
         /*!
             メモリを確保してそのアドレスを返す
+            要素を使い切っている場合はヒープから確保する
             \return 確保されたメモリのアドレス
         */
         static void * Alloc() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!first_) {
+                return ::operator new(TTypeSize);
+            }
+
             Item * ret = first_;
             first_ = ret->next_;
             return reinterpret_cast<void *>(ret);
@@ -78,6 +86,12 @@ namespace checkpoint {
         */
         static void Free(void * item) {
             Item * rev = reinterpret_cast<Item *>(item);
+            if (rev < items_ || rev >= items_ + MAX_SIZE) {
+                ::operator delete(item);
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
             rev->next_ = first_;
             first_ = rev;
         }
@@ -117,6 +131,12 @@ namespace checkpoint {
             最初の要素へのポインタ        
         */
         static Item * first_;
+
+        //! A private static member variable.
+        /*!
+            複数のスレッドから確保・解放するときの排他制御用のミューテックス
+        */
+        static std::mutex mutex_;
         
         //! A private static member variable.
         /*!
@@ -158,6 +178,9 @@ namespace checkpoint {
     template <std::size_t TTypeSize, std::size_t TNumArray>
     typename ArraiedAllocator<TTypeSize, TNumArray>::Item* ArraiedAllocator<TTypeSize, TNumArray>::first_;
 
+    template <std::size_t TTypeSize, std::size_t TNumArray>
+    std::mutex ArraiedAllocator<TTypeSize, TNumArray>::mutex_;
+
     template <std::size_t TTypeSize, std::size_t TNumArray>
     typename ArraiedAllocator<TTypeSize,TNumArray>::Item
         ArraiedAllocator<TTypeSize, TNumArray>::items_[ArraiedAllocator<TTypeSize,TNumArray>::MAX_SIZE];
@@ -7,6 +7,7 @@
 
 #include "checkpoint.h"
 #include <iostream>             // for std::cout
+#include <new>                  // for placement new
 #include <optional>				// for std::optional
 #include <system_error>         // for std::system_category
 #include <boost/assert.hpp>     // for boost::assert
@@ -27,8 +28,8 @@
 namespace checkpoint {
     CheckPoint::CheckPoint()
         : cfp(
-            reinterpret_cast<CheckPoint::CheckPointFastImpl *>(
-                FastArenaObject<sizeof(CheckPoint::CheckPointFastImpl)>::operator new(0)))
+            new (FastArenaObject<sizeof(CheckPoint::CheckPointFastImpl)>::operator new(0))
+                CheckPoint::CheckPointFastImpl())
     {
     }
 
@@ -49,7 +50,7 @@ namespace checkpoint {
         cfp->cur++;
     }
     
-    void CheckPoint::checkpoint_print() const
+    void CheckPoint::checkpoint_print(std::ostream & os) const
     {
         using namespace std::chrono;
 
@@ -59,28 +60,33 @@ namespace checkpoint {
         for (auto i = 0; i < cfp->cur; ++i, ++itr) {
             if (prevreal) {
                 auto const realtime(duration_cast<duration<double, std::milli>>(itr->realtime - *prevreal));
-                std::cout << itr->action
-                          << boost::format(" elapsed time = %.4f (msec)\n") % realtime.count();
+                os << itr->action
+                   << boost::format(" elapsed time = %.4f (msec)\n") % realtime.count();
             }
 
             prevreal = std::optional<high_resolution_clock::time_point>(itr->realtime);
         }
     }
 
-    void CheckPoint::totalpassageoftime() const
+    void CheckPoint::totalpassageoftime(std::ostream & os) const
+    {
+        os << boost::format("Total elapsed time = %.4f (msec)") % totalelapsedtime() << std::endl;
+    }
+
+    double CheckPoint::totalelapsedtime() const
     {
         using namespace std::chrono;
 
         auto const realtime = duration_cast<duration<double, std::milli>>(
             cfp->points[cfp->cur - 1].realtime - cfp->points[0].realtime);
 
-        std::cout << boost::format("Total elapsed time = %.4f (msec)") % realtime.count() << std::endl;
+        return realtime.count();
     }
 
     // #region 非メンバ関数
 
 #ifdef _WIN32
-    void usedmem()
+    std::uint32_t peakmem()
     {
         PROCESS_MEMORY_COUNTERS memInfo = { 0 };
         
@@ -88,13 +94,10 @@ namespace checkpoint {
             throw std::system_error(std::error_code(::GetLastError(), std::system_category()));
         }
 
-        std::cout << "Used Memory Size: "
-                  << boost::numeric_cast<std::uint32_t>(memInfo.PeakWorkingSetSize >> 10)
-                  << "(kB)"
-                  << std::endl; 
+        return boost::numeric_cast<std::uint32_t>(memInfo.PeakWorkingSetSize >> 10);
     }
 #else
-    void usedmem()
+    std::uint32_t peakmem()
     {
         struct rusage r;
 
@@ -102,12 +105,17 @@ namespace checkpoint {
             throw std::system_error(errno, std::system_category());
         }
 
+        return boost::numeric_cast<std::uint32_t>(r.ru_maxrss);
+    }
+#endif
+
+    void usedmem()
+    {
         std::cout << "Used Memory Size: "
-                  << boost::numeric_cast<std::uint32_t>(r.ru_maxrss)
+                  << peakmem()
                   << "(kB)"
                   << std::endl;
     }
-#endif
 
     // #endregion 非メンバ関数
 }
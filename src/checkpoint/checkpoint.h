@@ -14,6 +14,7 @@
 #include <array>                // for std::array            
 #include <chrono>               // for std::chrono               
 #include <cstdint>              // for std::int32_t, std::int64_t
+#include <iostream>             // for std::cout, std::ostream
 #include <memory>               // for std::unique_ptr
 #include <utility>              // for std::pair
 
@@ -137,15 +138,25 @@ namespace checkpoint {
         //! A public member function.
         /*!
             直前のチェックポイントから計測した、経過時間を表示する
+            \param os 表示先のストリーム
         */
-        void checkpoint_print() const;
+        void checkpoint_print(std::ostream & os = std::cout) const;
 
         //! A public member function.
         /*!
             最初のチェックポイントから最後のチェックポイント
             までの経過時間を表示する
+            \param os 表示先のストリーム
         */
-        void totalpassageoftime() const;
+        void totalpassageoftime(std::ostream & os = std::cout) const;
+
+        //! A public member function.
+        /*!
+            最初のチェックポイントから最後のチェックポイント
+            までの経過時間を返す
+            \return 経過時間（ミリ秒）
+        */
+        double totalelapsedtime() const;
 
         // #endregion メンバ関数 
 
@@ -187,6 +198,13 @@ namespace checkpoint {
     */
     void usedmem();
 
+    //! A function.
+    /*!
+        自分自身のプロセスのメモリ使用量の最大値を返す
+        \return メモリ使用量の最大値（kB）
+    */
+    std::uint32_t peakmem();
+
     // #endregion 非メンバ関数
 }
 
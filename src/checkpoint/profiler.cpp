@@ -0,0 +1,299 @@
+﻿/*! \file profiler.cpp
+    \brief 入れ子にできるスコープ単位の時間計測とカウンタのクラスの実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "profiler.h"
+#include <algorithm>            // for std::find_if, std::max, std::min
+#include <cstring>              // for std::strcmp
+#include <mutex>                // for std::lock_guard, std::mutex
+#include <string>               // for std::string
+#include <boost/format.hpp>     // for boost::format
+
+namespace checkpoint {
+    // #region 無名名前空間
+
+    namespace {
+        //! A global variable.
+        /*!
+            各スレッドの木の根を保持する可変長配列
+        */
+        std::vector<std::unique_ptr<Profiler::Node>> roots;
+
+        //! A global variable.
+        /*!
+            rootsを排他制御するミューテックス
+        */
+        std::mutex roots_mutex;
+
+        //! A thread local variable.
+        /*!
+            このスレッドの木の根
+        */
+        thread_local Profiler::Node * proot = nullptr;
+
+        //! A thread local variable.
+        /*!
+            このスレッドで現在計測しているスコープ
+        */
+        thread_local Profiler::Node * pcurrent = nullptr;
+
+        //! A function.
+        /*!
+            このスレッドで現在計測しているスコープを返す（初めて呼ばれたときは木の根を作る）
+            \return 現在計測しているスコープ
+        */
+        Profiler::Node * current()
+        {
+            if (!pcurrent) {
+                auto root = std::make_unique<Profiler::Node>("", nullptr);
+                proot = pcurrent = root.get();
+
+                std::lock_guard<std::mutex> lock(roots_mutex);
+                roots.push_back(std::move(root));
+            }
+
+            return pcurrent;
+        }
+
+        //! A function.
+        /*!
+            子のスコープの中から、名前が一致するものを探す（なければ作る）
+            \param pparent 親のスコープ
+            \param name スコープの名前
+            \return 名前が一致する子のスコープ
+        */
+        Profiler::Node * find_child(Profiler::Node * pparent, char const * name)
+        {
+            auto & children = pparent->children;
+
+            // 同じ文字列リテラルであることが多いので、ポインタを先に比べる
+            auto itr = std::find_if(children.begin(), children.end(), [name](auto const & child) {
+                return child->name == name || !std::strcmp(child->name, name);
+            });
+
+            if (itr != children.end()) {
+                return itr->get();
+            }
+
+            children.push_back(std::make_unique<Profiler::Node>(name, pparent));
+            return children.back().get();
+        }
+
+        //! A function.
+        /*!
+            木を別の木に合算する
+            \param pdst 合算先の木
+            \param src 合算元の木
+        */
+        void merge(Profiler::Node * pdst, Profiler::Node const & src)
+        {
+            pdst->calls += src.calls;
+            pdst->total += src.total;
+            pdst->min = std::min(pdst->min, src.min);
+            pdst->max = std::max(pdst->max, src.max);
+
+            for (auto const & [name, value] : src.counters) {
+                auto itr = std::find_if(pdst->counters.begin(), pdst->counters.end(), [name = name](auto const & counter) {
+                    return !std::strcmp(counter.first, name);
+                });
+
+                if (itr != pdst->counters.end()) {
+                    itr->second += value;
+                }
+                else {
+                    pdst->counters.emplace_back(name, value);
+                }
+            }
+
+            for (auto const & child : src.children) {
+                merge(find_child(pdst, child->name), *child);
+            }
+        }
+
+        //! A function.
+        /*!
+            すべてのスレッドの木を合算する
+            \return 合算した木
+        */
+        Profiler::Node merged()
+        {
+            Profiler::Node root("", nullptr);
+
+            std::lock_guard<std::mutex> lock(roots_mutex);
+            for (auto const & r : roots) {
+                merge(&root, *r);
+            }
+
+            return root;
+        }
+
+        //! A function.
+        /*!
+            ナノ秒をミリ秒に変換する
+            \param ns ナノ秒
+            \return ミリ秒
+        */
+        double to_msec(std::int64_t ns)
+        {
+            return static_cast<double>(ns) * 1.0E-6;
+        }
+
+        //! A function.
+        /*!
+            木の形で集計結果を表示する
+            \param os 表示先のストリーム
+            \param node 表示するスコープ
+            \param depth 木の深さ
+            \param parenttotal 親のスコープの合計時間（ナノ秒、最上位なら0）
+        */
+        void report_node(std::ostream & os, Profiler::Node const & node, std::int32_t depth, std::int64_t parenttotal)
+        {
+            std::string const indent(depth * 2, ' ');
+
+            os << boost::format("%-48s %10d %12.4f %12.4f %12.4f %12.4f %7s\n")
+                % (indent + node.name)
+                % node.calls
+                % to_msec(node.total)
+                % (to_msec(node.total) / static_cast<double>(node.calls))
+                % to_msec(node.min)
+                % to_msec(node.max)
+                % (parenttotal > 0 ?
+                    (boost::format("%.1f%%") % (100.0 * static_cast<double>(node.total) / static_cast<double>(parenttotal))).str() :
+                    std::string("-"));
+
+            for (auto const & [name, value] : node.counters) {
+                os << boost::format("%-48s %10d\n") % (indent + "  # " + name) % value;
+            }
+
+            for (auto const & child : node.children) {
+                report_node(os, *child, depth + 1, node.total);
+            }
+        }
+
+        //! A function.
+        /*!
+            JSONの文字列として書き出す（スコープの名前に使う程度の文字だけをエスケープする）
+            \param os 書き出し先のストリーム
+            \param str 書き出す文字列
+        */
+        void json_string(std::ostream & os, char const * str)
+        {
+            os << '"';
+            for (; *str; ++str) {
+                if (*str == '"' || *str == '\\') {
+                    os << '\\';
+                }
+                os << *str;
+            }
+            os << '"';
+        }
+
+        //! A function.
+        /*!
+            カウンタと子のスコープをJSON形式で書き出す
+            \param os 書き出し先のストリーム
+            \param node 書き出すスコープ
+        */
+        void json_body(std::ostream & os, Profiler::Node const & node)
+        {
+            os << "\"counters\":{";
+            for (auto i = 0U; i < node.counters.size(); i++) {
+                os << (i ? "," : "");
+                json_string(os, node.counters[i].first);
+                os << ':' << node.counters[i].second;
+            }
+
+            os << "},\"children\":[";
+            for (auto i = 0U; i < node.children.size(); i++) {
+                auto const & child = *node.children[i];
+
+                os << (i ? "," : "") << "{\"name\":";
+                json_string(os, child.name);
+                os << boost::format(",\"calls\":%d,\"total_ms\":%.6f,\"min_ms\":%.6f,\"max_ms\":%.6f,")
+                    % child.calls % to_msec(child.total) % to_msec(child.min) % to_msec(child.max);
+                json_body(os, child);
+                os << '}';
+            }
+            os << ']';
+        }
+    }
+
+    // #endregion 無名名前空間
+
+    // #region staticメンバ変数
+
+    std::atomic<bool> Profiler::enabled_(false);
+
+    // #endregion staticメンバ変数
+
+    // #region publicメンバ関数
+
+    void Profiler::count(char const * name, std::uint64_t n)
+    {
+        if (!enabled()) {
+            return;
+        }
+
+        auto & counters = current()->counters;
+        auto itr = std::find_if(counters.begin(), counters.end(), [name](auto const & counter) {
+            return counter.first == name || !std::strcmp(counter.first, name);
+        });
+
+        if (itr != counters.end()) {
+            itr->second += n;
+        }
+        else {
+            counters.emplace_back(name, n);
+        }
+    }
+
+    void Profiler::enable(bool enable)
+    {
+        enabled_.store(enable, std::memory_order_relaxed);
+    }
+
+    Profiler::Node * Profiler::enter(char const * name)
+    {
+        return pcurrent = find_child(current(), name);
+    }
+
+    void Profiler::json(std::ostream & os)
+    {
+        auto const root = merged();
+
+        os << '{';
+        json_body(os, root);
+        os << "}\n";
+    }
+
+    void Profiler::leave(Node * pnode, std::int64_t elapsed)
+    {
+        pnode->calls++;
+        pnode->total += elapsed;
+        pnode->min = std::min(pnode->min, elapsed);
+        pnode->max = std::max(pnode->max, elapsed);
+
+        pcurrent = pnode->parent;
+    }
+
+    void Profiler::report(std::ostream & os)
+    {
+        auto const root = merged();
+
+        os << boost::format("\n%-48s %10s %12s %12s %12s %12s %7s\n")
+            % "Scope" % "Calls" % "Total (ms)" % "Avg. (ms)" % "Min (ms)" % "Max (ms)" % "Parent";
+
+        for (auto const & [name, value] : root.counters) {
+            os << boost::format("%-48s %10d\n") % (std::string("# ") + name) % value;
+        }
+
+        for (auto const & child : root.children) {
+            report_node(os, *child, 0, 0);
+        }
+    }
+
+    // #endregion publicメンバ関数
+}
@@ -0,0 +1,297 @@
+﻿/*! \file profiler.h
+    \brief 入れ子にできるスコープ単位の時間計測とカウンタのクラスの宣言
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#pragma once
+
+#include <atomic>               // for std::atomic
+#include <chrono>               // for std::chrono
+#include <cstdint>              // for std::int64_t, std::uint64_t
+#include <iostream>             // for std::cout, std::ostream
+#include <limits>               // for std::numeric_limits
+#include <memory>               // for std::unique_ptr
+#include <utility>              // for std::pair
+#include <vector>               // for std::vector
+
+//! A macro.
+/*!
+    二つのトークンを連結する（__LINE__を展開してから連結するための補助）
+*/
+#define CHECKPOINT_CONCAT_IMPL(a, b) a##b
+#define CHECKPOINT_CONCAT(a, b) CHECKPOINT_CONCAT_IMPL(a, b)
+
+#ifdef CHECKPOINT_NO_PROFILE
+    #define CHECKPOINT_SCOPE(name)
+    #define CHECKPOINT_COUNT(name, n)
+#else
+    //! A macro.
+    /*!
+        このマクロを書いた位置からスコープの終わりまでを、nameという名前で計測する
+    */
+    #define CHECKPOINT_SCOPE(name) \
+        checkpoint::ScopedTimer const CHECKPOINT_CONCAT(checkpoint_scopedtimer_, __LINE__)(name)
+
+    //! A macro.
+    /*!
+        現在のスコープのnameという名前のカウンタにnを加える
+    */
+    #define CHECKPOINT_COUNT(name, n) checkpoint::Profiler::count(name, n)
+#endif
+
+namespace checkpoint {
+    //! A class.
+    /*!
+        スコープ単位の時間計測とカウンタを集計するクラス
+        計測はスレッドごとの木に記録され、レポートのときに同じ名前の経路どうしで合算される
+        （あるスレッドで初めて入ったスコープは、そのスレッドの木の最上位に置かれる）
+        無効のときは、各スコープの入口で一つの分岐を行うだけで何も記録しない
+    */
+    class Profiler final {
+        // #region クラス内クラスの宣言
+
+    public:
+        //! A struct.
+        /*!
+            一つのスコープの集計結果
+        */
+        struct Node final {
+            //! A constructor.
+            /*!
+                唯一のコンストラクタ
+                \param name スコープの名前
+                \param parent 親のスコープ
+            */
+            Node(char const * name, Node * parent) : name(name), parent(parent) {}
+
+            //! A public member variable.
+            /*!
+                スコープの名前
+            */
+            char const * name;
+
+            //! A public member variable.
+            /*!
+                親のスコープ（最上位ならnullptr）
+            */
+            Node * parent;
+
+            //! A public member variable.
+            /*!
+                呼び出し回数
+            */
+            std::uint64_t calls = 0;
+
+            //! A public member variable.
+            /*!
+                合計時間（ナノ秒）
+            */
+            std::int64_t total = 0;
+
+            //! A public member variable.
+            /*!
+                最小時間（ナノ秒）
+            */
+            std::int64_t min = std::numeric_limits<std::int64_t>::max();
+
+            //! A public member variable.
+            /*!
+                最大時間（ナノ秒）
+            */
+            std::int64_t max = 0;
+
+            //! A public member variable.
+            /*!
+                カウンタの名前と値のstd::pairの可変長配列
+            */
+            std::vector<std::pair<char const *, std::uint64_t>> counters;
+
+            //! A public member variable.
+            /*!
+                子のスコープの可変長配列
+            */
+            std::vector<std::unique_ptr<Node>> children;
+        };
+
+        // #endregion クラス内クラスの宣言
+
+        // #region メンバ関数
+
+        //! A public static member function.
+        /*!
+            現在のスコープのカウンタに値を加える
+            \param name カウンタの名前
+            \param n 加える値
+        */
+        static void count(char const * name, std::uint64_t n = 1);
+
+        //! A public static member function.
+        /*!
+            計測を有効にするかどうかを設定する
+            \param enable 計測を有効にするかどうか
+        */
+        static void enable(bool enable);
+
+        //! A public static member function.
+        /*!
+            計測が有効かどうかを返す
+            \return 計測が有効かどうか
+        */
+        static bool enabled()
+        {
+            return enabled_.load(std::memory_order_relaxed);
+        }
+
+        //! A public static member function.
+        /*!
+            スコープに入る
+            \param name スコープの名前
+            \return 入ったスコープの集計結果
+        */
+        static Node * enter(char const * name);
+
+        //! A public static member function.
+        /*!
+            JSON形式で集計結果を書き出す
+            \param os 書き出し先のストリーム
+        */
+        static void json(std::ostream & os);
+
+        //! A public static member function.
+        /*!
+            スコープから出る
+            \param pnode 出るスコープの集計結果
+            \param elapsed スコープの中で経過した時間（ナノ秒）
+        */
+        static void leave(Node * pnode, std::int64_t elapsed);
+
+        //! A public static member function.
+        /*!
+            木の形で集計結果を表示する
+            \param os 表示先のストリーム
+        */
+        static void report(std::ostream & os = std::cout);
+
+        // #endregion メンバ関数
+
+        // #region メンバ変数
+
+    private:
+        //! A private static member variable.
+        /*!
+            計測が有効かどうか
+        */
+        static std::atomic<bool> enabled_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        Profiler() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        Profiler(Profiler const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        Profiler & operator=(Profiler const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+
+    //! A class.
+    /*!
+        コンストラクタからデストラクタまでの時間を、Profilerに記録するクラス
+    */
+    class ScopedTimer final {
+        // #region コンストラクタ・デストラクタ
+
+    public:
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param name スコープの名前（文字列リテラルなど、プログラムの終了まで有効なもの）
+        */
+        explicit ScopedTimer(char const * name)
+            : pnode_(Profiler::enabled() ? Profiler::enter(name) : nullptr)
+        {
+            if (pnode_) {
+                start_ = std::chrono::steady_clock::now();
+            }
+        }
+
+        //! A destructor.
+        /*!
+            経過時間をProfilerに記録する
+        */
+        ~ScopedTimer()
+        {
+            if (pnode_) {
+                auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start_);
+                Profiler::leave(pnode_, elapsed.count());
+            }
+        }
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ変数
+
+    private:
+        //! A private member variable (constant).
+        /*!
+            計測しているスコープの集計結果（無効のときはnullptr）
+        */
+        Profiler::Node * const pnode_;
+
+        //! A private member variable.
+        /*!
+            スコープに入った時刻
+        */
+        std::chrono::steady_clock::time_point start_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        ScopedTimer() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        ScopedTimer(ScopedTimer const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        ScopedTimer & operator=(ScopedTimer const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _PROFILER_H_
@@ -12,7 +12,12 @@ namespace schrac {
 
     ci_string const Data::ALPHA = "ALPHA";
     ci_string const Data::BETA = "BETA";
-    std::array<std::string, 2> const Data::Chemical_Symbol = { "H", "He" };
+    std::array<std::string, 36> const Data::Chemical_Symbol = {
+        "H", "He",
+        "Li", "Be", "B", "C", "N", "O", "F", "Ne",
+        "Na", "Mg", "Al", "Si", "P", "S", "Cl", "Ar",
+        "K", "Ca", "Sc", "Ti", "V", "Cr", "Mn", "Fe", "Co", "Ni", "Cu", "Zn", "Ga", "Ge", "As", "Se", "Br", "Kr"
+    };
 
     // #region staticメンバ変数
 }
@@ -12,7 +12,10 @@
 #include "ci_string.h"
 #include <array>                // for std::array
 #include <cstdint>              // for std::int32_t, std::uint8_t
+#include <iostream>             // for std::cout, std::ostream
 #include <optional>				// for std::optional
+#include <string>               // for std::string
+#include <vector>               // for std::vector
 
 namespace schrac {
     //! A global variable (constant expression).
@@ -27,6 +30,12 @@ namespace schrac {
     */
     static auto constexpr GRID_NUM_DEFAULT = 20000;
 
+    //! A global variable (constant expression).
+    /*!
+        メッシュを自動で決めるときの、固有値の許容誤差のデフォルト値
+    */
+    static auto constexpr GRID_TOLERANCE_DEFAULT = 1.0E-8;
+
     //! A global variable (constant expression).
     /*!
         マッチングポイント（xmin〜xmaxまでの比率で表す）
@@ -39,6 +48,18 @@ namespace schrac {
     */
     static auto constexpr NUM_OF_PARTITION_DEFAULT = 300;
 
+    //! A global variable (constant expression).
+    /*!
+        ポテンシャルを事前計算した数表を使うかどうかのデフォルト値
+    */
+    static auto constexpr POTENTIAL_TABLE_DEFAULT = true;
+
+    //! A global variable (constant expression).
+    /*!
+        SCFのチェックポイントを書き出す間隔（ループ回数）のデフォルト値
+    */
+    static auto constexpr SCF_CHECKPOINT_INTERVAL_DEFAULT = 1;
+
     //! A global variable (constant expression).
     /*!
         SCFの収束判定条件の値のデフォルト値
@@ -57,6 +78,18 @@ namespace schrac {
     */
     static auto constexpr SCF_MIXING_WEIGHT_DEFAULT = 0.3;
 
+    //! A global variable (constant expression).
+    /*!
+        Pulay混合で保持する電子密度の履歴の数のデフォルト値
+    */
+    static auto constexpr SCF_MIXING_HISTORY_DEFAULT = 5;
+
+    //! A global variable (constant expression).
+    /*!
+        固有値をNewton法で精密化するかどうかのデフォルト値
+    */
+    static auto constexpr SEARCH_NEWTON_DEFAULT = true;
+
     //! A global variable (constant expression).
     /*!
         微分方程式を解くときのメッシュの最大値のデフォルト値
@@ -89,6 +122,30 @@ namespace schrac {
             DIRAC
         };
 
+        //!  A enumerated type
+        /*!
+            電子密度の混合方法の種類を表す列挙型
+        */
+        enum class Mixing_type {
+            // 一次混合
+            SIMPLE,
+            // Anderson混合
+            ANDERSON,
+            // Pulay混合（DIIS）
+            PULAY
+        };
+
+        //!  A enumerated type
+        /*!
+            Poisson方程式の解法の種類を表す列挙型
+        */
+        enum class Poisson_type {
+            // 微分方程式として数値積分する
+            ODE,
+            // 動径方向の累積積分で直接求める
+            DIRECT
+        };
+
         //!  A enumerated type
         /*!
             微分方程式の解法の種類を表す列挙型
@@ -99,11 +156,58 @@ namespace schrac {
             // Bulirsch-Stoer法
             BULIRSCH_STOER,
             // コントロールされたRunge-Kutta法
-            CONTROLLED_RUNGE_KUTTA
+            CONTROLLED_RUNGE_KUTTA,
+            // Numerov法（Schrödinger方程式以外は固定刻みのRunge-Kutta法）
+            NUMEROV
+        };
+
+        //!  A enumerated type
+        /*!
+            交換相関ポテンシャルの種類を表す列挙型
+        */
+        enum class Xc_type {
+            // 交換相関ポテンシャルを使わない
+            NONE,
+            // 局所密度近似（Slater交換とPerdew-Zungerの相関）
+            LDA
         };
 
         // #endregion 列挙型
 
+        // #region 構造体
+
+        //! A struct.
+        /*!
+            電子が占有している一つの殻を表す構造体
+        */
+        struct Shell final {
+            //! A public member variable.
+            /*!
+                主量子数
+            */
+            std::uint8_t n;
+
+            //! A public member variable.
+            /*!
+                方位量子数
+            */
+            std::uint8_t l;
+
+            //! A public member variable.
+            /*!
+                殻の名前（"2p"など）
+            */
+            std::string orbital;
+
+            //! A public member variable.
+            /*!
+                殻を占有している電子の数
+            */
+            std::int32_t occupation;
+        };
+
+        // #endregion 構造体
+
         // #region メンバ変数
 
         //!  A public static member variable (constant expression).
@@ -140,7 +244,7 @@ namespace schrac {
         /*!
             元素記号の配列
         */
-        static std::array<std::string, 2> const Chemical_Symbol;
+        static std::array<std::string, 36> const Chemical_Symbol;
         
         //!  A public member variable.
         /*!
@@ -166,6 +270,18 @@ namespace schrac {
         */
         std::int32_t grid_num_ = GRID_NUM_DEFAULT;
 
+        //!  A public member variable.
+        /*!
+            grid.xmin、grid.xmax及びgrid.numのどれかを自動で決めたかどうか
+        */
+        bool grid_auto_ = false;
+
+        //!  A public member variable.
+        /*!
+            メッシュを自動で決めるときの、固有値の許容誤差
+        */
+        double grid_tolerance_ = GRID_TOLERANCE_DEFAULT;
+
         //!  A public member variable.
         /*!
             全角運動量
@@ -190,6 +306,12 @@ namespace schrac {
         */
         double mat_po_ratio_ = MAT_PO_RATIO_DEFAULT;
 
+        //!  A public member variable.
+        /*!
+            マッチングポイントを、軌道ごとに古典的転回点から決めるかどうか
+        */
+        bool mat_po_auto_ = false;
+
         //!  A public member variable.
         /*!
             主量子数
@@ -202,12 +324,36 @@ namespace schrac {
         */
         std::int32_t num_of_partition_ = NUM_OF_PARTITION_DEFAULT;
 
+        //!  A public member variable.
+        /*!
+            計算の経過や結果を書き出すストリームへのポインタ（デフォルトは標準出力）
+        */
+        std::ostream * pout_ = &std::cout;
+
         //!  A public member variable.
         /*!
             計算対象の軌道
         */
         std::string orbital_;
 
+        //!  A public member variable.
+        /*!
+            ポテンシャルを事前計算した数表を使うかどうか
+        */
+        bool potential_table_ = POTENTIAL_TABLE_DEFAULT;
+
+        //!  A public member variable.
+        /*!
+            Poisson方程式の解法
+        */
+        Data::Poisson_type poisson_type_ = Data::Poisson_type::ODE;
+
+        //!  A public member variable.
+        /*!
+            交換相関ポテンシャルの種類（複数の殻を解く場合だけ使える）
+        */
+        Data::Xc_type xc_type_ = Data::Xc_type::NONE;
+
         //!  A public member variable.
         /*!
             密度の初期値ρ0(r)のための係数c（ρ0(r) = c * exp(- alpha * r)
@@ -220,6 +366,24 @@ namespace schrac {
         */
         std::optional<double> rho0_alpha_;
 
+        //!  A public member variable.
+        /*!
+            密度の初期値ρ0(r)を読み込む電子密度のファイル名（空ならc * exp(- alpha * r)とする）
+        */
+        std::string rho0_file_;
+
+        //!  A public member variable.
+        /*!
+            SCFのチェックポイントのファイル名（空なら書き出さない）
+        */
+        std::string scf_checkpoint_;
+
+        //!  A public member variable.
+        /*!
+            SCFのチェックポイントを書き出す間隔（ループ回数）
+        */
+        std::int32_t scf_checkpoint_interval_ = SCF_CHECKPOINT_INTERVAL_DEFAULT;
+
         //!  A public member variable.
         /*!
             SCFの収束判定条件の値
@@ -238,12 +402,43 @@ namespace schrac {
         */
         double scf_mixing_weight_ = SCF_MIXING_WEIGHT_DEFAULT;
 
+        //!  A public member variable.
+        /*!
+            電子密度を合成する方法
+        */
+        Data::Mixing_type scf_mixing_type_ = Data::Mixing_type::SIMPLE;
+
+        //!  A public member variable.
+        /*!
+            Pulay混合で保持する電子密度の履歴の数
+        */
+        std::int32_t scf_mixing_history_ = SCF_MIXING_HISTORY_DEFAULT;
+
+        //!  A public member variable.
+        /*!
+            SCFを再開するチェックポイントのファイル名（空なら初期密度から始める）
+            SCFのループ回数は保存したときの続きから数え、scf.maxIterはその通算の回数に対する上限とする
+        */
+        std::string scf_restart_;
+
         //!  A public member variable.
         /*!
             固有値探索を始める値
         */
         std::optional<double> search_lowerE_;
 
+        //!  A public member variable.
+        /*!
+            固有値をNewton法で精密化するかどうか（Sch方程式のみ）
+        */
+        bool search_newton_ = SEARCH_NEWTON_DEFAULT;
+
+        //!  A public member variable.
+        /*!
+            電子が占有している殻の配列（空ならorbitalの軌道一つだけを解く）
+        */
+        std::vector<Data::Shell> shells_;
+
         //!  A public member variable.
         /*!
             使用する微分方程式のソルバー
@@ -6,6 +6,8 @@
 */
 
 #include "diffdata.h"
+#include <algorithm>        // for std::clamp
+#include <cmath>            // for std::log, std::sqrt
 #include <boost/cast.hpp>   // for boost::numeric_cast
 
 namespace schrac {
@@ -14,6 +16,9 @@ namespace schrac {
     DiffData::DiffData(std::shared_ptr<Data> const & pdata) :
         node_(pdata->n_ - pdata->l_ - 1),
         pdata_(pdata),
+        // チャンクはメッシュ上の関数4つ分ずつ確保する
+        parena_(std::make_shared<checkpoint::Arena>(sizeof(double) * 4 * (boost::numeric_cast<std::size_t>(pdata->grid_num_) + 1))),
+        pworkspace_(std::make_shared<Workspace>(boost::numeric_cast<std::size_t>(pdata->grid_num_) + 1)),
         thisnode_(0),
         Z_(pdata->Z_)
     {
@@ -27,14 +32,14 @@ namespace schrac {
 
         dx_ = (pdata_->xmax_ - pdata_->xmin_) / static_cast<double>(grid_num - 1);
 
-        // メモリ確保
+        // メモリ確保（odeintで内向きに解くと、終点のx_i_[mp_i_] - dxでも観測されるので一つ余分に取る）
         x_o_.resize(osize);
         x_i_.resize(isize);
         r_mesh_i_.resize(isize);
-        lo_.reserve(osize);
-        li_.reserve(isize);
-        mo_.reserve(osize);
-        mi_.reserve(isize);
+        lo_.resize(osize);
+        li_.resize(isize + 1);
+        mo_.resize(osize);
+        mi_.resize(isize + 1);
 
         auto const len = grid_num - boost::numeric_cast<std::int32_t>(isize);
 
@@ -49,5 +54,23 @@ namespace schrac {
             r_mesh_i_[grid_num - i] = std::exp(x);
         }
     }
+
+    // #endregion コンストラクタ
+
+    // #region publicメンバ関数
+
+    double DiffData::turning_point_ratio(Data const & data, double zeff)
+    {
+        auto const n = static_cast<double>(data.n_);
+        auto const l = static_cast<double>(data.l_);
+        auto const rturn = n * n / zeff * (1.0 + std::sqrt(1.0 - l * (l + 1.0) / (n * n)));
+
+        // 内向き、外向きのどちらにも十分な点が残るようにする
+        return std::clamp((std::log(rturn) - data.xmin_) / (data.xmax_ - data.xmin_),
+                          DiffData::MAT_PO_RATIO_MIN,
+                          DiffData::MAT_PO_RATIO_MAX);
+    }
+
+    // #endregion publicメンバ関数
 }
 
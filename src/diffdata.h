@@ -11,6 +11,9 @@
 #pragma once
 
 #include "data.h"
+#include "simpson.h"
+#include "workspace.h"
+#include "checkpoint/arena.h"
 #include <memory>   // for std::shared_ptr
 #include <vector>   // for std::vector
 
@@ -19,6 +22,8 @@ namespace schrac {
 
     using dvector = std::vector < double > ;
 
+    using arenavector = std::vector < double, checkpoint::ArenaAllocator<double> > ;
+
     // #endregion 型エイリアス
 
     //! A struct.
@@ -43,8 +48,34 @@ namespace schrac {
 
         // #endregion コンストラクタ・デストラクタ
 
+        // #region publicメンバ関数
+
+        //! A public static member function.
+        /*!
+            有効核電荷の水素様原子の外側の古典的転回点r = (n^2 / ζ) * (1 + sqrt(1 - l(l + 1) / n^2))を、
+            マッチングポイント（xmin〜xmaxまでの比率）として求める
+            \param data データオブジェクト（n_、l_、xmin_、xmax_を使う）
+            \param zeff 有効核電荷
+            \return マッチングポイント
+        */
+        static double turning_point_ratio(Data const & data, double zeff);
+
+        // #endregion publicメンバ関数
+
         // #region メンバ変数
 
+        //!  A public static member variable (constant expression).
+        /*!
+            古典的転回点から求めるマッチングポイントの最小値
+        */
+        static auto constexpr MAT_PO_RATIO_MIN = 0.05;
+
+        //!  A public static member variable (constant expression).
+        /*!
+            古典的転回点から求めるマッチングポイントの最大値
+        */
+        static auto constexpr MAT_PO_RATIO_MAX = 0.95;
+
         //!  A public member variable (constant).
         /*!
             ノードの数
@@ -72,24 +103,25 @@ namespace schrac {
         //!  A public member variable.
         /*!
             無限遠に近い点から解いた関数Lの数表
+            （大きさは固定で、odeintで解く場合はmp_i_ + 2個目まで書き込まれる）
         */
         dvector li_;
 
         //!  A public member variable.
         /*!
-            原点に近い点から解いた関数Lの数表
+            原点に近い点から解いた関数Lの数表（大きさはmp_o_ + 1で固定）
         */
         dvector lo_;
 
         //!  A public member variable.
         /*!
-            無限遠に近い点から解いた関数Mの数表
+            無限遠に近い点から解いた関数Mの数表（大きさはli_と同じ）
         */
         dvector mi_;
         
         //!  A public member variable.
         /*!
-            原点に近い点から解いた関数Mの数表
+            原点に近い点から解いた関数Mの数表（大きさはmp_o_ + 1で固定）
         */
         dvector mo_;
 
@@ -111,6 +143,25 @@ namespace schrac {
         */
         dvector r_mesh_;
 
+        //!  A public member variable.
+        /*!
+            SCFのループの一回の間だけ使う作業用の配列を確保するアリーナ
+            （コピーしたオブジェクトとも共有し、ScfLoopがループの終わりにリセットする）
+        */
+        std::shared_ptr<checkpoint::Arena> parena_;
+
+        //!  A public member variable.
+        /*!
+            r_mesh_上の重みをキャッシュしたSimpsonの公式のオブジェクト
+        */
+        std::shared_ptr<Simpson> psimpson_;
+
+        //!  A public member variable.
+        /*!
+            メッシュ上の関数を格納する作業領域（コピーしたオブジェクトとも共有する）
+        */
+        std::shared_ptr<Workspace> pworkspace_;
+
         //!  A public member variable.
         /*!
             無限遠に近い点からのrのメッシュ
@@ -6,10 +6,13 @@
 */
 
 #include "diffsolver.h"
+#include "checkpoint/profiler.h"
 #include <algorithm>                    // for std::copy
 #include <stdexcept>                    // for std::runtime_error
+#include <utility>                      // for std::move
 #include <boost/numeric/odeint.hpp>     // for boost::numeric::odeint
 #include <tbb/parallel_invoke.h>        // for tbb::parallel_invoke
+#include <tbb/task_arena.h>             // for tbb::this_task_arena::isolate
 
 namespace schrac {
     using namespace boost::numeric::odeint;
@@ -20,6 +23,83 @@ namespace schrac {
 
     // #endregion 型エイリアス
 
+    // #region 無名名前空間
+
+    namespace {
+        //! A template class.
+        /*!
+            odeintのステッパーを包み、受け入れられたステップと棄却されたステップを数えるクラス
+            \tparam Stepper 包むステッパーの型
+        */
+        template <typename Stepper>
+        class CountingStepper final {
+        public:
+            using deriv_type = typename Stepper::deriv_type;
+            using state_type = typename Stepper::state_type;
+            using stepper_category = typename Stepper::stepper_category;
+            using time_type = typename Stepper::time_type;
+            using value_type = typename Stepper::value_type;
+
+            //! A constructor.
+            /*!
+                唯一のコンストラクタ
+                \param stepper 包むステッパー
+            */
+            explicit CountingStepper(Stepper const & stepper) : stepper_(stepper) {}
+
+            //! A public member function.
+            /*!
+                刻み幅を制御しないステッパーで一ステップ進める
+            */
+            template <typename System, typename StateInOut>
+            void do_step(System system, StateInOut & x, time_type t, time_type dt)
+            {
+                stepper_.do_step(system, x, t, dt);
+
+                if (auto const pstats = SolveStats::current()) {
+                    pstats->accepted++;
+                }
+            }
+
+            //! A public member function.
+            /*!
+                刻み幅を制御するステッパーで一ステップ進めることを試みる
+            */
+            template <typename System, typename StateInOut>
+            controlled_step_result try_step(System system, StateInOut & x, time_type & t, time_type & dt)
+            {
+                auto const res = stepper_.try_step(system, x, t, dt);
+
+                if (auto const pstats = SolveStats::current()) {
+                    (res == success ? pstats->accepted : pstats->rejected)++;
+                }
+
+                return res;
+            }
+
+        private:
+            //! A private member variable.
+            /*!
+                包むステッパー
+            */
+            Stepper stepper_;
+        };
+
+        //! A template function.
+        /*!
+            ステッパーをCountingStepperで包む
+            \param stepper 包むステッパー
+            \return CountingStepperで包んだステッパー
+        */
+        template <typename Stepper>
+        CountingStepper<Stepper> counting(Stepper const & stepper)
+        {
+            return CountingStepper<Stepper>(stepper);
+        }
+    }
+
+    // #endregion 無名名前空間
+
     // #region コンストラクタ
 
     DiffSolver::DiffSolver(std::shared_ptr<Data> const & pdata, std::shared_ptr<DiffData> const & pdiffdata) :
@@ -32,44 +112,48 @@ namespace schrac {
         pdata_(pdata),
         pdiffdata_(pdiffdata),
         prho_(prho),
-        pvh_(pvh),
-        pvh2_(pvh ? std::make_shared<Vhartree>(*pvh_) : nullptr)
+        pvh_(pvh)
     {
         if (pdata_->chemical_symbol_ == Data::Chemical_Symbol[0]) {
             V_ = [this](double r)
             {
                 return -pdiffdata_->Z_ / r;
             };
-                        
-            V2_ = V_;
 
             dV_dr_ = [this](double r)
             {
                 return pdiffdata_->Z_ / (r * r);
             };
-
-            dV_dr2_ = dV_dr_;
         } else {
             V_ = [this](double r)
             {
                 return -pdiffdata_->Z_ / r + pvh_->vhartree(r);
             };
 
-            V2_ = [this](double r)
-            {
-                return -pdiffdata_->Z_ / r + pvh2_->vhartree(r);
-            };
-
             dV_dr_ = [this](double r)
             {
                 return pdiffdata_->Z_ / (r * r) + pvh_->dvhartree_dr(r);
             };
-
-            dV_dr2_ = [this](double r)
-            {
-                return pdiffdata_->Z_ / (r * r) + pvh2_->dvhartree_dr(r);
-            };
         };
+
+        // 方程式のタイプとソルバーに特殊化された関数を、ここで一度だけ選択する
+        switch (pdata_->eq_type_) {
+        case Data::Eq_type::DIRAC:
+            psolve_diff_equ_ = select_solve_diff_equ<Data::Eq_type::DIRAC>();
+            break;
+
+        case Data::Eq_type::SCH:
+            psolve_diff_equ_ = select_solve_diff_equ<Data::Eq_type::SCH>();
+            break;
+
+        case Data::Eq_type::SDIRAC:
+            psolve_diff_equ_ = select_solve_diff_equ<Data::Eq_type::SDIRAC>();
+            break;
+
+        default:
+            BOOST_ASSERT(!"何かがおかしい！");
+            break;
+        }
     }
 
     // #endregion コンストラクタ
@@ -90,70 +174,45 @@ namespace schrac {
 
     void DiffSolver::initialize(double E)
     {
+        SolveStats::Scope const scope(stats_);
+
         pdiffdata_->E_ = E;         // エネルギーを代入
         pdiffdata_->thisnode_ = 0;  // ノード数初期化
-        am_evaluate();              // am_を求める
+
+        // ポテンシャルは固有値Eに依存しないので、am_と数表は一度だけ求める
+        // （Numerov法は数表の上でしか動作しないので、常に数表を作成する）
+        if (!am_evaluated_) {
+            am_evaluate();
+            am_evaluated_ = true;
+        }
         bm_evaluate();              // bm_を求める
 
-        pdiffdata_->li_.clear();
-        pdiffdata_->mi_.clear();
-        pdiffdata_->lo_.clear();
-        pdiffdata_->mo_.clear();
+        if ((pdata_->potential_table_ || pdata_->solver_type_ == Data::Solver_type::NUMEROV) && !ptable_) {
+            ptable_ = std::make_unique<PotentialTable>(pdiffdata_, V_, dV_dr_);
+        }
+
+        // li_、mi_、lo_及びmo_は大きさが固定で、解くときに先頭から上書きする
     }
 
     void DiffSolver::solve_diff_equ()
     {
-        if (pdata_->usetbb_) {
-            switch (pdata_->solver_type_) {
-            case Data::Solver_type::ADAMS_BASHFORTH_MOULTON:
-                tbb::parallel_invoke(
-                    [this]{ solve_diff_equ_o(adams_bashforth_moulton< 2, myarray >(), V_, dV_dr_); },
-                    [this]{ solve_diff_equ_i(adams_bashforth_moulton< 2, myarray >(), V2_, dV_dr2_); });
-                break;
-
-            case Data::Solver_type::BULIRSCH_STOER:
-                tbb::parallel_invoke(
-                    [this]{ solve_diff_equ_o(bulirsch_stoer < myarray >(pdata_->eps_, pdata_->eps_), V_, dV_dr_); },
-                    [this]{ solve_diff_equ_i(bulirsch_stoer < myarray >(pdata_->eps_, pdata_->eps_), V2_, dV_dr2_); });
-                break;
+        CHECKPOINT_SCOPE("DiffSolver::solve_diff_equ");
+        SolveStats::Scope const scope(stats_);
 
-            case Data::Solver_type::CONTROLLED_RUNGE_KUTTA:
-                tbb::parallel_invoke(
-                    [this]{ solve_diff_equ_o(make_controlled(pdata_->eps_, pdata_->eps_, error_stepper_type()), V_, dV_dr_); },
-                    [this]{ solve_diff_equ_i(make_controlled(pdata_->eps_, pdata_->eps_, error_stepper_type()), V2_, dV_dr2_); });
-                break;
-
-            default:
-                BOOST_ASSERT(!"何かがおかしい！");
-                break;
-            }
-        }
-        else {
-            switch (pdata_->solver_type_) {
-            case Data::Solver_type::ADAMS_BASHFORTH_MOULTON:
-                solve_diff_equ_o(adams_bashforth_moulton< 2, myarray >(), V_, dV_dr_);
-                solve_diff_equ_i(adams_bashforth_moulton< 2, myarray >(), V_, dV_dr_);
-                break;
-
-            case Data::Solver_type::BULIRSCH_STOER:
-                solve_diff_equ_o(bulirsch_stoer < myarray >(pdata_->eps_, pdata_->eps_), V_, dV_dr_);
-                solve_diff_equ_i(bulirsch_stoer < myarray >(pdata_->eps_, pdata_->eps_), V_, dV_dr_);
-                break;
-
-            case Data::Solver_type::CONTROLLED_RUNGE_KUTTA:
-                solve_diff_equ_o(make_controlled(pdata_->eps_, pdata_->eps_, error_stepper_type()), V_, dV_dr_);
-                solve_diff_equ_i(make_controlled(pdata_->eps_, pdata_->eps_, error_stepper_type()), V_, dV_dr_);
-                break;
-
-            default:
-                BOOST_ASSERT(!"何かがおかしい！");
-                break;
-            }
-        }
+        ++solvecount_;
+        (this->*psolve_diff_equ_)();
     }
 
     void DiffSolver::solve_poisson()
     {
+        CHECKPOINT_SCOPE("DiffSolver::solve_poisson");
+        SolveStats::Scope const scope(stats_);
+
+        if (pdata_->poisson_type_ == Data::Poisson_type::DIRECT) {
+            solve_poisson_direct();
+            return;
+        }
+
         switch (pdata_->solver_type_) {
         case Data::Solver_type::ADAMS_BASHFORTH_MOULTON:
             solve_poisson_run(adams_bashforth_moulton< 2, myarray >()); 
@@ -167,6 +226,10 @@ namespace schrac {
             solve_poisson_run(make_controlled(pdata_->eps_, pdata_->eps_, error_stepper_type()));
             break;
 
+        case Data::Solver_type::NUMEROV:
+            solve_poisson_run(runge_kutta4< myarray >());
+            break;
+
         default:
             BOOST_ASSERT(!"何かがおかしい！");
             break;
@@ -193,7 +256,12 @@ namespace schrac {
             b[i] = V_(std::exp(pdata_->xmin_ + static_cast<double>(i) * pdiffdata_->dx_));    
         }
             
-        am_ = solve_linear_equ(a, b);
+        auto const am = solve_linear_equ(a, b);
+        if (!am) {
+            throw std::runtime_error("ポテンシャルの展開係数が求まりませんでした");
+        }
+
+        am_ = *am;
     }
 
     void DiffSolver::bm_evaluate()
@@ -205,95 +273,130 @@ namespace schrac {
         bm_[4] = (am_[0] * bm_[2] + am_[2] * bm_[0] - pdiffdata_->E_ * bm_[2]) / static_cast<double>(4 * pdata_->l_ + 10);
     }
 
-    void DiffSolver::derivs(myarray const & f, myarray & dfdx, double x, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr) const
+    template <Data::Eq_type EqType>
+    void DiffSolver::derivs(myarray const & f, myarray & dfdx, double x) const
     {
         auto const dL_dx = [](double M) { return M; };
 
         // dL / dx = M
         dfdx[0] = dL_dx(f[1]);
-                
-        switch (pdata_->eq_type_) {
-        case Data::Eq_type::DIRAC:
-            // dM / dx 
-            dfdx[1] = dM_dx_dirac(f[0], f[1], x, V, dV_dr);
-            break;
 
-        case Data::Eq_type::SCH:
-            // dM / dx 
-            dfdx[1] = dM_dx_sch(f[0], f[1], x, V);
-            break;
+        auto const pstats = SolveStats::current();
+        if (pstats) {
+            pstats->derivs++;
+        }
 
-        case Data::Eq_type::SDIRAC:
-            // dM / dx 
-            dfdx[1] = dM_dx_sdirac(f[0], f[1], x, V, dV_dr);
-            break;
+        double r, r2, v, dv_dr;
+        if (auto const k = ptable_ ? ptable_->index(x) : std::nullopt) {
+            if (pstats) {
+                pstats->tablehits++;
+            }
 
-        default:
-            BOOST_ASSERT(!"何かがおかしい！！");
-            break;
+            // 数表の点なので、事前計算した値を使う
+            r = ptable_->r(*k);
+            r2 = ptable_->r2(*k);
+            v = ptable_->V(*k);
+            dv_dr = ptable_->dV_dr(*k);
         }
+        else {
+            // V_及びdV_dr_と同じ式だが、Hartreeポテンシャルはxから区間の添字を直接求めて評価する
+            r = std::exp(x);
+            r2 = sqr(r);
+            v = -pdiffdata_->Z_ / r;
+            dv_dr = EqType == Data::Eq_type::SCH ? 0.0 : pdiffdata_->Z_ / r2;
+
+            if (pvh_) {
+                auto const i = pvh_->index(x);
+                v += pvh_->vhartree(i, r);
+                if constexpr (EqType != Data::Eq_type::SCH) {
+                    dv_dr += pvh_->dvhartree_dr(i, r);
+                }
+            }
+        }
+
+        // dM / dx 
+        dfdx[1] = dM_dx<EqType>(f[0], f[1], r, r2, v, dv_dr);
     }
 
-    double DiffSolver::dM_dx_dirac(double L, double M, double x, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr) const
+    template <Data::Eq_type EqType>
+    double DiffSolver::dM_dx(double L, double M, double r, double r2, double v, double dv_dr) const
     {
-        auto const r = std::exp(x);
+        if constexpr (EqType == Data::Eq_type::DIRAC) {
+            return dM_dx_dirac(L, M, r, r2, v, dv_dr);
+        }
+        else if constexpr (EqType == Data::Eq_type::SCH) {
+            return dM_dx_sch(L, M, r2, v);
+        }
+        else {
+            return dM_dx_sdirac(L, M, r, r2, v, dv_dr);
+        }
+    }
 
-        auto const mass = 1.0 + Data::al2half * (pdiffdata_->E_ - V(r));
-        auto const d = Data::al2half * r / mass * dV_dr(r);
+    double DiffSolver::dM_dx_dirac(double L, double M, double r, double r2, double v, double dv_dr) const
+    {
+        auto const mass = 1.0 + Data::al2half * (pdiffdata_->E_ - v);
+        auto const d = Data::al2half * r / mass * dv_dr;
         auto const l = static_cast<double>(pdata_->l_);
 
         // dependence on all angular momentum
         auto const d1 = -(2.0 * l + 1.0 + d) * M;
-        auto const d2 = (2.0 * sqr(r) * mass * (V(r) - pdiffdata_->E_) -
+        auto const d2 = (2.0 * r2 * mass * (v - pdiffdata_->E_) -
             d * (l + 1.0 + pdata_->kappa_)) * L;
 
         return d1 + d2;
     }
 
-    double DiffSolver::dM_dx_sch(double L, double M, double x, std::function<double(double)> const & V) const
+    double DiffSolver::dM_dx_sch(double L, double M, double r2, double v) const
     {
-        auto const r = std::exp(x);
-
         return -(2.0 * static_cast<double>(pdata_->l_) + 1.0) * M +
-               2.0 * sqr(r) * (V(r) - pdiffdata_->E_) * L;
+               2.0 * r2 * (v - pdiffdata_->E_) * L;
     }
 
-    double DiffSolver::dM_dx_sdirac(double L, double M, double x, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr) const
+    double DiffSolver::dM_dx_sdirac(double L, double M, double r, double r2, double v, double dv_dr) const
     {
-        auto const r = std::exp(x);
-
-        auto const mass = 1.0 + Data::al2half * (pdiffdata_->E_ - V(r));
-        auto const d = Data::al2half * r / mass * dV_dr(r);
+        auto const mass = 1.0 + Data::al2half * (pdiffdata_->E_ - v);
+        auto const d = Data::al2half * r / mass * dv_dr;
         auto const l = static_cast<double>(pdata_->l_);
 
         // scaler treatment
         auto const d1 = -(2.0 * l + 1.0 + d) * M;
-        auto const d2 = (2.0 * sqr(r) * mass * (V(r) - pdiffdata_->E_) - d * l) * L;
+        auto const d2 = (2.0 * r2 * mass * (v - pdiffdata_->E_) - d * l) * L;
         
         return d1 + d2;
     }
     
-    void DiffSolver::node_count(dvector const & L)
+    template <Data::Solver_type SolverType>
+    auto DiffSolver::make_stepper() const
     {
-        if (L.size() > 1 && (L.back() * *(++L.rbegin()) < 0.0)) {
-            pdiffdata_->thisnode_++;
+        if constexpr (SolverType == Data::Solver_type::ADAMS_BASHFORTH_MOULTON) {
+            return adams_bashforth_moulton< 2, myarray >();
+        }
+        else if constexpr (SolverType == Data::Solver_type::BULIRSCH_STOER) {
+            return bulirsch_stoer < myarray >(pdata_->eps_, pdata_->eps_);
+        }
+        else {
+            return make_controlled(pdata_->eps_, pdata_->eps_, error_stepper_type());
         }
     }
 
-    myarray DiffSolver::req_lm_i_init_val()
+    std::int32_t DiffSolver::node_count(dvector const & L, std::size_t k) const
+    {
+        return k > 0 && (L[k] * L[k - 1] < 0.0) ? 1 : 0;
+    }
+
+    myarray DiffSolver::req_lm_i_init_val(double r)
     {
-        auto const rmax = pdiffdata_->r_mesh_i_[0];
         auto const a = std::sqrt(-2.0 * pdiffdata_->E_);
-        auto const d = std::exp(-a * rmax);
+        auto const d = std::exp(-a * r);
 
         myarray state;
-        state[0] = d / std::pow(rmax, pdata_->l_ + 1);
+        state[0] = d / std::pow(r, pdata_->l_ + 1);
 
         if (state[0] < DiffSolver::MINVALUE) {
             state[0] = DiffSolver::MINVALUE;
         }
 
-        state[1] = -state[0] * (a + static_cast<double>(pdata_->l_ + 1) / rmax);
+        state[1] = -state[0] * (a + static_cast<double>(pdata_->l_ + 1) / r);
 
         if (std::fabs(state[1]) < DiffSolver::MINVALUE) {
             state[1] = -DiffSolver::MINVALUE;
@@ -302,7 +405,7 @@ namespace schrac {
         return state;
     }
 
-    myarray DiffSolver::req_lm_o_init_val()
+    myarray DiffSolver::req_lm_o_init_val(double r)
     {
         myarray state;
         state[0] = bm_[DiffSolver::BMMAX - 1];
@@ -310,15 +413,15 @@ namespace schrac {
 
         auto const cnt = static_cast<std::int32_t>(DiffSolver::BMMAX - 2);
         for (auto i = cnt; i >= 0; i--) {
-            state[0] *= pdiffdata_->r_mesh_[0];
+            state[0] *= r;
             state[0] += bm_[i];
         }
 
         for (auto i = cnt; i > 0; i--) {
-            state[1] *= pdiffdata_->r_mesh_[0];
+            state[1] *= r;
             state[1] += static_cast<double>(i) * bm_[i];
         }
-        state[1] *= pdiffdata_->r_mesh_[0];
+        state[1] *= r;
 
         return state;
     }
@@ -336,105 +439,412 @@ namespace schrac {
                 rtmp *= pdiffdata_->r_mesh_[i];
             }
 
-            b[i] = - pdiffdata_->r_mesh_[i] * (*prho_)(pdiffdata_->r_mesh_[i]);
+            b[i] = - pdiffdata_->r_mesh_[i] * (*prho_)(i, pdiffdata_->r_mesh_[i]);
         }
 
         auto const bn = solve_linear_equ(a, b);
+        if (!bn) {
+            throw std::runtime_error("電子密度の展開係数が求まりませんでした");
+        }
         
         myarray state{};
         auto const r0 = pdiffdata_->r_mesh_[0];
 
-        state[0] = ((bn[2] / 6.0 * r0 + bn[1] / 3.0) * r0 + bn[0]) * 0.5 * r0;
-        state[1] = ((0.25 * bn[2] * r0 + bn[1] / 3.0) * r0 + 0.5 * bn[0]);
+        state[0] = (((*bn)[2] / 6.0 * r0 + (*bn)[1] / 3.0) * r0 + (*bn)[0]) * 0.5 * r0;
+        state[1] = ((0.25 * (*bn)[2] * r0 + (*bn)[1] / 3.0) * r0 + 0.5 * (*bn)[0]);
 
         return state;
     }
 
+    void DiffSolver::solve_poisson_direct()
+    {
+        auto const & r = pdiffdata_->r_mesh_;
+        auto const & rho = prho_->PRho();
+        auto const n = r.size();
+        auto const dx = pdiffdata_->dx_;
+
+        // 作業用の配列はSCFのループごとに確保し直さないように、ワークスペースから借りる
+        auto & workspace = *pdiffdata_->pworkspace_;
+
+        // x = log(r)での被積分関数（dr = r dx）
+        auto f1 = workspace.acquire();
+        auto f2 = workspace.acquire();
+        for (auto i = 0U; i < n; i++) {
+            f2[i] = rho[i] * r[i] * r[i];
+            f1[i] = f2[i] * r[i];
+        }
+
+        // 区間[x_i, x_(i + 1)]での積分（4次の精度の公式、両端では片側の公式を使う）
+        auto const segment = [dx, n](dvector const & f, std::size_t i) {
+            if (i == 0) {
+                return dx / 24.0 * (9.0 * f[0] + 19.0 * f[1] - 5.0 * f[2] + f[3]);
+            }
+            else if (i == n - 2) {
+                return dx / 24.0 * (9.0 * f[n - 1] + 19.0 * f[n - 2] - 5.0 * f[n - 3] + f[n - 4]);
+            }
+
+            return dx / 24.0 * (-f[i - 1] + 13.0 * (f[i] + f[i + 1]) - f[i + 2]);
+        };
+
+        // 原点からr_0までは、ρ(r)を定数とみなす
+        auto q = workspace.acquire();
+        auto p = workspace.acquire();
+        q[0] = rho[0] * r[0] * r[0] * r[0] / 3.0;
+        for (auto i = 0U; i < n - 1; i++) {
+            q[i + 1] = q[i] + segment(f1, i);
+        }
+
+        p[n - 1] = 0.0;
+        for (auto i = n - 1; i > 0; i--) {
+            p[i - 1] = p[i] + segment(f2, i - 1);
+        }
+
+        // Hartreeポテンシャルはqの領域に上書きする
+        for (auto i = 0U; i < n; i++) {
+            q[i] = q[i] / r[i] + p[i];
+        }
+
+        pvh_->Vhart(q);
+
+        workspace.release(std::move(f1));
+        workspace.release(std::move(f2));
+        workspace.release(std::move(q));
+        workspace.release(std::move(p));
+    }
+
     template <typename Stepper>
     void DiffSolver::solve_poisson_run(Stepper const & stepper)
     {
         auto state = req_poisson_init_val();
         auto const loop = pdiffdata_->r_mesh_.size() - 1;
 
-        std::vector<double> vhart;
-        vhart.reserve(pdiffdata_->r_mesh_.size());
+        auto vhart = pdiffdata_->pworkspace_->acquire();
+        vhart[0] = state[0] / pdiffdata_->r_mesh_[0];
         for (auto i = 0U; i < loop; i++) {
+            // ステッパーはrを区間[r_i, r_(i + 1)]の中でしか動かさないので、区間を探す必要はない
             integrate_adaptive(
-                stepper,
-                [this](myarray const & f, myarray & dfdx, double r) {
+                counting(stepper),
+                [this, i](myarray const & f, myarray & dfdx, double r) {
+                if (auto const pstats = SolveStats::current()) {
+                    pstats->derivs++;
+                }
+
                 dfdx[0] = f[1];
-                dfdx[1] = -r * (*prho_)(r);
+                dfdx[1] = -r * (*prho_)(i, r);
             },
             state,
             pdiffdata_->r_mesh_[i],
             pdiffdata_->r_mesh_[i + 1],
             pdiffdata_->r_mesh_[i + 1] - pdiffdata_->r_mesh_[i]);
 
-            vhart.push_back(state[0] / pdiffdata_->r_mesh_[i]);
-         
+            vhart[i + 1] = state[0] / pdiffdata_->r_mesh_[i + 1];
         }
 
-        vhart.push_back(state[0] / pdiffdata_->r_mesh_.back());
         pvh_->Vhart(vhart);
+        pdiffdata_->pworkspace_->release(std::move(vhart));
     }
 
-    template <typename Stepper>
-    void DiffSolver::solve_diff_equ_i(Stepper const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr)
+    template <Data::Eq_type EqType>
+    DiffSolver::solve_diff_equ_func DiffSolver::select_solve_diff_equ() const
+    {
+        switch (pdata_->solver_type_) {
+        case Data::Solver_type::ADAMS_BASHFORTH_MOULTON:
+            return &DiffSolver::solve_diff_equ_run<EqType, Data::Solver_type::ADAMS_BASHFORTH_MOULTON>;
+            break;
+
+        case Data::Solver_type::BULIRSCH_STOER:
+            return &DiffSolver::solve_diff_equ_run<EqType, Data::Solver_type::BULIRSCH_STOER>;
+            break;
+
+        case Data::Solver_type::CONTROLLED_RUNGE_KUTTA:
+            return &DiffSolver::solve_diff_equ_run<EqType, Data::Solver_type::CONTROLLED_RUNGE_KUTTA>;
+            break;
+
+        case Data::Solver_type::NUMEROV:
+            return &DiffSolver::solve_numerov<EqType>;
+            break;
+
+        default:
+            BOOST_ASSERT(!"何かがおかしい！");
+            return nullptr;
+            break;
+        }
+    }
+
+    template <Data::Eq_type EqType, Data::Solver_type SolverType>
+    void DiffSolver::solve_diff_equ_run()
+    {
+        // ノードの数は、外向きと内向きでそれぞれ数えてから足す
+        std::int32_t nodeo, nodei;
+        if (pdata_->usetbb_) {
+            // 統計は、それぞれのスレッドで別々に数えてから足し合わせる
+            // 待っている間に外側のタスク（同じワーカーを使う別のエネルギーの計算など）を
+            // 横取りしないように、外向きと内向きの二つのタスクだけを実行するよう隔離する
+            SolveStats statso, statsi;
+            tbb::this_task_arena::isolate([this, &nodeo, &nodei, &statso, &statsi] {
+                tbb::parallel_invoke(
+                    [this, &nodeo, &statso] {
+                        SolveStats::Scope const scope(statso);
+                        nodeo = solve_diff_equ_o<EqType>(counting(make_stepper<SolverType>()));
+                    },
+                    [this, &nodei, &statsi] {
+                        SolveStats::Scope const scope(statsi);
+                        nodei = solve_diff_equ_i<EqType>(counting(make_stepper<SolverType>()));
+                    });
+            });
+
+            stats_ += statso;
+            stats_ += statsi;
+        }
+        else {
+            nodeo = solve_diff_equ_o<EqType>(counting(make_stepper<SolverType>()));
+            nodei = solve_diff_equ_i<EqType>(counting(make_stepper<SolverType>()));
+        }
+
+        pdiffdata_->thisnode_ = nodeo + nodei;
+    }
+
+    template <Data::Eq_type EqType, typename Stepper>
+    std::int32_t DiffSolver::solve_diff_equ_i(Stepper const & stepper)
     {
-        myarray state = req_lm_i_init_val();
+        myarray state = req_lm_i_init_val(pdiffdata_->r_mesh_i_[0]);
+        auto & li = pdiffdata_->li_;
+        auto & mi = pdiffdata_->mi_;
+        auto k = std::size_t(0);
+        auto node = 0;
 
         integrate_const(
             stepper,
-            [this, &V, &dV_dr](myarray const & f, myarray & dfdx, double x) { return derivs(f, dfdx, x, V, dV_dr); },
+            [this](myarray const & f, myarray & dfdx, double x) { return derivs<EqType>(f, dfdx, x); },
             state,
             pdiffdata_->x_i_[0],
             pdiffdata_->x_i_[pdiffdata_->mp_i_] - pdiffdata_->dx_,
             - pdiffdata_->dx_,
-            [this](myarray const & f, double const)
+            [this, &li, &mi, &k, &node](myarray const & f, double const)
         {
-            pdiffdata_->li_.push_back(f[0]);
-            pdiffdata_->mi_.push_back(f[1]);
-            node_count(pdiffdata_->li_);
+            if (auto const pstats = SolveStats::current()) {
+                pstats->observed++;
+            }
+
+            BOOST_ASSERT(k < li.size());
+            li[k] = f[0];
+            mi[k] = f[1];
+            node += node_count(li, k++);
         });
+
+        return node;
     }
 
-    template <typename Stepper>
-    void DiffSolver::solve_diff_equ_o(Stepper const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr)
+    template <Data::Eq_type EqType, typename Stepper>
+    std::int32_t DiffSolver::solve_diff_equ_o(Stepper const & stepper)
     {
-        auto state = req_lm_o_init_val();
+        auto state = req_lm_o_init_val(pdiffdata_->r_mesh_[0]);
+        auto & lo = pdiffdata_->lo_;
+        auto & mo = pdiffdata_->mo_;
+        auto k = std::size_t(0);
+        auto node = 0;
+
+        auto const observer = [this, &lo, &mo, &k, &node](myarray const & f, double const)
+        {
+            if (auto const pstats = SolveStats::current()) {
+                pstats->observed++;
+            }
+
+            BOOST_ASSERT(k < lo.size());
+            lo[k] = f[0];
+            mo[k] = f[1];
+            node += node_count(lo, k++);
+        };
 
         integrate_const(
             stepper,
-            [this, &V, &dV_dr](myarray const & f, myarray & dfdx, double x) { return derivs(f, dfdx, x, V, dV_dr); },
+            [this](myarray const & f, myarray & dfdx, double x) { return derivs<EqType>(f, dfdx, x); },
             state,
             pdiffdata_->x_o_[0],
             pdiffdata_->x_o_[pdiffdata_->mp_o_],
             pdiffdata_->dx_,
-            [this](myarray const & f, double const)
-        {
-            pdiffdata_->lo_.push_back(f[0]);
-            pdiffdata_->mo_.push_back(f[1]);
-            node_count(pdiffdata_->lo_);
-        });
+            observer);
 
-        if (pdiffdata_->lo_.size() != static_cast<std::vector<double>::size_type>(pdiffdata_->mp_o_ + 1)) {
-            pdiffdata_->lo_.pop_back();
-            pdiffdata_->mo_.pop_back();
+        if (k != static_cast<std::size_t>(pdiffdata_->mp_o_ + 1)) {
+            // 最後の点は、次の積分の始点として観測し直される
+            k--;
 
             integrate_const(
                 stepper,
-                [this, &V, &dV_dr](myarray const & f, myarray & dfdx, double x) { return derivs(f, dfdx, x, V, dV_dr); },
+                [this](myarray const & f, myarray & dfdx, double x) { return derivs<EqType>(f, dfdx, x); },
                 state,
                 pdiffdata_->x_o_[pdiffdata_->mp_o_],
                 pdiffdata_->x_o_[pdiffdata_->mp_o_] + pdiffdata_->dx_,
                 pdiffdata_->dx_,
-                [this](myarray const & f, double const)
-            {
-                pdiffdata_->lo_.push_back(f[0]);
-                pdiffdata_->mo_.push_back(f[1]);
-                node_count(pdiffdata_->lo_);
+                observer);
+        }
+
+        return node;
+    }
+
+    template <Data::Eq_type EqType>
+    std::int32_t DiffSolver::solve_fixed_step(myarray state, std::size_t kbegin, std::int32_t dir, std::int32_t n, dvector & L, dvector & M)
+    {
+        auto const h = static_cast<double>(dir) * pdiffdata_->dx_;
+
+        // 数表の添字kの点における右辺
+        auto const f = [this](myarray const & s, std::size_t k) {
+            return myarray{ s[1], dM_dx<EqType>(s[0], s[1], ptable_->r(k), ptable_->r2(k), ptable_->V(k), ptable_->dV_dr(k)) };
+        };
+
+        auto k = kbegin;
+        auto node = 0;
+        for (auto i = 0; i < n; i++) {
+            L[i] = state[0];
+            M[i] = state[1];
+            node += node_count(L, i);
+
+            if (i == n - 1) {
+                break;
+            }
+
+            // 中間点は数表の中点（刻みdx / 2）と一致する
+            auto const kmid = k + dir;
+            auto const knext = k + 2 * dir;
+
+            auto const k1 = f(state, k);
+            auto const k2 = f({ state[0] + 0.5 * h * k1[0], state[1] + 0.5 * h * k1[1] }, kmid);
+            auto const k3 = f({ state[0] + 0.5 * h * k2[0], state[1] + 0.5 * h * k2[1] }, kmid);
+            auto const k4 = f({ state[0] + h * k3[0], state[1] + h * k3[1] }, knext);
+
+            if (auto const pstats = SolveStats::current()) {
+                // 右辺はすべて数表の点で評価する
+                pstats->derivs += 4;
+                pstats->tablehits += 4;
+                pstats->accepted++;
+            }
+
+            state[0] += h / 6.0 * (k1[0] + 2.0 * k2[0] + 2.0 * k3[0] + k4[0]);
+            state[1] += h / 6.0 * (k1[1] + 2.0 * k2[1] + 2.0 * k3[1] + k4[1]);
+
+            k = knext;
+        }
+
+        return node;
+    }
+
+    template <Data::Eq_type EqType>
+    void DiffSolver::solve_numerov()
+    {
+        auto const solve_o = [this] {
+            auto const state0 = req_lm_o_init_val(pdiffdata_->r_mesh_[0]);
+
+            if constexpr (EqType == Data::Eq_type::SCH) {
+                auto const L1 = req_lm_o_init_val(pdiffdata_->r_mesh_[1])[0];
+                return solve_numerov_sch(state0, L1, 0, 1, pdiffdata_->mp_o_ + 1, pdiffdata_->lo_, pdiffdata_->mo_);
+            }
+            else {
+                return solve_fixed_step<EqType>(state0, 0, 1, pdiffdata_->mp_o_ + 1, pdiffdata_->lo_, pdiffdata_->mo_);
+            }
+        };
+
+        auto const solve_i = [this] {
+            auto const state0 = req_lm_i_init_val(pdiffdata_->r_mesh_i_[0]);
+            auto const kbegin = static_cast<std::size_t>(2 * pdata_->grid_num_);
+
+            if constexpr (EqType == Data::Eq_type::SCH) {
+                auto const L1 = req_lm_i_init_val(pdiffdata_->r_mesh_i_[1])[0];
+                return solve_numerov_sch(state0, L1, kbegin, -1, pdiffdata_->mp_i_ + 1, pdiffdata_->li_, pdiffdata_->mi_);
+            }
+            else {
+                return solve_fixed_step<EqType>(state0, kbegin, -1, pdiffdata_->mp_i_ + 1, pdiffdata_->li_, pdiffdata_->mi_);
+            }
+        };
+
+        // 数表は読み出すだけなので、外向きと内向きを並列に解いても競合しない
+        std::int32_t nodeo, nodei;
+        if (pdata_->usetbb_) {
+            // 統計は、それぞれのスレッドで別々に数えてから足し合わせる
+            // solve_diff_equ_run()と同じく、外側のタスクを横取りしないように隔離する
+            SolveStats statso, statsi;
+            tbb::this_task_arena::isolate([&solve_o, &solve_i, &nodeo, &nodei, &statso, &statsi] {
+                tbb::parallel_invoke(
+                    [&solve_o, &nodeo, &statso] {
+                        SolveStats::Scope const scope(statso);
+                        nodeo = solve_o();
+                    },
+                    [&solve_i, &nodei, &statsi] {
+                        SolveStats::Scope const scope(statsi);
+                        nodei = solve_i();
+                    });
             });
+
+            stats_ += statso;
+            stats_ += statsi;
         }
+        else {
+            nodeo = solve_o();
+            nodei = solve_i();
+        }
+
+        pdiffdata_->thisnode_ = nodeo + nodei;
+    }
+
+    std::int32_t DiffSolver::solve_numerov_sch(myarray const & state0, double L1, std::size_t kbegin, std::int32_t dir, std::int32_t n, dvector & L, dvector & M)
+    {
+        auto const h = static_cast<double>(dir) * pdiffdata_->dx_;
+        auto const h2 = sqr(h);
+        auto const lhalf = static_cast<double>(pdata_->l_) + 0.5;
+
+        // y'' = g * yのg
+        auto const g = [this, lhalf](std::size_t k) {
+            return 2.0 * ptable_->r2(k) * (ptable_->V(k) - pdiffdata_->E_) + sqr(lhalf);
+        };
+
+        // y = r ** (l + 1 / 2) * L
+        auto const rpow = [this, lhalf](std::size_t k) {
+            return std::pow(ptable_->r(k), lhalf);
+        };
+
+        // ym, y, ypは一つ前、現在、一つ先の点のy（gm, gk, gpも同様）
+        auto k = kbegin;
+        auto node = 0;
+        auto ym = 0.0, gm = 0.0;
+        auto y = rpow(k) * state0[0];
+        auto gk = g(k);
+        auto yp = rpow(k + 2 * dir) * L1;
+        auto gp = g(k + 2 * dir);
+
+        for (auto i = 0; i < n; i++) {
+            auto const p = rpow(k);
+            L[i] = y / p;
+
+            if (i) {
+                // 誤差O(h ** 4)の差分公式でdy / dxを求め、M = dL / dxに戻す
+                auto const dy = ((1.0 - h2 * gp / 6.0) * yp - (1.0 - h2 * gm / 6.0) * ym) / (2.0 * h);
+                M[i] = dy / p - lhalf * L[i];
+            }
+            else {
+                M[i] = state0[1];
+            }
+
+            node += node_count(L, i);
+
+            if (i == n - 1) {
+                break;
+            }
+
+            // 三項漸化式で、終点のMを求めるのに必要な一点先まで進める
+            k += 2 * dir;
+
+            if (auto const pstats = SolveStats::current()) {
+                pstats->accepted++;
+            }
+
+            ym = y;
+            gm = gk;
+            y = yp;
+            gk = gp;
+            gp = g(k + 2 * dir);
+            yp = (2.0 * (1.0 + 5.0 * h2 * gk / 12.0) * y - (1.0 - h2 * gm / 12.0) * ym) / (1.0 - h2 * gp / 12.0);
+        }
+
+        return node;
     }
 
     // #endregion privateメンバ関数
@@ -444,12 +854,7 @@ namespace schrac {
     template void DiffSolver::solve_poisson_run<adams_bashforth_moulton< 2, myarray > >(adams_bashforth_moulton< 2, myarray > const & stepper);
     template void DiffSolver::solve_poisson_run<bulirsch_stoer < myarray > >(bulirsch_stoer < myarray > const & stepper);
     template void DiffSolver::solve_poisson_run<error_stepper_type>(error_stepper_type const & stepper);
-    template void DiffSolver::solve_diff_equ_i<adams_bashforth_moulton< 2, myarray > >(adams_bashforth_moulton< 2, myarray > const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
-    template void DiffSolver::solve_diff_equ_i<bulirsch_stoer < myarray > >(bulirsch_stoer < myarray > const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
-    template void DiffSolver::solve_diff_equ_i<error_stepper_type>(error_stepper_type const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
-    template void DiffSolver::solve_diff_equ_o<adams_bashforth_moulton< 2, myarray > >(adams_bashforth_moulton< 2, myarray > const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
-    template void DiffSolver::solve_diff_equ_o<bulirsch_stoer < myarray > >(bulirsch_stoer < myarray > const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
-    template void DiffSolver::solve_diff_equ_o<error_stepper_type>(error_stepper_type const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
+    template void DiffSolver::solve_poisson_run<runge_kutta4 < myarray > >(runge_kutta4 < myarray > const & stepper);
 
     // #endregion templateメンバ関数の実体化
 }
@@ -11,11 +11,14 @@
 #pragma once
 
 #include "diffdata.h"
+#include "potentialtable.h"
 #include "property.h"
 #include "rho.h"
 #include "solvelinearequ.h"
+#include "solvestats.h"
 #include "vhartree.h"
 #include <functional>
+#include <memory>       // for std::unique_ptr
 
 namespace schrac {
     // #region 型エイリアス
@@ -46,6 +49,7 @@ namespace schrac {
 
     private:
         using mypair = std::pair < myarray, myarray > ;
+        using solve_diff_equ_func = void (DiffSolver::*)();
 
         // #endregion 型エイリアス
 
@@ -92,6 +96,7 @@ namespace schrac {
         //! A public member function.
         /*!
             指定したエネルギー固有値Eで初期化を行う
+            （ポテンシャルの数表を使う場合、最初の呼び出しで数表を作成する）
             \param E 指定したエネルギー固有値
         */
         void initialize(double E);
@@ -126,14 +131,29 @@ namespace schrac {
         */
         void bm_evaluate();
 
+        template <Data::Eq_type EqType>
         //! A private member function (const).
         /*!
-            微分方程式の式を定義する
+            dM / dxを計算する（方程式のタイプはテンプレート引数で与える）
+            \param L L(x)の値
+            \param M M(x)の値
+            \param r rの値
+            \param r2 r ** 2の値
+            \param v ポテンシャルV(r)の値
+            \param dv_dr ポテンシャルの微分dV / drの値
+            \return dM / dxの値
+        */
+        double dM_dx(double L, double M, double r, double r2, double v, double dv_dr) const;
+
+        template <Data::Eq_type EqType>
+        //! A private member function (const).
+        /*!
+            微分方程式の式を定義する（方程式のタイプはテンプレート引数で与える）
             \param f f[0] = L, f[1] = M
             \param dfdx dfdx[0] = dL / dx, dfdx[1] = dM / dx 
             \param x xの値
         */
-        void derivs(myarray const & f, myarray & dfdx, double x, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr) const;
+        void derivs(myarray const & f, myarray & dfdx, double x) const;
         
         //! A private member function (const).
         /*!
@@ -143,12 +163,13 @@ namespace schrac {
             dM / dx = - (2NL + 1 + d)M + 2r^2 * MQ * (V_ - ep) * L - d * (NL + 1 + kappa) * L
             \param L L(x)の値
             \param M M(x)の値
-            \param x xの値
-            \param V ポテンシャルの関数オブジェクト
-            \param dV_dr ポテンシャルの微分の関数オブジェクト
+            \param r rの値
+            \param r2 r ** 2の値
+            \param v ポテンシャルV(r)の値
+            \param dv_dr ポテンシャルの微分dV / drの値
             \return dM / dxの値
         */
-        double dM_dx_dirac(double L, double M, double x, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr) const;
+        double dM_dx_dirac(double L, double M, double r, double r2, double v, double dv_dr) const;
 
         //! A private member function (const).
         /*!
@@ -157,12 +178,11 @@ namespace schrac {
             dM/dx = -(2NL + 1)M + 2r^2(V_ - ep)L
             \param L L(x)の値
             \param M M(x)の値
-            \param x xの値
-            \param V ポテンシャルの関数オブジェクト
-            \param dV_dr ポテンシャルの微分の関数オブジェクト
+            \param r2 r ** 2の値
+            \param v ポテンシャルV(r)の値
             \return dM / dxの値
         */
-        double dM_dx_sch(double L, double M, double x, std::function<double(double)> const & V) const;
+        double dM_dx_sch(double L, double M, double r2, double v) const;
         
         //! A private member function (const).
         /*!
@@ -174,12 +194,13 @@ namespace schrac {
             dM / dx = -(2 * NL + 1 + d)M +(2 * r^2 * MQ(V_ - ep) - d * NL)L
             \param L L(x)の値
             \param M M(x)の値
-            \param x xの値
-            \param V ポテンシャルの関数オブジェクト
-            \param dV_dr ポテンシャルの微分の関数オブジェクト
+            \param r rの値
+            \param r2 r ** 2の値
+            \param v ポテンシャルV(r)の値
+            \param dv_dr ポテンシャルの微分dV / drの値
             \return dM / dxの値
         */
-        double dM_dx_sdirac(double L, double M, double x, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr) const;
+        double dM_dx_sdirac(double L, double M, double r, double r2, double v, double dv_dr) const;
 
         //! A private member function.
         /*!
@@ -187,26 +208,38 @@ namespace schrac {
         */
         void init_lm_o();
 
-        //!  A private member function.
+        template <Data::Solver_type SolverType>
+        //! A private member function (const).
+        /*!
+            微分方程式のソルバーのオブジェクトを生成する
+            \return 微分方程式のソルバーのオブジェクト
+        */
+        auto make_stepper() const;
+
+        //!  A private member function (const).
         /*!
-            L(x)のノードの数をカウントする
+            L(x)の添字kの点で符号が変わったかどうかを調べ、ノードの数の増分を返す
             \param L L(x)の格納されたstd::vector
+            \param k 調べる点の添字（kまでは書き込み済みであること）
+            \return 添字kの点でノードがあれば1、なければ0
         */
-        void node_count(dvector const & L);
+        std::int32_t node_count(dvector const & L, std::size_t k) const;
 
         //! A private member function.
         /*!
             li_とmi_の初期値を求める
+            \param r 初期値を求める点のrの値
             \return li_とmi_の初期値
         */
-        myarray req_lm_i_init_val();
+        myarray req_lm_i_init_val(double r);
 
         //! A private member function.
         /*!
             lo_とmo_の初期値を求める
+            \param r 初期値を求める点のrの値
             \return lo_とmo_の初期値
         */
-        myarray req_lm_o_init_val();
+        myarray req_lm_o_init_val(double r);
 
         //!  A private member function.
         /*!
@@ -215,25 +248,83 @@ namespace schrac {
         */
         myarray req_poisson_init_val();
 
-        template <typename Stepper>
+        template <Data::Eq_type EqType>
+        //! A private member function (const).
+        /*!
+            ソルバーの種類に特殊化されたsolve_diff_equ_run()を選択する
+            \return 特殊化されたsolve_diff_equ_run()へのポインタ
+        */
+        solve_diff_equ_func select_solve_diff_equ() const;
+
+        template <Data::Eq_type EqType, Data::Solver_type SolverType>
+        //! A private member function.
+        /*!
+            原点に近い点と無限遠に近い点から、それぞれ微分方程式を解く
+            （方程式のタイプとソルバーはテンプレート引数で与える）
+        */
+        void solve_diff_equ_run();
+
+        template <Data::Eq_type EqType, typename Stepper>
         //! A private member function.
         /*!
             無限遠に近い点から、微分方程式を解く
             \param stepper 微分方程式のソルバーのアルゴリズム
-            \param V ポテンシャルの関数オブジェクト
-            \param dV_dr ポテンシャルの微分の関数オブジェクト
+            \return 数えたノードの数
         */
-        void solve_diff_equ_i(Stepper const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
+        std::int32_t solve_diff_equ_i(Stepper const & stepper);
 
-        template <typename Stepper>
+        template <Data::Eq_type EqType, typename Stepper>
         //! A private member function.
         /*!
             原点に近い点から、微分方程式を解く
             \param stepper 微分方程式のソルバーのアルゴリズム
-            \param V ポテンシャルの関数オブジェクト
-            \param dV_dr ポテンシャルの微分の関数オブジェクト
+            \return 数えたノードの数
+        */
+        std::int32_t solve_diff_equ_o(Stepper const & stepper);
+
+        template <Data::Eq_type EqType>
+        //! A private member function.
+        /*!
+            ポテンシャルの数表を使い、固定刻みのRunge-Kutta法で微分方程式を解く
+            \param state 始点のLとMの値
+            \param kbegin 始点の数表の添字
+            \param dir 積分の向き（原点から外向きなら1、無限遠から内向きなら-1）
+            \param n 求める点の数（始点を含む）
+            \param L 求めたL(x)を先頭から格納するstd::vector（大きさはn以上）
+            \param M 求めたM(x)を先頭から格納するstd::vector（大きさはn以上）
+            \return 数えたノードの数
+        */
+        std::int32_t solve_fixed_step(myarray state, std::size_t kbegin, std::int32_t dir, std::int32_t n, dvector & L, dvector & M);
+
+        template <Data::Eq_type EqType>
+        //! A private member function.
+        /*!
+            ソルバーがNumerovの場合に、原点に近い点と無限遠に近い点から、それぞれ微分方程式を解く
+        */
+        void solve_numerov();
+
+        //! A private member function.
+        /*!
+            ポテンシャルの数表を使い、Numerov法でSchrödinger方程式を解く
+            y = r ** (l + 1 / 2) * Lとおくと、y'' = (2r ** 2 * (V - E) + (l + 1 / 2) ** 2) * yとなる
+            \param state0 始点のLとMの値
+            \param L1 始点の次の点のLの値
+            \param kbegin 始点の数表の添字
+            \param dir 積分の向き（原点から外向きなら1、無限遠から内向きなら-1）
+            \param n 求める点の数（始点を含む）
+            \param L 求めたL(x)を先頭から格納するstd::vector（大きさはn以上）
+            \param M 求めたM(x)を先頭から格納するstd::vector（大きさはn以上）
+            \return 数えたノードの数
+        */
+        std::int32_t solve_numerov_sch(myarray const & state0, double L1, std::size_t kbegin, std::int32_t dir, std::int32_t n, dvector & L, dvector & M);
+
+        //!  A private member function.
+        /*!
+            Poisson方程式の解を、動径方向の二つの累積積分
+            VH(r) = (1 / r)∫[0, r]ρ(r')r'^2dr' + ∫[r, ∞]ρ(r')r'dr'
+            としてメッシュ上で直接求める
         */
-        void solve_diff_equ_o(Stepper const & stepper, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
+        void solve_poisson_direct();
 
         template <typename Stepper>
         //!  A private member function.
@@ -282,6 +373,12 @@ namespace schrac {
         */
         std::array<double, AMMAX> am_;
 
+        //!  A private member variable.
+        /*!
+            am_を求めたかどうか
+        */
+        bool am_evaluated_ = false;
+
         //!  A private member variable.
         /*!
             L(r)の級数展開の係数bm_
@@ -297,15 +394,21 @@ namespace schrac {
 
         //! A private member variable.
         /*!
-            ポテンシャルの微分V_'(r)の値を返す関数オブジェクトその2（並列計算用）
+            エネルギー固有値
         */
-        std::function<double(double r)> dV_dr2_;
+        double E_;
 
-        //! A private member variable.
+        //! A public member variable.
         /*!
-            エネルギー固有値
+            微分方程式を解いた回数
         */
-        double E_;
+        std::int32_t solvecount_ = 0;
+
+        //! A public member variable.
+        /*!
+            微分方程式の求解の統計（--statsが指定されたときだけ数える）
+        */
+        SolveStats stats_;
 
         //!  A private member variable (constant).
         /*!
@@ -327,23 +430,21 @@ namespace schrac {
 
         //!  A private member variable.
         /*!
-            Hartreeポテンシャルオブジェクト
+            方程式のタイプとソルバーに特殊化されたsolve_diff_equ_run()へのポインタ
         */
-        std::shared_ptr<Vhartree> pvh_;
+        solve_diff_equ_func psolve_diff_equ_;
 
         //!  A private member variable.
         /*!
-            Hartreeポテンシャルオブジェクトその2（並列計算用）
+            Hartreeポテンシャルオブジェクト（評価はconstなので、外向きと内向きの積分で共有する）
         */
-        std::shared_ptr<Vhartree> pvh2_;
+        std::shared_ptr<Vhartree> pvh_;
 
-        //! A private member variable.
+        //!  A private member variable.
         /*!
-            ポテンシャルV_(r)の値を返す関数オブジェクト（並列計算用）
-            \param r rの値
-            \return ポテンシャルV_(r)の値
+            xのメッシュ上で事前計算したポテンシャルの数表
         */
-        std::function<double(double)> V2_;
+        std::unique_ptr<PotentialTable> ptable_;
 
         // #endregion メンバ変数
 
@@ -7,6 +7,7 @@
 
 #include "diracnormalize.h"
 #include "simpson.h"
+#include <algorithm>        // for std::copy
 #include <cmath>            // for std::pow
 #include <utility>          // for std::move
 
@@ -27,14 +28,10 @@ namespace schrac {
         auto const ratio = (std::get<0>(mpval))[0] / (std::get<0>(mpval))[1];
 
         auto const mp_o = pdiffdata_->mp_o_;
-        
-        rf_.reserve(pdata_->grid_num_ + 1);
-        pf_large_.reserve(pdata_->grid_num_ + 1);
-        pf_small_.reserve(pdata_->grid_num_ + 1);
 
         for (auto i = 0; i <= mp_o; i++) {
-            rf_.push_back(std::pow(pdiffdata_->r_mesh_[i], pdata_->l_) * lo[i]);
-            pf_large_.push_back(pdiffdata_->r_mesh_[i] * rf_[i]);
+            rf_[i] = std::pow(pdiffdata_->r_mesh_[i], pdata_->l_) * lo[i];
+            pf_large_[i] = pdiffdata_->r_mesh_[i] * rf_[i];
 
             auto const h = 1.0 /
                 (2.0 / Data::al + Data::al * pdiffdata_->E_ - Data::al * pdiffsolver_->V_(pdiffdata_->r_mesh_[i]));
@@ -42,32 +39,36 @@ namespace schrac {
                 pdiffdata_->r_mesh_[i],
                 static_cast<double>(pdata_->l_ * (pdata_->l_ + 1)) * lo[i] + mo[i]);
 
-            pf_small_.push_back(h * (dG + pdata_->kappa_ * std::pow(pdiffdata_->r_mesh_[i], pdata_->l_) * lo[i]));
-        }        
+            pf_small_[i] = h * (dG + pdata_->kappa_ * std::pow(pdiffdata_->r_mesh_[i], pdata_->l_) * lo[i]);
+        }
 
+        // 内側の解は、r_mesh_i[i]がr_mesh_[grid_num - i]と同じ点
         for (auto i = mp_im1; i >= 0; i--) {
-            rf_.push_back(std::pow(r_mesh_i[i], pdata_->l_) * ratio * li[i]);
-            pf_large_.push_back(r_mesh_i[i] * rf_.back());
+            auto const k = pdata_->grid_num_ - i;
+            rf_[k] = std::pow(r_mesh_i[i], pdata_->l_) * ratio * li[i];
+            pf_large_[k] = r_mesh_i[i] * rf_[k];
             
             auto const h = 1.0 / (2.0 / Data::al + Data::al * pdiffdata_->E_ - Data::al * pdiffsolver_->V_(r_mesh_i[i]));
             auto const dG = ratio * std::pow(r_mesh_i[i], static_cast<double>(pdata_->l_)) *
                 (static_cast<double>(pdata_->l_ + 1) * li[i] + mi[i]);
 
-            pf_small_.push_back(h * (dG + pdata_->kappa_ * std::pow(r_mesh_i[i], pdata_->l_) * ratio * li[i]));
+            pf_small_[k] = h * (dG + pdata_->kappa_ * std::pow(r_mesh_i[i], pdata_->l_) * ratio * li[i]);
         }
 
         normalize();
 
-        rho_.reserve(pdata_->grid_num_ + 1);
         for (auto i = 0; i <= pdata_->grid_num_; i++) {
-            rho_.push_back(sqr(pf_large_[i]) + sqr(pf_small_[i]));
+            rho_[i] = sqr(pf_large_[i]) + sqr(pf_small_[i]);
         }
     }
 
-    Normalize<DiracNormalize>::mymap DiracNormalize::getresult() const
+    Normalize<DiracNormalize>::mymap DiracNormalize::getresult()
     {
+        auto r = pdiffdata_->pworkspace_->acquire();
+        std::copy(pdiffdata_->r_mesh_.begin(), pdiffdata_->r_mesh_.end(), r.begin());
+
         Normalize<DiracNormalize>::mymap wf;
-        wf["1 Mesh (r)"] = pdiffdata_->r_mesh_;
+        wf["1 Mesh (r)"] = std::move(r);
         wf["2 Eigen function"] = std::move(rf_);
         wf["3 Rho (mutiplied 4 * pi * r ** 2)"] = std::move(rho_);
         wf["4 Eigen function large (mutiplied r)"] = std::move(pf_large_);
@@ -78,9 +79,9 @@ namespace schrac {
 
     void DiracNormalize::normalize()
     {
-        Simpson simpson(pdiffdata_->dx_);
+        auto const & simpson = *pdiffdata_->psimpson_;
         auto const n = 1.0 / 
-            std::sqrt(simpson(pf_large_, pdiffdata_->r_mesh_) + simpson(pf_small_, pdiffdata_->r_mesh_));
+            std::sqrt(simpson(pf_large_, pf_large_, 1) + simpson(pf_small_, pf_small_, 1));
         for (auto i = 0; i <= pdata_->grid_num_; i++) {
             rf_[i] *= n;
             pf_large_[i] *= n;
@@ -27,15 +27,21 @@ namespace schrac {
             \param pdiffsolver 微分方程式のデータオブジェクト
         */
         DiracNormalize(std::shared_ptr<DiffSolver> const & pdiffsolver) :
-            Normalize<DiracNormalize>(pdiffsolver)
+            Normalize<DiracNormalize>(pdiffsolver),
+            pf_large_(pdiffdata_->pworkspace_->acquire()),
+            pf_small_(pdiffdata_->pworkspace_->acquire())
         {
         }
 
         //! A destructor.
         /*!
-        デフォルトデストラクタ
+            デストラクタ（借りた配列を作業領域に返却する）
         */
-        ~DiracNormalize() = default;
+        ~DiracNormalize()
+        {
+            pdiffdata_->pworkspace_->release(std::move(pf_large_));
+            pdiffdata_->pworkspace_->release(std::move(pf_small_));
+        }
 
         // #endregion コンストラクタ・デストラクタ
 
@@ -50,10 +56,10 @@ namespace schrac {
     public:
         //! A public member function.
         /*!
-            求めた結果を返す
+            求めた結果を返す（波動関数と電子密度は、このオブジェクトからムーブする）
             \return メッシュと波動関数が格納されたmap
         */
-        Normalize<DiracNormalize>::mymap getresult() const;
+        Normalize<DiracNormalize>::mymap getresult();
 
         // #endregion publicメンバ関数
 
@@ -73,13 +79,13 @@ namespace schrac {
     private:
         //! A private member variable.
         /*!
-            角度方向のrをかけた固有関数のlarge成分
+            角度方向のrをかけた固有関数のlarge成分（作業領域から借りた、メッシュの点の数の大きさの配列）
         */
         dvector pf_large_;
 
         //! A private member variable.
         /*!
-            角度方向のrをかけた固有関数のsmall成分
+            角度方向のrをかけた固有関数のsmall成分（作業領域から借りた、メッシュの点の数の大きさの配列）
         */
         dvector pf_small_;
         
@@ -6,30 +6,56 @@
 */
 
 #include "eigenvaluesearch.h"
-#include <cmath>                // for std::fabs, std::log10
+#include "gslerrorhandleroff.h"
+#include "schnormalize.h"
+#include "checkpoint/profiler.h"
+#include <algorithm>            // for std::max, std::min
+#include <cmath>                // for std::fabs, std::log10, std::sqrt
 #include <iomanip>              // for std::setprecision
 #include <iostream>             // for std::cot, std::cerr
 #include <boost/assert.hpp>     // for BOOST_ASSERT
 #include <boost/cast.hpp>       // for boost::numeric_cast
 #include <gsl/gsl_errno.h>      // for GSL_SUCCESS
 #include <gsl/gsl_roots.h>      // for gsl_root_fsolver
+#include <tbb/parallel_for.h>   // for tbb::parallel_for
+#include <tbb/task_arena.h>     // for tbb::this_task_arena::isolate, tbb::this_task_arena::max_concurrency
 
 namespace schrac {
-    // #region staticメンバ変数
-
-    bool EigenValueSearch::nodeok = false;
-
-    // #endregion staticメンバ変数 
-
     // #region コンストラクタ
 
-    EigenValueSearch::EigenValueSearch(std::shared_ptr<Data> const & pdata, std::shared_ptr<DiffData> const & pdiffdata, std::shared_ptr<Rho> const & prho, std::shared_ptr<Vhartree> const & pvh) :
+    EigenValueSearch::EigenValueSearch(std::shared_ptr<Data> const & pdata, std::shared_ptr<DiffData> const & pdiffdata, std::shared_ptr<Rho> const & prho, std::shared_ptr<Vhartree> const & pvh, std::optional<double> const & Eprev, std::optional<double> const & dEprev) :
+        PBracket([this]() { return std::make_pair(Eroughmin_, Eroughmax_); }, nullptr),
         PData([this]() { return std::cref(pdata_); }, nullptr),
         PDiffSolver([this]() { return std::cref(pdiffsolver_); }, nullptr),
+        PSolveCount([this]() {
+            auto solvecount = pdiffsolver_->solvecount_;
+            for (auto const & worker : workers_) {
+                solvecount += worker->solvecount_;
+            }
+            return solvecount;
+        }, nullptr),
+        PSolveStats([this]() {
+            auto stats = pdiffsolver_->stats_;
+            for (auto const & worker : workers_) {
+                stats += worker->stats_;
+            }
+            return stats;
+        }, nullptr),
+        dEprev_(dEprev),
+        Eprev_(Eprev),
         loop_(1),
         pdata_(pdata),
         pdiffdata_(pdiffdata),
-        pvh_(pvh)
+        prho_(prho),
+        result_(),
+        pvh_(pvh),
+        workers_([this] {
+            return std::make_shared<DiffSolver>(
+                pdata_,
+                std::make_shared<DiffData>(*pdiffdata_),
+                prho_,
+                pvh_);
+        })
     {
         initialize(prho);
         setoutstream();
@@ -41,12 +67,24 @@ namespace schrac {
 
     bool EigenValueSearch::search()
     {
+        CHECKPOINT_SCOPE("EigenValueSearch::search");
+
+        if (Eprev_) {
+            auto const E = pdiffsolver_->E_;
+            if (warm_search()) {
+                return true;
+            }
+
+            // 見つからなかったので、最初から検索し直す
+            pdiffsolver_->E_ = E;
+        }
+
         for (; loop_ < EigenValueSearch::EVALSEARCHMAX; loop_++) {
-            if (!rough_search()) {
+            if (!(pdata_->usetbb_ ? rough_search_parallel() : rough_search())) {
                 return false;
             }
 
-            if (brent() && EigenValueSearch::nodeok) {
+            if (refine()) {
                 return true;
             }
             else {
@@ -67,16 +105,33 @@ namespace schrac {
 
     bool EigenValueSearch::brent()
     {
+        CHECKPOINT_SCOPE("EigenValueSearch::brent");
+
         std::unique_ptr<gsl_root_fsolver, decltype(&gsl_root_fsolver_free)> s(
             gsl_root_fsolver_alloc(gsl_root_fsolver_brent),
             gsl_root_fsolver_free);
 
         gsl_function F;
 
-        F.function = &func_D;
-        F.params = reinterpret_cast<void *>(pdiffsolver_.get());
+        F.function = &EigenValueSearch::func_D_brent;
+        F.params = reinterpret_cast<void *>(this);
 
-        gsl_root_fsolver_set(s.get(), &F, Emin_, Emax_);
+        // GSLのエラーは戻り値で判定する
+        GslErrorHandlerOff const handleroff;
+
+        // Newton法で狭めた区間の両端で符号が同じなら、大まかな検索で求めた区間に戻す
+        if (gsl_root_fsolver_set(s.get(), &F, Emin_, Emax_) != GSL_SUCCESS) {
+            if (Emin_ == Eroughmin_ && Emax_ == Eroughmax_) {
+                return false;
+            }
+
+            Emin_ = Eroughmin_;
+            Emax_ = Eroughmax_;
+
+            if (gsl_root_fsolver_set(s.get(), &F, Emin_, Emax_) != GSL_SUCCESS) {
+                return false;
+            }
+        }
 
         for (; loop_ < EVALSEARCHMAX; loop_++) {
             auto const ret = gsl_root_fsolver_iterate(s.get());
@@ -100,7 +155,7 @@ namespace schrac {
             }
 
             if (pdata_->chemical_symbol_ == Data::Chemical_Symbol[0]) {
-                info(func_D(pdiffsolver_->E_, F.params), pdiffsolver_->E_);
+                info(func_D_brent(pdiffsolver_->E_, F.params), pdiffsolver_->E_);
             }
 
             pdiffsolver_->E_ = gsl_root_fsolver_root(s.get());
@@ -119,31 +174,124 @@ namespace schrac {
         return loop_ != EVALSEARCHMAX;
     }
 
+    double EigenValueSearch::func_D_brent(double E, void * params)
+    {
+        auto const pevs = reinterpret_cast<EigenValueSearch *>(params);
+        pevs->result_ = func_D(E, *pevs->pdiffsolver_);
+
+        return pevs->result_.D_;
+    }
+
+    bool EigenValueSearch::newton()
+    {
+        auto E = 0.5 * (Emin_ + Emax_);
+        auto dEold = Emax_ - Emin_;
+
+        // Emin_での関数Dの値（根はDがこれと同じ符号の点より上にある）
+        auto Dmin = Dold;
+
+        for (; loop_ < EVALSEARCHMAX; loop_++) {
+            result_ = func_D(E, *pdiffsolver_);
+            pdiffsolver_->E_ = E;
+
+            if (result_.node_ != pdiffdata_->node_) {
+                break;
+            }
+
+            auto const dE = SchNormalize(pdiffsolver_).energy_correction();
+
+            if (pdata_->chemical_symbol_ == Data::Chemical_Symbol[0]) {
+                info(result_.D_, E);
+            }
+
+            // Brent法と同じく、Eに対する相対誤差で収束を判定する
+            auto const tol = pdata_->eps_ * std::max(std::fabs(E), 1.0);
+            if (std::fabs(dE) <= tol) {
+                return true;
+            }
+
+            // Dの符号から根のある側が分かるので、区間を狭める
+            auto const rootabove = result_.D_ * Dmin > 0.0;
+            if (rootabove) {
+                Emin_ = E;
+                Dmin = result_.D_;
+            }
+            else {
+                Emax_ = E;
+            }
+
+            if (Emax_ - Emin_ <= tol) {
+                return true;
+            }
+
+            // 補正が二次収束で減らなくなったとき、十分小さければ丸め誤差の限界に達したとみなす
+            auto const stalled = std::fabs(dE) >= 0.5 * std::fabs(dEold);
+            if (stalled && std::fabs(dE) < std::sqrt(pdata_->eps_) * std::max(std::fabs(E), 1.0)) {
+                return true;
+            }
+
+            dEold = dE;
+
+            // 補正の向きが区間と食い違うとき、区間の外に出るとき、補正が減らないときは二分法で進む
+            auto const Enew = E + dE;
+            if (stalled || (dE > 0.0) != rootabove || Enew <= Emin_ || Enew >= Emax_) {
+                E = 0.5 * (Emin_ + Emax_);
+            }
+            else {
+                E = Enew;
+            }
+        }
+
+        return brent();
+    }
+
+    bool EigenValueSearch::refine()
+    {
+        Eroughmin_ = Emin_;
+        Eroughmax_ = Emax_;
+
+        auto const ok = pdata_->eq_type_ == Data::Eq_type::SCH && pdata_->search_newton_ ? newton() : brent();
+
+        return ok && result_.node_ == pdiffdata_->node_;
+    }
+
     void EigenValueSearch::info() const
     {
-        std::cout << "i = " << loop_ << ", D = " << Dold << ", node = "
-            << pdiffdata_->thisnode_;
+        *pdata_->pout_ << "i = " << loop_ << ", D = " << Dold << ", node = "
+            << result_.node_;
 
-        if (EigenValueSearch::nodeok) {
-            std::cout << " (OK)" << std::endl;
+        if (result_.node_ == pdiffdata_->node_) {
+            *pdata_->pout_ << " (OK)" << std::endl;
         } 
         else {
-            std::cout << " (NG)" << std::endl;
+            *pdata_->pout_ << " (NG)" << std::endl;
         }
     }
         
     void EigenValueSearch::info(double D, double E) const
     {
-        std::cout << "i = " << loop_ << ", D = "
+        *pdata_->pout_ << "i = " << loop_ << ", D = "
             << D << ", E = " << E
             << ", node = "
-            << pdiffdata_->thisnode_;
+            << result_.node_;
 
-        if (EigenValueSearch::nodeok) {
-            std::cout << " (OK)" << std::endl;
+        if (result_.node_ == pdiffdata_->node_) {
+            *pdata_->pout_ << " (OK)" << std::endl;
         } 
         else {
-            std::cout << " (NG)" << std::endl;
+            *pdata_->pout_ << " (NG)" << std::endl;
+        }
+    }
+
+    void EigenValueSearch::info(std::int32_t loop, double D, std::int32_t node) const
+    {
+        *pdata_->pout_ << "i = " << loop << ", D = " << D << ", node = " << node;
+
+        if (node == pdiffdata_->node_) {
+            *pdata_->pout_ << " (OK)" << std::endl;
+        }
+        else {
+            *pdata_->pout_ << " (NG)" << std::endl;
         }
     }
 
@@ -178,8 +326,10 @@ namespace schrac {
 
     bool EigenValueSearch::rough_search()
     {
-        auto pdiffsolver = reinterpret_cast<void *>(pdiffsolver_.get());
-        Dold = func_D(pdiffsolver_->E_, pdiffsolver);
+        CHECKPOINT_SCOPE("EigenValueSearch::rough_search");
+
+        result_ = func_D(pdiffsolver_->E_, *pdiffsolver_);
+        Dold = result_.D_;
 
         if (pdata_->chemical_symbol_ == Data::Chemical_Symbol[0]) {
             info();
@@ -194,8 +344,9 @@ namespace schrac {
                 return false;
             }
 
-            auto const Dnew = func_D(pdiffsolver_->E_, pdiffsolver);
-     
+            result_ = func_D(pdiffsolver_->E_, *pdiffsolver_);
+            auto const Dnew = result_.D_;
+
             if (Dnew * Dold < 0.0) {
                 Emax_ = pdiffsolver_->E_;
                 Emin_ = pdiffsolver_->E_ - DE_;
@@ -213,28 +364,131 @@ namespace schrac {
         return loop_ != EVALSEARCHMAX;
     }
 
+    bool EigenValueSearch::rough_search_parallel()
+    {
+        CHECKPOINT_SCOPE("EigenValueSearch::rough_search_parallel");
+
+        // 一度に並列に求めるエネルギーの数
+        auto const blocksize = tbb::this_task_arena::max_concurrency();
+
+        std::vector<double> D(blocksize), E(blocksize);
+        std::vector<std::int32_t> node(blocksize);
+
+        // 一つ前のブロックの最後の点（最初のブロックでは存在しない）
+        auto first = true;
+        auto Eold = 0.0;
+        auto nodeold = 0;
+
+        while (loop_ < EigenValueSearch::EVALSEARCHMAX) {
+            // E > 0の点は求めない
+            auto n = 0;
+            for (; n < blocksize && loop_ + n < EigenValueSearch::EVALSEARCHMAX; n++) {
+                E[n] = pdiffsolver_->E_ + static_cast<double>(first ? n : n + 1) * DE_;
+                if (E[n] > 0.0) {
+                    break;
+                }
+            }
+
+            if (!n) {
+                return false;
+            }
+
+            // ワーカーのDiffSolverは中でparallel_invokeを待つので、その間に同じスレッドが
+            // このparallel_forの別の点を横取りして、同じワーカーを上書きしないように隔離する
+            tbb::parallel_for(0, n, [this, &D, &E, &node](std::int32_t i) {
+                tbb::this_task_arena::isolate([this, &D, &E, &node, i] {
+                    auto const res = func_D(E[i], *workers_.local());
+                    D[i] = res.D_;
+                    node[i] = res.node_;
+                });
+            });
+
+            // 低いエネルギーから順に、ノードの数が正しい符号の変化を探す
+            for (auto i = 0; i < n; i++, loop_++) {
+                auto const bracket = !first &&
+                                     D[i] * Dold < 0.0 &&
+                                     (node[i] == pdiffdata_->node_ || nodeold == pdiffdata_->node_);
+
+                first = false;
+
+                if (bracket) {
+                    Emax_ = E[i];
+                    Emin_ = Eold;
+                    pdiffsolver_->E_ = Emax_;
+
+                    return true;
+                }
+
+                Dold = D[i];
+                Eold = E[i];
+                nodeold = node[i];
+
+                if (pdata_->chemical_symbol_ == Data::Chemical_Symbol[0]) {
+                    info(loop_, D[i], node[i]);
+                }
+            }
+
+            pdiffsolver_->E_ = E[n - 1];
+        }
+
+        return false;
+    }
+
     void EigenValueSearch::setoutstream() const
     {
-        std::cout.setf(std::ios::fixed, std::ios::floatfield);
-        std::cout << std::setprecision(
+        pdata_->pout_->setf(std::ios::fixed, std::ios::floatfield);
+        *pdata_->pout_ << std::setprecision(
             boost::numeric_cast<std::streamsize>(std::fabs(std::log10(pdata_->eps_))));
     }
     
+    bool EigenValueSearch::warm_search()
+    {
+        auto const E0 = *Eprev_;
+        auto const node = pdiffdata_->node_;
+
+        // 最初の幅は前回の変化量の2倍（分からなければ大まかな検索の刻み）とし、
+        // 最初の幅と大まかな検索の刻みの大きい方のWARMEXPAND倍を超えたらあきらめる
+        auto const DEmin = 100.0 * pdata_->eps_ * std::fabs(E0);
+        auto width = dEprev_ ? std::max(2.0 * std::fabs(*dEprev_), DEmin) : DE_;
+        auto const widthmax = WARMEXPAND * std::max(width, DE_);
+
+        auto const res0 = func_D(E0, *pdiffsolver_);
+        ++loop_;
+
+        for (; width <= widthmax && loop_ < EigenValueSearch::EVALSEARCHMAX; width *= WARMEXPAND) {
+            for (auto const E : { E0 - width, E0 + width }) {
+                if (E > 0.0) {
+                    continue;
+                }
+
+                auto const res = func_D(E, *pdiffsolver_);
+                ++loop_;
+
+                if (res.D_ * res0.D_ < 0.0 && (res.node_ == node || res0.node_ == node)) {
+                    Emin_ = std::min(E, E0);
+                    Emax_ = std::max(E, E0);
+                    Dold = E < E0 ? res.D_ : res0.D_;
+                    pdiffsolver_->E_ = Emax_;
+
+                    return refine();
+                }
+            }
+        }
+
+        return false;
+    }
+
     // #endregion privateメンバ関数 
 
     // #region 非メンバ関数
 
-    double func_D(double E, void * params)
+    FuncDResult func_D(double E, DiffSolver & diffsolver)
     {
-        auto pdiffsolver = reinterpret_cast<DiffSolver *>(params);
-        pdiffsolver->initialize(E);
-        pdiffsolver->solve_diff_equ();
-
-        EigenValueSearch::nodeok = 
-            pdiffsolver->PDiffData()->node_ == pdiffsolver->PDiffData()->thisnode_;
+        diffsolver.initialize(E);
+        diffsolver.solve_diff_equ();
 
-        auto [L, M] = pdiffsolver->getMPval();
-        return M[0] - (L[0] / L[1]) * M[1];
+        auto [L, M] = diffsolver.getMPval();
+        return { M[0] - (L[0] / L[1]) * M[1], diffsolver.PDiffData()->thisnode_ };
     }
 
     double Eapprox_dirac(std::shared_ptr<Data> const & pdata)
@@ -11,8 +11,30 @@
 #pragma once
 
 #include "diffsolver.h"
+#include <optional>                         // for std::optional
+#include <utility>                          // for std::pair
+#include <vector>                           // for std::vector
+#include <tbb/enumerable_thread_specific.h> // for tbb::enumerable_thread_specific
 
 namespace schrac {
+    //! A struct.
+    /*!
+        関数Dを一回求めた結果を集めた構造体
+    */
+    struct FuncDResult final {
+        //!  A public member variable.
+        /*!
+            関数Dの値
+        */
+        double D_;
+
+        //!  A public member variable.
+        /*!
+            微分方程式を解くことによって得たノードの数
+        */
+        std::int32_t node_;
+    };
+
     //! A class.
     /*!
         エネルギー固有値検索を行うクラス
@@ -24,9 +46,14 @@ namespace schrac {
         //! A constructor.
         /*!
             唯一のコンストラクタ
-            \param arg インプットファイル名とTBBを使用するかどうかのstd::pair
+            \param pdata データオブジェクト
+            \param pdiffdata 微分方程式のデータオブジェクト
+            \param prho 密度ρのオブジェクト
+            \param pvh Hartreeポテンシャルオブジェクト
+            \param Eprev 前回のSCFで求めた固有値（ウォームスタートしないならstd::nullopt）
+            \param dEprev 前回のSCFでの固有値の変化量（分からないならstd::nullopt）
         */
-        EigenValueSearch(std::shared_ptr<Data> const & pdata, std::shared_ptr<DiffData> const & pdiffdata, std::shared_ptr<Rho> const & prho, std::shared_ptr<Vhartree> const & pvh);
+        EigenValueSearch(std::shared_ptr<Data> const & pdata, std::shared_ptr<DiffData> const & pdiffdata, std::shared_ptr<Rho> const & prho, std::shared_ptr<Vhartree> const & pvh, std::optional<double> const & Eprev = std::nullopt, std::optional<double> const & dEprev = std::nullopt);
 
         //! A destructor.
         /*!
@@ -38,6 +65,13 @@ namespace schrac {
 
         // #region プロパティ
 
+        //! A property.
+        /*!
+            最後に大まかな検索で求めた、根を挟む区間を得る
+            \return 区間[Emin, Emax]のstd::pair
+        */
+        Property<std::pair<double, double>> const PBracket;
+
         //! A property.
         /*!
             データオブジェクトを得る
@@ -52,6 +86,20 @@ namespace schrac {
         */
         Property<std::shared_ptr<DiffSolver>> const PDiffSolver;
 
+        //! A property.
+        /*!
+            固有値の検索で微分方程式を解いた回数を得る
+            \return 微分方程式を解いた回数
+        */
+        Property<std::int32_t> const PSolveCount;
+
+        //! A property.
+        /*!
+            固有値の検索で微分方程式を解いたときの統計を得る（並列計算用のワーカーの分も含む）
+            \return 微分方程式の求解の統計
+        */
+        Property<SolveStats> const PSolveStats;
+
         // #endregion プロパティ
 
         // #region メンバ関数
@@ -68,10 +116,35 @@ namespace schrac {
         //! A private member function.
         /*!
             Brent法で、関数Dの根を計算する
+            （区間[Emin_, Emax_]の両端でDの符号が同じときは、大まかな検索で求めた区間からやり直す）
             \return 根が見つかったかどうか
         */
         bool brent();
 
+        //! A private static member function.
+        /*!
+            Brent法（GSL）に渡す関数Dで、求めた結果をresult_に保存する
+            \param E エネルギー固有値
+            \param params EigenValueSearchオブジェクトのポインタを無理矢理void *にキャスト
+            \return 関数Dの値
+        */
+        static double func_D_brent(double E, void * params);
+
+        //! A private member function.
+        /*!
+            一次の摂動論によるエネルギー補正を使ったNewton法で、関数Dの根を計算する
+            （Dの符号で区間[Emin_, Emax_]を狭め、補正が区間の外に出たときや向きが合わないときは二分法で進む）
+            \return 根が見つかったかどうか
+        */
+        bool newton();
+
+        //! A private member function.
+        /*!
+            区間[Emin_, Emax_]にある関数Dの根を、Newton法かBrent法で計算する
+            \return 正しいノード数の根が見つかったかどうか
+        */
+        bool refine();
+
         //! A private member function (const).
         /*!
             現在のループをメッセージで報告する
@@ -91,6 +164,15 @@ namespace schrac {
             \param E 関数Dの引数E
         */
         void info(double D, double E) const;
+
+        //! A private member function (const).
+        /*!
+            並列に求めた関数Dの値とノードの数をメッセージで報告する
+            \param loop 関数Dを求めたときのループ回数
+            \param D 関数Dの値
+            \param node 関数Dを求めたときのノードの数
+        */
+        void info(std::int32_t loop, double D, std::int32_t node) const;
         
         //! A private member function.
         /*!
@@ -106,11 +188,25 @@ namespace schrac {
         */
         bool rough_search();
 
+        //! A private member function.
+        /*!
+            複数のエネルギーで関数Dを並列に求めて、固有値を大まかに検索する
+            \return 固有値が見つかったかどうか
+        */
+        bool rough_search_parallel();
+
         //! A private member function (const).
         /*!
             表示する浮動小数点の桁を設定する
         */
         void setoutstream() const;
+
+        //! A private member function.
+        /*!
+            前回のSCFの固有値の周りで、幅を広げながら固有値を検索する
+            \return 固有値が見つかったかどうか
+        */
+        bool warm_search();
         
         // #endregion メンバ関数
 
@@ -122,13 +218,12 @@ namespace schrac {
         */
         static constexpr auto EVALSEARCHMAX = 10000;
 
-    public:
-        //! A public static member variable.
+        //! A private member variable (constant expression).
         /*!
-            固有関数のノードが一致しているかどうか
+            ウォームスタートで、検索する幅を広げるときの倍率
         */
-        static bool nodeok;
-           
+        static constexpr auto WARMEXPAND = 8.0;
+
     private:
         //! A private member variable.
         /*!
@@ -136,6 +231,18 @@ namespace schrac {
         */
         double DE_;
 
+        //! A private member variable (constant).
+        /*!
+            前回のSCFでの固有値の変化量
+        */
+        std::optional<double> const dEprev_;
+
+        //! A private member variable (constant).
+        /*!
+            前回のSCFで求めた固有値
+        */
+        std::optional<double> const Eprev_;
+
         //! A private member variable.
         /*!
             Brent法におけるエネルギー固有値の大きい方
@@ -148,6 +255,18 @@ namespace schrac {
         */
         double Emin_;
 
+        //! A private member variable.
+        /*!
+            大まかな検索で求めた、根を挟む区間のエネルギー固有値の大きい方
+        */
+        double Eroughmax_;
+
+        //! A private member variable.
+        /*!
+            大まかな検索で求めた、根を挟む区間のエネルギー固有値の小さい方
+        */
+        double Eroughmin_;
+
         //! A private member variable.
         /*!
             エネルギー固有値の近似値
@@ -156,7 +275,7 @@ namespace schrac {
 
         //! A private member variable.
         /*!
-            関数Dの古い値
+            関数Dの古い値（根を挟む区間が見つかった後は、Emin_での関数Dの値）
         */
         double Dold;
         
@@ -184,11 +303,30 @@ namespace schrac {
         */
         std::shared_ptr<DiffData> const pdiffdata_;
 
+        //!  A private member variable.
+        /*!
+            関数ρ(r)
+        */
+        std::shared_ptr<Rho> prho_;
+
+        //!  A private member variable.
+        /*!
+            最後に求めた関数Dの結果
+        */
+        FuncDResult result_;
+
         //!  A private member variable.
         /*!
             Hartreeポテンシャルオブジェクト
         */
         std::shared_ptr<Vhartree> pvh_;
+
+        //!  A private member variable.
+        /*!
+            並列に固有値を検索するときの、スレッドごとの微分方程式オブジェクト
+            （DiffDataとVhartreeもスレッドごとに複製して持つ）
+        */
+        tbb::enumerable_thread_specific<std::shared_ptr<DiffSolver>> workers_;
         
         // #endregion メンバ変数
 
@@ -224,10 +362,10 @@ namespace schrac {
     /*!
         関数Dの値を求める
         \param E エネルギー固有値
-        \param params DiffSolverオブジェクトのポインタを無理矢理Void *にキャスト
-        \return 関数Dの値
+        \param diffsolver 微分方程式オブジェクト（スレッドごとに別のものを渡す）
+        \return 関数Dの値とノードの数
     */
-    double func_D(double E, void * params);
+    FuncDResult func_D(double E, DiffSolver & diffsolver);
 
     //! A function.
     /*!
@@ -8,15 +8,15 @@
 
 #include "energy.h"
 #include "simpson.h"
-#include <iostream>             // for std::cout
+#include <ostream>              // for std::endl
 
 namespace schrac {
     // #region コンストラクタ
 
-    Energy::Energy(std::shared_ptr<DiffData> const & pdiffdata, dvector const & r, dvector const & rf, double Z) :
+    Energy::Energy(std::shared_ptr<DiffData> const & pdiffdata, dvector const & rf, double Z) :
         pdiffdata_(pdiffdata),
         rf_(rf),
-        potcoulomb_energy_(- Z * Simpson(pdiffdata->dx_)(rf, rf, r, 2))
+        potcoulomb_energy_(- Z * (*pdiffdata->psimpson_)(rf, rf, 2))
     {
     }
 
@@ -24,7 +24,7 @@ namespace schrac {
     
     // #region メンバ関数
 
-    void Energy::express_energy(std::optional<double> const & ehartree) const
+    double Energy::express_energy(std::optional<double> const & ehartree) const
     {
         kinetic_energy();
         if (ehartree) {
@@ -36,39 +36,42 @@ namespace schrac {
         }
 
         eigenvalue();
-        total_energy(ehartree);
+        return total_energy(ehartree);
     }
 
     void Energy::coulomb_energy() const
     {
-        std::cout << "E(Coulomb Energy)\t= " << potcoulomb_energy_ << std::endl;
+        *pdiffdata_->pdata_->pout_ << "E(Coulomb Energy)\t= " << potcoulomb_energy_ << std::endl;
     }
 
     void Energy::eigenvalue() const
     {
-        std::cout << "E(Eigenvalue)\t\t= " << pdiffdata_->E_ << std::endl;
+        *pdiffdata_->pdata_->pout_ << "E(Eigenvalue)\t\t= " << pdiffdata_->E_ << std::endl;
     }
 
     void Energy::hartree_energy(double ehartree) const
     {
-        std::cout << "E(Hartree Energy)\t= " << ehartree << std::endl;
+        *pdiffdata_->pdata_->pout_ << "E(Hartree Energy)\t= " << ehartree << std::endl;
     }
 
     void Energy::kinetic_energy() const
     {
-        std::cout << "E(Kinetic Energy)\t= " << -0.5 * potcoulomb_energy_ << std::endl;
+        *pdiffdata_->pdata_->pout_ << "E(Kinetic Energy)\t= " << -0.5 * potcoulomb_energy_ << std::endl;
     }
 
     void Energy::potential_energy() const
     {
-        std::cout << "E(Potential Energy)\t= " << potcoulomb_energy_ << std::endl;
+        *pdiffdata_->pdata_->pout_ << "E(Potential Energy)\t= " << potcoulomb_energy_ << std::endl;
     }
 
-    void Energy::total_energy(std::optional<double> const & ehartree) const
+    double Energy::total_energy(std::optional<double> const & ehartree) const
     {
-        std::cout << "E(Total Energy)\t\t= "; 
-        std::cout << (ehartree ? 2.0 * pdiffdata_->E_ - *ehartree : pdiffdata_->E_);
-        std::cout << std::endl;
+        auto const etotal = ehartree ? 2.0 * pdiffdata_->E_ - *ehartree : pdiffdata_->E_;
+        *pdiffdata_->pdata_->pout_ << "E(Total Energy)\t\t= "; 
+        *pdiffdata_->pdata_->pout_ << etotal;
+        *pdiffdata_->pdata_->pout_ << std::endl;
+
+        return etotal;
     }
 
     // #endregion メンバ関数
@@ -36,7 +36,7 @@ namespace schrac {
             \param pf 規格化された波動関数
             \param Z 原子核の電荷
         */
-        Energy(std::shared_ptr<DiffData> const & pdiffdata, dvector const & r, dvector const & rf, double Z);
+        Energy(std::shared_ptr<DiffData> const & pdiffdata, dvector const & rf, double Z);
 
         //! A destructor.
         /*!
@@ -49,8 +49,10 @@ namespace schrac {
         //! A public member function (const).
         /*!
             エネルギーを表示する
+            \param ehartree Hartreeエネルギー（水素原子の場合はstd::nullopt）
+            \return 全エネルギー
         */
-        void express_energy(std::optional<double> const & ehartree) const;
+        double express_energy(std::optional<double> const & ehartree) const;
 
     private:
         //! A private member function (const).
@@ -86,8 +88,10 @@ namespace schrac {
         //! A private member function (const).
         /*!
             全エネルギーを表示する
+            \param ehartree Hartreeエネルギー（水素原子の場合はstd::nullopt）
+            \return 全エネルギー
         */
-        void total_energy(std::optional<double> const & ehartree) const;
+        double total_energy(std::optional<double> const & ehartree) const;
 
         // #endregion メンバ関数
 
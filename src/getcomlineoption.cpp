@@ -6,6 +6,7 @@
 */
 
 #include "getcomlineoption.h"
+#include "ci_string.h"
 #include <iostream>                     // for std::cerr, std::cout
 #include <boost/program_options.hpp>    // for boost::program_options
 
@@ -30,7 +31,21 @@ namespace schrac {
             ("help,h", "ヘルプを表示")
             ("inputfile,I", value<std::string>()->default_value(GetComLineOption::DEFINPNAME), "インプットファイル名")
             ("tbb,T", value<bool>()->implicit_value(false),
-             "TBBを使用して並列計算を行うかどうか（デフォルトはTBBを使用しない）");
+             "TBBを使用して並列計算を行うかどうか（デフォルトはTBBを使用しない）")
+            ("output-format,O", value<std::string>()->default_value("csv"),
+             "波動関数を書き出すファイルの形式（csvまたはbinary）")
+            ("convert,C", value<std::string>(),
+             "指定したバイナリファイルをCSV形式のファイルに変換して終了")
+            ("batch,B", value<std::string>(),
+             "インプットファイルの一覧が書かれたファイル（またはインプットファイルのあるディレクトリ）を指定してまとめて計算")
+            ("jobs,J", value<std::int32_t>()->default_value(0),
+             "バッチ実行とパラメータスキャンで同時に実行するジョブの数（デフォルトは自動）")
+            ("sweep,S", value<std::string>(),
+             "指定したインプットファイルのパラメータスキャンを行う")
+            ("profile,P", "終了時に関数ごとの計測結果を木の形で表示")
+            ("profile-json", value<std::string>(),
+             "終了時に関数ごとの計測結果をJSON形式で指定したファイルに書き出す")
+            ("stats", "SCFの各ステップで、右辺の評価回数やステップ数などの微分方程式の求解の統計を表示");
 
         // 引数の書式に従って実際に指定されたコマンドライン引数を解析
         variables_map vm;
@@ -61,6 +76,59 @@ namespace schrac {
             usetbb_ = vm["tbb"].as<bool>();
         }
 
+        // 出力形式の指定がある場合
+        if (vm.count("output-format")) {
+            auto const format(vm["output-format"].as<std::string>());
+            auto const cformat = ci_string(format.c_str());
+            if (cformat == "csv") {
+                outputtype_ = WaveFunctionSave::Output_type::CSV;
+            }
+            else if (cformat == "binary") {
+                outputtype_ = WaveFunctionSave::Output_type::BINARY;
+            }
+            else {
+                std::cerr << "出力形式 " << format
+                          << " は不正です。csvかbinaryを指定してください。終了します。" << std::endl;
+
+                return -1;
+            }
+        }
+
+        // 変換するバイナリファイルの指定がある場合
+        if (vm.count("convert")) {
+            convertname_ = vm["convert"].as<std::string>();
+        }
+
+        // バッチ実行の指定がある場合
+        if (vm.count("batch")) {
+            batchname_ = vm["batch"].as<std::string>();
+        }
+
+        // 同時に実行するジョブの数の指定がある場合
+        if (vm.count("jobs")) {
+            jobs_ = vm["jobs"].as<std::int32_t>();
+        }
+
+        // パラメータスキャンの指定がある場合
+        if (vm.count("sweep")) {
+            sweepname_ = vm["sweep"].as<std::string>();
+        }
+
+        // 計測結果の表示の指定がある場合
+        if (vm.count("profile")) {
+            profile_ = true;
+        }
+
+        // 計測結果をJSON形式で書き出すファイルの指定がある場合
+        if (vm.count("profile-json")) {
+            profilejsonname_ = vm["profile-json"].as<std::string>();
+        }
+
+        // 微分方程式の求解の統計の表示の指定がある場合
+        if (vm.count("stats")) {
+            stats_ = true;
+        }
+
         return 0;
     }
     
@@ -69,6 +137,46 @@ namespace schrac {
         return std::make_pair(inpname_, usetbb_);
     }
 
+    std::string const & GetComLineOption::getbatchname() const
+    {
+        return batchname_;
+    }
+
+    std::string const & GetComLineOption::getconvertname() const
+    {
+        return convertname_;
+    }
+
+    std::int32_t GetComLineOption::getjobs() const
+    {
+        return jobs_;
+    }
+
+    WaveFunctionSave::Output_type GetComLineOption::getoutputtype() const
+    {
+        return outputtype_;
+    }
+
+    bool GetComLineOption::getprofile() const
+    {
+        return profile_;
+    }
+
+    std::string const & GetComLineOption::getprofilejsonname() const
+    {
+        return profilejsonname_;
+    }
+
+    bool GetComLineOption::getstats() const
+    {
+        return stats_;
+    }
+
+    std::string const & GetComLineOption::getsweepname() const
+    {
+        return sweepname_;
+    }
+
     // #endregion publicメンバ関数
 }
 
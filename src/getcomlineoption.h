@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "wavefunctionsave.h"
 #include <cstdint>  // for std::int32_t
 #include <string>   // for std::string
 #include <utility>  // for std::pair
@@ -55,6 +56,62 @@ namespace schrac {
         */
         std::pair<std::string, bool> getpairdata() const;
 
+        //! A public member function (constant).
+        /*!
+            バッチ実行するインプットファイルの一覧のファイル名（またはディレクトリ名）を返す
+            \return バッチ実行の一覧のファイル名（指定がなければ空文字列）
+        */
+        std::string const & getbatchname() const;
+
+        //! A public member function (constant).
+        /*!
+            CSV形式に変換するバイナリファイル名を返す
+            \return 変換するバイナリファイル名（指定がなければ空文字列）
+        */
+        std::string const & getconvertname() const;
+
+        //! A public member function (constant).
+        /*!
+            バッチ実行で同時に実行するジョブの数を返す
+            \return 同時に実行するジョブの数（0なら自動）
+        */
+        std::int32_t getjobs() const;
+
+        //! A public member function (constant).
+        /*!
+            終了時に関数ごとの計測結果を表示するかどうかを返す
+            \return 計測結果を表示するかどうか
+        */
+        bool getprofile() const;
+
+        //! A public member function (constant).
+        /*!
+            関数ごとの計測結果をJSON形式で書き出すファイル名を返す
+            \return JSON形式で書き出すファイル名（指定がなければ空文字列）
+        */
+        std::string const & getprofilejsonname() const;
+
+        //! A public member function (constant).
+        /*!
+            微分方程式の求解の統計を表示するかどうかを返す
+            \return 統計を表示するかどうか
+        */
+        bool getstats() const;
+
+        //! A public member function (constant).
+        /*!
+            パラメータスキャンを行うインプットファイル名を返す
+            \return パラメータスキャンのインプットファイル名（指定がなければ空文字列）
+        */
+        std::string const & getsweepname() const;
+
+        //! A public member function (constant).
+        /*!
+            波動関数を書き出すファイルの形式を返す
+            \return 波動関数を書き出すファイルの形式
+        */
+        WaveFunctionSave::Output_type getoutputtype() const;
+
         // #endregion メンバ関数
 
     private:
@@ -65,6 +122,18 @@ namespace schrac {
             デフォルトのインプットファイル名
         */
         static std::string const DEFINPNAME;
+
+        //!  A private member variable.
+        /*!
+            バッチ実行するインプットファイルの一覧のファイル名（またはディレクトリ名）
+        */
+        std::string batchname_;
+
+        //!  A private member variable.
+        /*!
+            CSV形式に変換するバイナリファイル名
+        */
+        std::string convertname_;
         
         //!  A private member variable.
         /*!
@@ -72,6 +141,42 @@ namespace schrac {
         */
         std::string inpname_;
 
+        //!  A private member variable.
+        /*!
+            バッチ実行で同時に実行するジョブの数
+        */
+        std::int32_t jobs_ = 0;
+
+        //!  A private member variable.
+        /*!
+            波動関数を書き出すファイルの形式
+        */
+        WaveFunctionSave::Output_type outputtype_ = WaveFunctionSave::Output_type::CSV;
+
+        //!  A private member variable.
+        /*!
+            終了時に関数ごとの計測結果を表示するかどうか
+        */
+        bool profile_ = false;
+
+        //!  A private member variable.
+        /*!
+            関数ごとの計測結果をJSON形式で書き出すファイル名
+        */
+        std::string profilejsonname_;
+
+        //!  A private member variable.
+        /*!
+            微分方程式の求解の統計を表示するかどうか
+        */
+        bool stats_ = false;
+
+        //!  A private member variable.
+        /*!
+            パラメータスキャンを行うインプットファイル名
+        */
+        std::string sweepname_;
+
         //!  A private member variable.
         /*!
             TBBを使用するかどうか    
@@ -0,0 +1,55 @@
+﻿/*! \file gslerrorhandleroff.cpp
+    \brief GSLのエラーハンドラを一時的に無効にするクラスの実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "gslerrorhandleroff.h"
+#include <cstdint>          // for std::int32_t
+#include <mutex>            // for std::lock_guard, std::mutex
+#include <gsl/gsl_errno.h>  // for gsl_set_error_handler, gsl_set_error_handler_off
+
+namespace schrac {
+    namespace {
+        //! A global variable.
+        /*!
+            エラーハンドラの差し替えと復元、及び下の二つの変数を排他制御するミューテックス
+        */
+        std::mutex handler_mutex;
+
+        //! A global variable.
+        /*!
+            現在生きているGslErrorHandlerOffオブジェクトの数
+        */
+        std::int32_t handler_count = 0;
+
+        //! A global variable.
+        /*!
+            最初のオブジェクトが無効にする前のエラーハンドラ
+        */
+        gsl_error_handler_t * old_handler = nullptr;
+    }
+
+    // #region コンストラクタ・デストラクタ
+
+    GslErrorHandlerOff::GslErrorHandlerOff()
+    {
+        std::lock_guard<std::mutex> lock(handler_mutex);
+
+        if (handler_count++ == 0) {
+            old_handler = gsl_set_error_handler_off();
+        }
+    }
+
+    GslErrorHandlerOff::~GslErrorHandlerOff()
+    {
+        std::lock_guard<std::mutex> lock(handler_mutex);
+
+        if (--handler_count == 0) {
+            gsl_set_error_handler(old_handler);
+        }
+    }
+
+    // #endregion コンストラクタ・デストラクタ
+}
@@ -0,0 +1,60 @@
+﻿/*! \file gslerrorhandleroff.h
+    \brief GSLのエラーハンドラを一時的に無効にするクラスの宣言
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _GSLERRORHANDLEROFF_H_
+#define _GSLERRORHANDLEROFF_H_
+
+#pragma once
+
+namespace schrac {
+    //! A class.
+    /*!
+        オブジェクトが生きている間だけGSLのエラーハンドラを無効にし、破棄するときに元のハンドラに戻すクラス
+        GSLの関数はエラーのときにハンドラを呼ばずに戻り値で知らせるので、呼び出し側で戻り値を調べること
+        エラーハンドラはプロセス全体で共有されるので、複数のスレッドで同時に生きているオブジェクトの数を数え、
+        最初のオブジェクトが無効にして、最後のオブジェクトが元に戻す
+    */
+    class GslErrorHandlerOff final {
+        // #region コンストラクタ・デストラクタ
+
+    public:
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+        */
+        GslErrorHandlerOff();
+
+        //! A destructor.
+        /*!
+            デストラクタ
+        */
+        ~GslErrorHandlerOff();
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+    private:
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        GslErrorHandlerOff(GslErrorHandlerOff const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        GslErrorHandlerOff & operator=(GslErrorHandlerOff const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _GSLERRORHANDLEROFF_H_
@@ -0,0 +1,68 @@
+﻿/*! \file indexedspline.cpp
+    \brief メッシュの区間の添字を指定して評価する3次スプライン補間クラスの実装
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "indexedspline.h"
+#include <cmath>                // for std::log
+#include <boost/assert.hpp>     // for BOOST_ASSERT
+
+namespace schrac {
+    // #region コンストラクタ
+
+    IndexedSpline::IndexedSpline(std::vector<double> const & r_mesh) :
+        a_(r_mesh.size() - 1),
+        b_(r_mesh.size() - 1),
+        c_(r_mesh.size()),
+        d_(r_mesh.size() - 1),
+        r_(r_mesh),
+        rdx_(static_cast<double>(r_mesh.size() - 1) / std::log(r_mesh.back() / r_mesh.front())),
+        xmin_(std::log(r_mesh.front()))
+    {
+        BOOST_ASSERT(r_mesh.size() >= 3);
+    }
+
+    // #endregion コンストラクタ
+
+    // #region publicメンバ関数
+
+    void IndexedSpline::init(std::vector<double> const & y, checkpoint::Arena & arena)
+    {
+        BOOST_ASSERT(y.size() == r_.size());
+
+        auto const n = r_.size();
+
+        // 両端で2階微分が0の条件で、c_i（2階微分の1 / 2）についての三重対角の連立方程式を
+        // Thomas法で解く（右辺はc_に入れておき、後退代入でその場で解に置き換える）
+        std::vector<double, checkpoint::ArenaAllocator<double>> diag(n - 1, checkpoint::ArenaAllocator<double>(arena));
+        c_[0] = 0.0;
+        diag[0] = 1.0;
+        for (auto i = 1U; i < n - 1; i++) {
+            auto const hm = r_[i] - r_[i - 1];
+            auto const hp = r_[i + 1] - r_[i];
+            auto const g = 3.0 * ((y[i + 1] - y[i]) / hp - (y[i] - y[i - 1]) / hm);
+
+            auto const w = i > 1 ? hm / diag[i - 1] : 0.0;
+            diag[i] = 2.0 * (hm + hp) - w * hm;
+            c_[i] = g - w * c_[i - 1];
+        }
+
+        c_[n - 1] = 0.0;
+        for (auto i = n - 2; i > 0; i--) {
+            auto const hp = r_[i + 1] - r_[i];
+            c_[i] = (c_[i] - hp * c_[i + 1]) / diag[i];
+        }
+
+        for (auto i = 0U; i < n - 1; i++) {
+            auto const h = r_[i + 1] - r_[i];
+
+            a_[i] = y[i];
+            b_[i] = (y[i + 1] - y[i]) / h - h * (2.0 * c_[i] + c_[i + 1]) / 3.0;
+            d_[i] = (c_[i + 1] - c_[i]) / (3.0 * h);
+        }
+    }
+
+    // #endregion publicメンバ関数
+}
@@ -0,0 +1,155 @@
+﻿/*! \file indexedspline.h
+    \brief メッシュの区間の添字を指定して評価する3次スプライン補間クラスの宣言
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _INDEXEDSPLINE_H_
+#define _INDEXEDSPLINE_H_
+
+#pragma once
+
+#include "checkpoint/arena.h"
+#include <algorithm>    // for std::max, std::min
+#include <cstddef>      // for std::size_t
+#include <vector>       // for std::vector
+
+namespace schrac {
+    //! A class.
+    /*!
+        rのメッシュ上の自然3次スプライン補間（gsl_interp_csplineと同じもの）を、
+        区間ごとの係数を事前計算して保持するクラス
+        係数は構造体の配列ではなく配列の構造体（a_, b_, c_, d_）で保持する
+        呼び出し側が区間の添字を知っていれば、二分探索もgsl_interp_accelも使わずに評価でき、
+        評価は読み出しだけなので複数のスレッドから同時に呼び出してよい
+    */
+    class IndexedSpline final {
+        // #region コンストラクタ・デストラクタ
+
+    public:
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param r_mesh rのメッシュ（x = log(r)について等間隔であること）
+        */
+        explicit IndexedSpline(std::vector<double> const & r_mesh);
+
+        //! A destructor.
+        /*!
+            デフォルトデストラクタ
+        */
+        ~IndexedSpline() = default;
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ関数
+
+        //! A public member function (const).
+        /*!
+            添字iの区間[r_i, r_(i + 1)]の3次式で、rにおける1階微分の値を返す
+            \param i 区間の添字
+            \param r rの値
+            \return 1階微分の値
+        */
+        double deriv(std::size_t i, double r) const
+        {
+            auto const h = r - r_[i];
+            return b_[i] + h * (2.0 * c_[i] + 3.0 * h * d_[i]);
+        }
+
+        //! A public member function (const).
+        /*!
+            x = log(r)を含む区間の添字を返す（メッシュの外なら端の区間の添字）
+            \param x xの値
+            \return 区間の添字
+        */
+        std::size_t index(double x) const
+        {
+            auto const t = std::max((x - xmin_) * rdx_, 0.0);
+            return std::min(static_cast<std::size_t>(t), r_.size() - 2);
+        }
+
+        //! A public member function.
+        /*!
+            メッシュ上の関数の値から、スプライン補間の係数を求める
+            \param y メッシュ上の関数の値
+            \param arena 連立方程式を解くときの作業用の配列を確保するアリーナ
+        */
+        void init(std::vector<double> const & y, checkpoint::Arena & arena);
+
+        //! A public member function (const).
+        /*!
+            添字iの区間[r_i, r_(i + 1)]の3次式で、rにおける値を返す
+            \param i 区間の添字
+            \param r rの値
+            \return 補間した値
+        */
+        double operator()(std::size_t i, double r) const
+        {
+            auto const h = r - r_[i];
+            return a_[i] + h * (b_[i] + h * (c_[i] + h * d_[i]));
+        }
+
+        // #endregion メンバ関数
+
+        // #region メンバ変数
+
+    private:
+        //! A private member variable.
+        /*!
+            各区間の0次の係数（区間の左端の値）
+        */
+        std::vector<double> a_;
+
+        //! A private member variable.
+        /*!
+            各区間の1次の係数
+        */
+        std::vector<double> b_;
+
+        //! A private member variable.
+        /*!
+            各区間の2次の係数
+        */
+        std::vector<double> c_;
+
+        //! A private member variable.
+        /*!
+            各区間の3次の係数
+        */
+        std::vector<double> d_;
+
+        //! A private member variable.
+        /*!
+            rのメッシュ
+        */
+        std::vector<double> r_;
+
+        //! A private member variable.
+        /*!
+            xのメッシュの刻みの逆数
+        */
+        double rdx_;
+
+        //! A private member variable.
+        /*!
+            xのメッシュの最小値
+        */
+        double xmin_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        IndexedSpline() = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _INDEXEDSPLINE_H_
@@ -12,6 +12,7 @@
 
 #include "eigenvaluesearch.h"
 #include "property.h"
+#include <utility>                          // for std::move
 #include <boost/container/flat_map.hpp>     // for boost::container::flat_map
 
 namespace schrac {
@@ -40,9 +41,9 @@ namespace schrac {
 
         //! A destructor.
         /*!
-            デフォルトデストラクタ
+            デストラクタ（借りた配列を作業領域に返却する）
         */
-        virtual ~Normalize() = default;
+        virtual ~Normalize();
 
         // #endregion コンストラクタ・デストラクタ
 
@@ -80,25 +81,13 @@ namespace schrac {
 
         //! A protected member variable.
         /*!
-            関数L
-        */
-        dvector L_;
-
-        //! A protected member variable.
-        /*!
-            関数M
-        */
-        dvector M_;
-        
-        //! A protected member variable.
-        /*!
-            固有関数
+            固有関数（作業領域から借りた、メッシュの点の数の大きさの配列）
         */
         dvector rf_;
 
         //! A private member variable.
         /*!
-            4πr ** 2のかかった形の電子密度
+            4πr ** 2のかかった形の電子密度（作業領域から借りた、メッシュの点の数の大きさの配列）
         */
         dvector rho_;
 
@@ -130,19 +119,27 @@ namespace schrac {
         // #endregion 禁止されたコンストラクタ・メンバ関数
     };
 
-    // #region コンストラクタの実装
+    // #region コンストラクタ・デストラクタの実装
 
     template <typename Derived>
     Normalize<Derived>::Normalize(std::shared_ptr<DiffSolver> const & pdiffsolver) :
         pdata_(pdiffsolver->PDiffData()->pdata_),
         pdiffdata_(pdiffsolver->PDiffData),
-        pdiffsolver_(pdiffsolver)
+        pdiffsolver_(pdiffsolver),
+        rf_(pdiffdata_->pworkspace_->acquire()),
+        rho_(pdiffdata_->pworkspace_->acquire())
+    {
+    }
+
+    template <typename Derived>
+    Normalize<Derived>::~Normalize()
     {
-        L_.reserve(pdata_->grid_num_);
-        M_.reserve(pdata_->grid_num_);
+        // getresult()で結果としてムーブしたものは、返却しても捨てられる
+        pdiffdata_->pworkspace_->release(std::move(rf_));
+        pdiffdata_->pworkspace_->release(std::move(rho_));
     }
 
-    // #endregion コンストラクタの実装
+    // #endregion コンストラクタ・デストラクタの実装
 }
 
 #endif // _NORMALIZE_H_
@@ -0,0 +1,39 @@
+﻿/*! \file potentialtable.cpp
+    \brief xのメッシュ上で事前計算したポテンシャルの数表クラスの実装
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "potentialtable.h"
+#include <boost/cast.hpp>   // for boost::numeric_cast
+
+namespace schrac {
+    // #region コンストラクタ
+
+    PotentialTable::PotentialTable(std::shared_ptr<DiffData> const & pdiffdata, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr) :
+        kmax_(static_cast<double>(2 * pdiffdata->pdata_->grid_num_ + 1)),
+        rdh_(2.0 / pdiffdata->dx_),
+        xmin_(pdiffdata->pdata_->xmin_)
+    {
+        auto const size = boost::numeric_cast<dvector::size_type>(2 * pdiffdata->pdata_->grid_num_ + 1);
+        auto const dh = 0.5 * pdiffdata->dx_;
+
+        // メモリ確保
+        r_.resize(size);
+        r2_.resize(size);
+        v_.resize(size);
+        dv_dr_.resize(size);
+
+        for (auto k = 0U; k < size; k++) {
+            auto const r = std::exp(xmin_ + static_cast<double>(k) * dh);
+
+            r_[k] = r;
+            r2_[k] = r * r;
+            v_[k] = V(r);
+            dv_dr_[k] = dV_dr(r);
+        }
+    }
+
+    // #endregion コンストラクタ
+}
@@ -0,0 +1,191 @@
+﻿/*! \file potentialtable.h
+    \brief xのメッシュ上で事前計算したポテンシャルの数表クラスの宣言
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _POTENTIALTABLE_H_
+#define _POTENTIALTABLE_H_
+
+#pragma once
+
+#include "diffdata.h"
+#include <cmath>        // for std::fabs, std::nearbyint
+#include <cstddef>      // for std::size_t
+#include <functional>   // for std::function
+#include <optional>     // for std::optional
+
+namespace schrac {
+    //! A class.
+    /*!
+        xのメッシュ点とその中点（刻みdx / 2）上で、r、r ** 2、V(r)及びdV / drを
+        事前計算して保持するクラス
+    */
+    class PotentialTable final {
+        // #region コンストラクタ・デストラクタ
+
+    public:
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param pdiffdata 微分方程式のデータオブジェクト
+            \param V ポテンシャルの関数オブジェクト
+            \param dV_dr ポテンシャルの微分の関数オブジェクト
+        */
+        PotentialTable(std::shared_ptr<DiffData> const & pdiffdata, std::function<double(double)> const & V, std::function<double(double)> const & dV_dr);
+
+        //! A destructor.
+        /*!
+            デフォルトデストラクタ
+        */
+        ~PotentialTable() = default;
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ関数
+
+        //! A public member function (const).
+        /*!
+            xに対応する数表の添字を返す
+            \param x xの値
+            \return 数表の添字（xが数表の点に一致しなければstd::nullopt）
+        */
+        std::optional<std::size_t> index(double x) const
+        {
+            auto const t = (x - xmin_) * rdh_;
+            auto const k = std::nearbyint(t);
+
+            if (std::fabs(t - k) > PotentialTable::TOLERANCE || k < 0.0 || k >= kmax_) {
+                return std::nullopt;
+            }
+
+            return std::make_optional(static_cast<std::size_t>(k));
+        }
+
+        //! A public member function (const).
+        /*!
+            添字kの点におけるdV / drの値を返す
+            \param k 数表の添字
+            \return dV / drの値
+        */
+        double dV_dr(std::size_t k) const
+        {
+            return dv_dr_[k];
+        }
+
+        //! A public member function (const).
+        /*!
+            添字kの点におけるrの値を返す
+            \param k 数表の添字
+            \return rの値
+        */
+        double r(std::size_t k) const
+        {
+            return r_[k];
+        }
+
+        //! A public member function (const).
+        /*!
+            添字kの点におけるr ** 2の値を返す
+            \param k 数表の添字
+            \return r ** 2の値
+        */
+        double r2(std::size_t k) const
+        {
+            return r2_[k];
+        }
+
+        //! A public member function (const).
+        /*!
+            添字kの点におけるV(r)の値を返す
+            \param k 数表の添字
+            \return V(r)の値
+        */
+        double V(std::size_t k) const
+        {
+            return v_[k];
+        }
+
+        // #endregion メンバ関数
+
+        // #region メンバ変数
+
+    private:
+        //!  A private static member variable (constant expression).
+        /*!
+            xが数表の点に一致しているとみなす許容誤差（数表の刻みに対する比）
+        */
+        static auto constexpr TOLERANCE = 1.0E-8;
+
+        //! A private member variable.
+        /*!
+            dV / drの数表
+        */
+        dvector dv_dr_;
+
+        //! A private member variable (constant).
+        /*!
+            数表の点の数
+        */
+        double const kmax_;
+
+        //! A private member variable.
+        /*!
+            rの数表
+        */
+        dvector r_;
+
+        //! A private member variable.
+        /*!
+            r ** 2の数表
+        */
+        dvector r2_;
+
+        //! A private member variable (constant).
+        /*!
+            数表の刻みの逆数
+        */
+        double const rdh_;
+
+        //! A private member variable.
+        /*!
+            V(r)の数表
+        */
+        dvector v_;
+
+        //! A private member variable (constant).
+        /*!
+            xのメッシュの最小値
+        */
+        double const xmin_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        PotentialTable() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        PotentialTable(PotentialTable const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        PotentialTable & operator=(PotentialTable const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _POTENTIALTABLE_H_
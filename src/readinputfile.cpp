@@ -6,11 +6,18 @@
 */
 
 #include "readinputfile.h"
+#include "diffdata.h"
+#include <algorithm>                    // for std::any_of, std::find_if, std::max, std::min, std::min_element, std::none_of, std::remove, std::sort
+#include <cctype>                       // for std::isdigit, std::tolower
+#include <cmath>                        // for std::ceil, std::floor, std::log, std::pow, std::sqrt
 #include <iostream>                     // for std::cerr
+#include <sstream>                      // for std::ostringstream
 #include <stdexcept>                    // for std::runtime_error
+#include <tuple>                        // for std::tie, std::tuple
 #include <boost/algorithm/string.hpp>   // for boost::algorithm
 #include <boost/assert.hpp>             // for BPOOST_ASSERT
 #include <boost/cast.hpp>               // for boost::numeric_cast
+#include <boost/format.hpp>             // for boost::format
 #include <boost/range/algorithm.hpp>    // for boost::find
 
 namespace schrac {
@@ -25,16 +32,47 @@ namespace schrac {
         ci_string("sdirac"),
         ci_string("dirac")
     };
+    ci_string const ReadInputFile::OCCUPATION = "occupation";
     ci_string const ReadInputFile::ORBITAL = "orbital";
+    std::string const ReadInputFile::ORBITAL_SYMBOL = "spdfg";
+    std::array<ci_string, 2> const ReadInputFile::POISSON_TYPE_ARRAY =
+    {
+        ci_string("ode"),
+        ci_string("direct")
+    };
+    ci_string const ReadInputFile::POISSON_TYPE_DEFAULT = "ode";
+    std::array<ci_string, 3> const ReadInputFile::SCF_MIXING_TYPE_ARRAY =
+    {
+        ci_string("simple"),
+        ci_string("anderson"),
+        ci_string("pulay")
+    };
+    ci_string const ReadInputFile::SCF_MIXING_TYPE_DEFAULT = "simple";
     const std::array<ci_string, 4> ReadInputFile::SOLVER_TYPE_ARRAY =
     {
         ci_string("adams_bashforth_moulton"),
         ci_string("bulirsch_stoer"),
-        ci_string("controlled_runge_kutta")
+        ci_string("controlled_runge_kutta"),
+        ci_string("numerov")
     };
     ci_string const ReadInputFile::SOLVER_TYPE_DEFAULT = "controlled_runge_kutta";
 	ci_string const ReadInputFile::SPIN_ORBITAL = "spin.orbital";
 	ci_string const ReadInputFile::SPIN_ORBITAL_DEFAULT = "alpha";
+    std::array<ci_string, 6> const ReadInputFile::SWEEP_ARTICLE_ARRAY =
+    {
+        ci_string("grid.xmin"),
+        ci_string("grid.xmax"),
+        ci_string("grid.num"),
+        ci_string("eps"),
+        ci_string("matching.point.ratio"),
+        ci_string("solver.type")
+    };
+    std::array<ci_string, 2> const ReadInputFile::XC_TYPE_ARRAY =
+    {
+        ci_string("none"),
+        ci_string("lda")
+    };
+    ci_string const ReadInputFile::XC_TYPE_DEFAULT = "none";
 
     // #endregion staticメンバ変数
 
@@ -66,18 +104,52 @@ namespace schrac {
             errorendfunc();
         }
 
+        if (!readOccupation()) {
+            errorendfunc();
+        }
+
         if (!readEq()) {
             errorendfunc();
         }
 
+        // 複数の殻を解く場合は、Dirac方程式には対応しない
+        if (!pdata_->shells_.empty() && pdata_->eq_type_ == Data::Eq_type::DIRAC) {
+            std::cerr << "複数の殻を解く場合は、Dirac方程式は使えません。\n";
+            errorendfunc();
+        }
+
+        // 交換相関ポテンシャルの種類を読み込む
+        if (!readXcType()) {
+            errorendfunc();
+        }
+
         // グリッドの最小値を読み込む
-        readValue("grid.xmin", XMIN_DEFAULT, pdata_->xmin_);
+        std::optional<double> xmin;
+        if (!readValueOrAuto("grid.xmin", XMIN_DEFAULT, xmin)) {
+            errorendfunc();
+        }
 
         // グリッドの最大値を読み込む
-        readValue("grid.xmax", XMAX_DEFAULT, pdata_->xmax_);
+        std::optional<double> xmax;
+        if (!readValueOrAuto("grid.xmax", XMAX_DEFAULT, xmax)) {
+            errorendfunc();
+        }
 
         // グリッドのサイズを読み込む
-        readValue("grid.num", GRID_NUM_DEFAULT, pdata_->grid_num_);
+        std::optional<std::int32_t> gridnum;
+        if (!readValueOrAuto("grid.num", GRID_NUM_DEFAULT, gridnum)) {
+            errorendfunc();
+        }
+
+        // グリッドを自動で決めるときの、固有値の許容誤差を読み込む
+        readValueOptional("grid.tolerance", GRID_TOLERANCE_DEFAULT, pdata_->grid_tolerance_);
+        if (pdata_->grid_tolerance_ <= 0.0) {
+            errorMessage(lineindex_ - 1, "grid.tolerance", (boost::format("%g") % pdata_->grid_tolerance_).str().c_str());
+            errorendfunc();
+        }
+
+        // AUTOが指定された値を決める
+        setGrid(xmin, xmax, gridnum);
 
         // 許容誤差を読み込む
         readValue("eps", EPS_DEFAULT, pdata_->eps_);
@@ -87,16 +159,43 @@ namespace schrac {
             errorendfunc();
         }
 
+        // ポテンシャルの数表を使うかどうかを読み込む
+        if (!readYesNo("potential.table", POTENTIAL_TABLE_DEFAULT, pdata_->potential_table_)) {
+            errorendfunc();
+        }
+
+        // Poisson方程式の解法を読み込む
+        if (!readPoissonType()) {
+            errorendfunc();
+        }
+
         // 固有値探索をはじめる値を読み込む
         if (!readValueAuto("search.LowerE", pdata_->search_lowerE_)) {
             errorendfunc();
         }
 
+        // 固有値をNewton法で精密化するかどうかを読み込む
+        if (!readYesNo("search.Newton", SEARCH_NEWTON_DEFAULT, pdata_->search_newton_)) {
+            errorendfunc();
+        }
+
         // 固有値検索の間隔を読み込む
         readValue("num.of.partition", NUM_OF_PARTITION_DEFAULT, pdata_->num_of_partition_);
 
         // マッチングポイントを読み込む
-        readValue("matching.point.ratio", MAT_PO_RATIO_DEFAULT, pdata_->mat_po_ratio_);
+        std::optional<double> matpo;
+        if (!readValueOrAuto("matching.point.ratio", MAT_PO_RATIO_DEFAULT, matpo)) {
+            errorendfunc();
+        }
+
+        pdata_->mat_po_auto_ = !matpo;
+        if (matpo) {
+            pdata_->mat_po_ratio_ = *matpo;
+        }
+        else if (pdata_->shells_.empty()) {
+            // 一つの軌道だけを解く場合は、裸の原子核の古典的転回点に置く（複数の殻を解く場合は、殻ごとに決める）
+            pdata_->mat_po_ratio_ = DiffData::turning_point_ratio(*pdata_, pdata_->Z_);
+        }
 
         // 密度の初期値ρ0(r)のための係数cを読み込む
         if (!readValueAuto("rho0.c", pdata_->rho0_c_)) {
@@ -108,6 +207,11 @@ namespace schrac {
             errorendfunc();
         }
 
+        // 密度の初期値ρ0(r)を読み込むファイル名を読み込む
+        ci_string rho0file;
+        readValueOptional<ci_string>("rho0.file", "", rho0file);
+        pdata_->rho0_file_ = rho0file.c_str();
+
         // SCFの最大ループ回数を読み込む
         readValue("scf.maxIter", SCF_MAXITER_DEFAULT, pdata_->scf_maxiter_);
 
@@ -115,11 +219,160 @@ namespace schrac {
         if (!readScfMixingWeight()) {
             errorendfunc();
         }
+
+        // SCFの電子密度の混合方法を読み込む
+        if (!readScfMixingType()) {
+            errorendfunc();
+        }
         
         // SCFの収束判定条件の値を読み込む
         readValue("scf.criterion", SCF_CRITERION_DEFAULT, pdata_->scf_criterion_);
+
+        // SCFのチェックポイントと再開の設定を読み込む
+        if (!readScfCheckpoint()) {
+            errorendfunc();
+        }
+
+        // 密度のファイルとチェックポイントは一つの軌道の密度しか持たないので、複数の殻を解く場合は使えない
+        if (!pdata_->shells_.empty() &&
+            (!pdata_->rho0_file_.empty() || !pdata_->scf_checkpoint_.empty() || !pdata_->scf_restart_.empty())) {
+            std::cerr << "複数の殻を解く場合は、rho0.file、scf.checkpoint、scf.restartは使えません。\n";
+            errorendfunc();
+        }
     }
     
+    ReadInputFile::SweepSet ReadInputFile::expandSweep(std::string const & filename)
+    {
+        using namespace boost::algorithm;
+
+        std::ifstream ifs(filename);
+        if (!ifs.is_open()) {
+            throw std::runtime_error("インプットファイルが開けませんでした");
+        }
+
+        SweepSet sweepset;
+
+        // 展開する行の位置と、その行の文字列と値の候補
+        std::vector<std::string> lines;
+        std::vector<std::tuple<std::size_t, std::string, std::vector<std::string>>> sweeps;
+
+        auto const errorendfunc = [](std::size_t lineindex, std::string const & line) {
+            throw std::runtime_error((boost::format("インプットファイル%d行目の、[%s]の行が正しくありません") % lineindex % line).str());
+        };
+
+        std::string line;
+        while (std::getline(ifs, line)) {
+            std::vector<std::string> tokens;
+            split(tokens, line, is_any_of(" \t"), token_compress_on);
+
+            // 空行とコメント行はそのまま残す
+            if (line.empty() || line[0] == '#' || tokens.size() < 2) {
+                lines.push_back(line);
+                continue;
+            }
+
+            ci_string const article(tokens[0].c_str());
+            auto const & value = tokens[1];
+
+            // sweep.referenceとsweep.targetは、展開したインプットファイルには含めない
+            if (article == "sweep.reference" || article == "sweep.target") {
+                try {
+                    (article == "sweep.reference" ? sweepset.reference : sweepset.target) = boost::lexical_cast<double>(value);
+                }
+                catch (boost::bad_lexical_cast const &) {
+                    errorendfunc(lines.size() + 1, tokens[0]);
+                }
+
+                lines.push_back(std::string());
+                continue;
+            }
+
+            if (boost::find(ReadInputFile::SWEEP_ARTICLE_ARRAY, article) == ReadInputFile::SWEEP_ARTICLE_ARRAY.end()) {
+                lines.push_back(line);
+                continue;
+            }
+
+            std::vector<std::string> values;
+            if (value.find(',') != std::string::npos) {
+                // リストの場合
+                split(values, value, is_any_of(","), token_compress_on);
+                values.erase(std::remove(values.begin(), values.end(), std::string()), values.end());
+            }
+            else if (value.find(':') != std::string::npos && article != "solver.type") {
+                // 範囲（開始:終了:刻み）の場合
+                std::vector<std::string> range;
+                split(range, value, is_any_of(":"));
+                if (range.size() != 3) {
+                    errorendfunc(lines.size() + 1, tokens[0]);
+                }
+
+                try {
+                    auto const start = boost::lexical_cast<double>(range[0]);
+                    auto const stop = boost::lexical_cast<double>(range[1]);
+                    auto const step = boost::lexical_cast<double>(range[2]);
+                    if (step == 0.0 || (stop - start) / step < 0.0) {
+                        errorendfunc(lines.size() + 1, tokens[0]);
+                    }
+
+                    // 刻みの丸め誤差で終了の値を落とさないようにする
+                    auto const num = static_cast<std::int32_t>(std::floor((stop - start) / step + 1.0E-9)) + 1;
+                    for (auto i = 0; i < num; i++) {
+                        auto const x = start + static_cast<double>(i) * step;
+                        values.push_back(article == "grid.num" ?
+                            std::to_string(static_cast<std::int32_t>(std::floor(x + 0.5))) :
+                            (boost::format("%.10g") % x).str());
+                    }
+                }
+                catch (boost::bad_lexical_cast const &) {
+                    errorendfunc(lines.size() + 1, tokens[0]);
+                }
+            }
+
+            if (values.empty()) {
+                lines.push_back(line);
+                continue;
+            }
+
+            sweeps.emplace_back(lines.size(), tokens[0], std::move(values));
+            lines.push_back(line);
+        }
+
+        // すべての組み合わせを作る（後に書かれた行ほど速く変わる）
+        std::vector<std::size_t> index(sweeps.size(), 0);
+        while (true) {
+            auto joblines(lines);
+            std::string label;
+            for (auto i = 0U; i < sweeps.size(); i++) {
+                auto const & [pos, article, values] = sweeps[i];
+                joblines[pos] = article + ' ' + values[index[i]];
+
+                label += (label.empty() ? "" : "_") + article + '=' + values[index[i]];
+            }
+
+            std::ostringstream text;
+            for (auto const & l : joblines) {
+                text << l << '\n';
+            }
+
+            sweepset.jobs.emplace_back(label.empty() ? "base" : label, text.str());
+
+            // 次の組み合わせへ進める
+            auto i = static_cast<std::int32_t>(sweeps.size()) - 1;
+            for (; i >= 0; i--) {
+                if (++index[i] < std::get<2>(sweeps[i]).size()) {
+                    break;
+                }
+                index[i] = 0;
+            }
+
+            if (i < 0) {
+                break;
+            }
+        }
+
+        return sweepset;
+    }
+
     // #endregion publicメンバ関数
 
     // #region privateメンバ関数
@@ -169,6 +422,59 @@ namespace schrac {
         }
     }
 
+    std::vector<Data::Shell> ReadInputFile::groundStateShells(std::int32_t Z)
+    {
+        // Madelungの規則で電子を詰める殻の順番（Krまで）
+        static std::array<std::pair<std::uint8_t, std::uint8_t>, 8> const order = {{
+            { 1, 0 }, { 2, 0 }, { 2, 1 }, { 3, 0 }, { 3, 1 }, { 4, 0 }, { 3, 2 }, { 4, 1 }
+        }};
+
+        std::vector<Data::Shell> shells;
+        auto rest = Z;
+        for (auto itr(order.begin()); rest > 0 && itr != order.end(); ++itr) {
+            auto const [n, l] = *itr;
+            auto const occupation = std::min(rest, 2 * (2 * l + 1));
+            shells.push_back({ n, l, std::to_string(n) + ReadInputFile::ORBITAL_SYMBOL[l], occupation });
+            rest -= occupation;
+        }
+
+        // CrとCuは、4s殻の電子が一つ3d殻に移った方が安定になる
+        if (Z == 24 || Z == 29) {
+            shells[5].occupation--;
+            shells[6].occupation++;
+        }
+
+        return shells;
+    }
+
+    bool ReadInputFile::isNextArticle(ci_string const & article)
+    {
+        using namespace boost::algorithm;
+
+        auto const pos = ifs_.tellg();
+        auto isnext = false;
+
+        std::array<char, BUFSIZE> buf;
+        while (ifs_.getline(buf.data(), BUFSIZE)) {
+            ci_string const line(buf.data());
+
+            // 空行とコメント行は読み飛ばす
+            if (!line.empty() && (line[0] != '#')) {
+                strvec tokens;
+                split(tokens, line, is_any_of(" \t"), token_compress_on);
+
+                isnext = (tokens.front() == article);
+                break;
+            }
+        }
+
+        // 読み込み位置を元に戻す
+        ifs_.clear();
+        ifs_.seekg(pos);
+
+        return isnext;
+    }
+
     bool ReadInputFile::readAtom()
     {
         // 原子の種類を読み込む
@@ -457,6 +763,107 @@ namespace schrac {
         return true;
     }
 
+    bool ReadInputFile::readOccupation()
+    {
+        auto const Z = static_cast<std::int32_t>(pdata_->Z_);
+
+        if (!isNextArticle(ReadInputFile::OCCUPATION)) {
+            // 行がなければ、3電子以上の原子は基底状態の電子配置とする（H原子とHe原子は一つの軌道だけを解く）
+            if (Z >= 3) {
+                pdata_->shells_ = ReadInputFile::groundStateShells(Z);
+            }
+
+            return true;
+        }
+
+        std::optional<strvec> ptokens;
+        while (!ptokens) {
+            auto ret(getToken(ReadInputFile::OCCUPATION));
+
+            switch (std::get<0>(ret))
+            {
+            case -1:
+                return false;
+                break;
+
+            case 0:
+                ptokens = std::move(std::get<1>(ret));
+                break;
+
+            case 1:
+                break;
+
+            default:
+                BOOST_ASSERT(!"何かがおかしい!");
+                break;
+            }
+
+            lineindex_++;
+        }
+
+        if (Z == 1) {
+            std::cerr << "H原子では、インプットファイルの[occupation]の行は指定できません。\n";
+            return false;
+        }
+
+        // 「#」以降はコメントとする
+        auto const last = std::find_if(ptokens->begin() + 1, ptokens->end(), [](ci_string const & token) { return token[0] == '#'; });
+        strvec const tokens(ptokens->begin() + 1, last);
+
+        if (tokens.empty() || (tokens.size() == 1 && (tokens.front() == "AUTO" || tokens.front() == "DEFAULT"))) {
+            pdata_->shells_ = ReadInputFile::groundStateShells(Z);
+        }
+        else {
+            for (auto const & token : tokens) {
+                // 「2p6」のように、主量子数、軌道の記号、電子の数の順に書く
+                auto const l = token.length() >= 3 && std::isdigit(static_cast<unsigned char>(token[0])) ?
+                    ReadInputFile::ORBITAL_SYMBOL.find(static_cast<char>(std::tolower(static_cast<unsigned char>(token[1])))) :
+                    std::string::npos;
+
+                auto occupation = 0;
+                if (l != std::string::npos) {
+                    try {
+                        occupation = boost::lexical_cast<std::int32_t>(token.substr(2).c_str());
+                    }
+                    catch (boost::bad_lexical_cast const &) {
+                    }
+                }
+
+                auto const n = token[0] - '0';
+                auto const duplicate = std::any_of(pdata_->shells_.begin(), pdata_->shells_.end(), [n, l](Data::Shell const & shell) {
+                    return shell.n == n && shell.l == l;
+                });
+
+                if (l == std::string::npos || n - static_cast<std::int32_t>(l) < 1 ||
+                    occupation <= 0 || occupation > 2 * (2 * static_cast<std::int32_t>(l) + 1) || duplicate) {
+                    errorMessage(lineindex_ - 1, ReadInputFile::OCCUPATION, token);
+                    return false;
+                }
+
+                pdata_->shells_.push_back({
+                    boost::numeric_cast<std::uint8_t>(n),
+                    boost::numeric_cast<std::uint8_t>(l),
+                    std::to_string(n) + ReadInputFile::ORBITAL_SYMBOL[l],
+                    occupation });
+            }
+        }
+
+        // 内側の殻から順に並べる
+        std::sort(pdata_->shells_.begin(), pdata_->shells_.end(), [](Data::Shell const & a, Data::Shell const & b) {
+            return std::tie(a.n, a.l) < std::tie(b.n, b.l);
+        });
+
+        // 固有値を表示する軌道は、占有されている殻のどれかでなければならない
+        if (std::none_of(pdata_->shells_.begin(), pdata_->shells_.end(), [this](Data::Shell const & shell) {
+            return shell.n == pdata_->n_ && shell.l == pdata_->l_;
+        })) {
+            std::cerr << "インプットファイルの[orbital]の軌道が、[occupation]の殻に含まれていません。\n";
+            return false;
+        }
+
+        return true;
+    }
+
     bool ReadInputFile::readScfMixingWeight()
     {
         readValue("scf.Mixing.Weight", SCF_MIXING_WEIGHT_DEFAULT, pdata_->scf_mixing_weight_);
@@ -467,6 +874,83 @@ namespace schrac {
         return true;
     }
 
+    bool ReadInputFile::readPoissonType()
+    {
+        ci_string poissontype;
+        readValueOptional("poisson.type", ReadInputFile::POISSON_TYPE_DEFAULT, poissontype);
+
+        auto const itr(boost::find(ReadInputFile::POISSON_TYPE_ARRAY, poissontype));
+        if (itr == ReadInputFile::POISSON_TYPE_ARRAY.end()) {
+            errorMessage(lineindex_ - 1, "poisson.type", poissontype);
+            return false;
+        }
+
+        pdata_->poisson_type_ = boost::numeric_cast<Data::Poisson_type>(
+            std::distance(ReadInputFile::POISSON_TYPE_ARRAY.begin(), itr));
+
+        return true;
+    }
+
+    bool ReadInputFile::readScfCheckpoint()
+    {
+        ci_string filename;
+        readValueOptional<ci_string>("scf.checkpoint", "", filename);
+        pdata_->scf_checkpoint_ = filename.c_str();
+
+        readValueOptional("scf.checkpoint.interval", SCF_CHECKPOINT_INTERVAL_DEFAULT, pdata_->scf_checkpoint_interval_);
+        if (pdata_->scf_checkpoint_interval_ < 1) {
+            std::cerr << "インプットファイルの[scf.checkpoint.interval]の行が正しくありません。\n";
+            return false;
+        }
+
+        readValueOptional<ci_string>("scf.restart", "", filename);
+        pdata_->scf_restart_ = filename.c_str();
+
+        return true;
+    }
+
+    bool ReadInputFile::readScfMixingType()
+    {
+        ci_string mixingtype;
+        readValueOptional("scf.Mixing.Type", ReadInputFile::SCF_MIXING_TYPE_DEFAULT, mixingtype);
+
+        auto const itr(boost::find(ReadInputFile::SCF_MIXING_TYPE_ARRAY, mixingtype));
+        if (itr == ReadInputFile::SCF_MIXING_TYPE_ARRAY.end()) {
+            errorMessage(lineindex_ - 1, "scf.Mixing.Type", mixingtype);
+            return false;
+        }
+
+        pdata_->scf_mixing_type_ = boost::numeric_cast<Data::Mixing_type>(
+            std::distance(ReadInputFile::SCF_MIXING_TYPE_ARRAY.begin(), itr));
+
+        readValueOptional("scf.Mixing.History", SCF_MIXING_HISTORY_DEFAULT, pdata_->scf_mixing_history_);
+        if (pdata_->scf_mixing_history_ < 1) {
+            std::cerr << "インプットファイルの[scf.Mixing.History]の行が正しくありません。\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool ReadInputFile::readYesNo(ci_string const & article, bool default_value, bool & value)
+    {
+        ci_string str;
+        readValueOptional<ci_string>(article, default_value ? "yes" : "no", str);
+
+        if (str == "yes") {
+            value = true;
+        }
+        else if (str == "no") {
+            value = false;
+        }
+        else {
+            errorMessage(lineindex_ - 1, article, str);
+            return false;
+        }
+
+        return true;
+    }
+
     bool ReadInputFile::readSolverType()
     {
         auto const psolvetype(readData("solver.type", ReadInputFile::SOLVER_TYPE_DEFAULT));
@@ -487,5 +971,105 @@ namespace schrac {
         return true;
     }
 
+    bool ReadInputFile::readXcType()
+    {
+        ci_string xctype;
+        readValueOptional("xc.type", ReadInputFile::XC_TYPE_DEFAULT, xctype);
+
+        auto const itr(boost::find(ReadInputFile::XC_TYPE_ARRAY, xctype));
+        if (itr == ReadInputFile::XC_TYPE_ARRAY.end()) {
+            errorMessage(lineindex_ - 1, "xc.type", xctype);
+            return false;
+        }
+
+        pdata_->xc_type_ = boost::numeric_cast<Data::Xc_type>(
+            std::distance(ReadInputFile::XC_TYPE_ARRAY.begin(), itr));
+
+        // 一つの軌道だけを解く場合は、もう一つの電子のHartreeポテンシャルだけを使うので、交換相関ポテンシャルは加えない
+        if (pdata_->xc_type_ != Data::Xc_type::NONE && pdata_->shells_.empty()) {
+            std::cerr << "交換相関ポテンシャルは、複数の殻を解く場合（occupationの行を指定するか、Li原子以降の場合）にしか使えません。\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    void ReadInputFile::setGrid(std::optional<double> const & xmin, std::optional<double> const & xmax, std::optional<std::int32_t> const & gridnum)
+    {
+        pdata_->grid_auto_ = !xmin || !xmax || !gridnum;
+        if (!pdata_->grid_auto_) {
+            pdata_->xmin_ = *xmin;
+            pdata_->xmax_ = *xmax;
+            pdata_->grid_num_ = *gridnum;
+            return;
+        }
+
+        // 一つの軌道だけを解く場合は、その軌道を一つの殻とみなす
+        auto const shells(pdata_->shells_.empty() ?
+            std::vector<Data::Shell>{ { pdata_->n_, pdata_->l_, pdata_->orbital_, static_cast<std::int32_t>(pdata_->Z_ + 0.5) } } :
+            pdata_->shells_);
+
+        auto nelec = 0;
+        for (auto const & shell : shells) {
+            nelec += shell.occupation;
+        }
+
+        // 最も内側の殻（主量子数が最小）と、最も外側の殻（主量子数が最大で、その中で方位量子数が最小）
+        auto const inner = *std::min_element(shells.begin(), shells.end(), [](auto const & a, auto const & b) {
+            return a.n < b.n;
+        });
+        auto const outer = *std::min_element(shells.begin(), shells.end(), [](auto const & a, auto const & b) {
+            return a.n != b.n ? a.n > b.n : a.l < b.l;
+        });
+
+        auto const tolerance = pdata_->grid_tolerance_;
+        auto const Z = pdata_->Z_;
+
+        // 最も内側の殻は裸の原子核の水素様原子、最も外側の殻は他の電子で遮蔽された原子核の水素様原子とみなす
+        auto const nin = static_cast<double>(inner.n);
+        auto const nout = static_cast<double>(outer.n);
+        auto const Ein = Z * Z / (2.0 * nin * nin);
+        auto const zeta = std::max(1.0, Z - static_cast<double>(nelec - 1));
+        auto const Eout = zeta * zeta / (2.0 * nout * nout);
+
+        // 原点付近の初期値による固有値の誤差 GRID_ORIGIN_COEFF * (Z * rmin)^2 * Ein が許容誤差になるようにする
+        pdata_->xmin_ = xmin ?
+            *xmin :
+            std::log(std::sqrt(tolerance / (ReadInputFile::GRID_ORIGIN_COEFF * Ein)) / Z);
+
+        if (xmax) {
+            pdata_->xmax_ = *xmax;
+        }
+        else {
+            // 波動関数の2乗の裾(2κr)^(2n) * exp(-2κr)が、許容誤差 / Eoutまで減衰する距離をrmaxとする
+            // （2κr = ln(Eout / tolerance) + 2n * ln(2κr)を、古典的転回点から始めて反復で解く）
+            auto const kappa = zeta / nout;
+            auto rmax = 2.0 * nout * nout / zeta;
+            for (auto i = 0; i < ReadInputFile::GRID_RMAX_ITERATION; i++) {
+                rmax = (std::log(Eout / tolerance) + 2.0 * nout * std::log(2.0 * kappa * rmax)) / (2.0 * kappa);
+            }
+
+            pdata_->xmax_ = std::log(std::min(rmax, ReadInputFile::GRID_OVERFLOW_EXPONENT * nin / Z));
+        }
+
+        if (gridnum) {
+            pdata_->grid_num_ = *gridnum;
+        }
+        else {
+            // 刻みdxによる固有値の誤差 GRID_DX_COEFF * (dx^2 * (n^2 + (l + 1/2)^2))^2 * E が許容誤差になるようにする
+            auto const dxfunc = [tolerance](Data::Shell const & shell, double E) {
+                auto const n = static_cast<double>(shell.n);
+                auto const l = static_cast<double>(shell.l);
+                return std::pow(tolerance / (ReadInputFile::GRID_DX_COEFF * E), 0.25) /
+                       std::sqrt(n * n + (l + 0.5) * (l + 0.5));
+            };
+            auto const dx = std::min({ dxfunc(inner, Ein), dxfunc(outer, Eout), ReadInputFile::GRID_DX_MAX });
+
+            // Simpsonの公式を使うので、メッシュの数は偶数にする
+            auto const num = static_cast<std::int32_t>(std::ceil((pdata_->xmax_ - pdata_->xmin_) / dx)) + 1;
+            pdata_->grid_num_ = num + num % 2;
+        }
+    }
+
     // #endregion privateメンバ関数
 }
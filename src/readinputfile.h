@@ -16,6 +16,8 @@
 #include <fstream>                  // for std::ifstream
 #include <memory>                   // for std::shared_ptr
 #include <optional>					// for std::optional
+#include <string>                   // for std::string
+#include <utility>                  // for std::pair
 #include <vector>                   // for std::vector
 #include <boost/lexical_cast.hpp>   // for boost::lexical_cast
 
@@ -31,9 +33,37 @@ namespace schrac {
 
         // #endregion 型エイリアス
 
-        // #region コンストラクタ・デストラクタ
+        // #region 構造体
 
     public:
+        //! A struct.
+        /*!
+            パラメータスキャンのインプットファイルを展開したジョブの集合
+        */
+        struct SweepSet final {
+            //! A public member variable.
+            /*!
+                ジョブの名前（"grid.num=20000_eps=1e-10"など）と、展開したインプットファイルの内容のstd::pairの可変長配列
+            */
+            std::vector<std::pair<std::string, std::string>> jobs;
+
+            //! A public member variable.
+            /*!
+                精度の基準にする全エネルギー（sweep.reference）
+            */
+            std::optional<double> reference;
+
+            //! A public member variable.
+            /*!
+                目標とする全エネルギーの精度（sweep.target）
+            */
+            std::optional<double> target;
+        };
+
+        // #endregion 構造体
+
+        // #region コンストラクタ・デストラクタ
+
         //! A constructor.
         /*!
             唯一のコンストラクタ
@@ -58,6 +88,18 @@ namespace schrac {
         */
         void readFile();
 
+        //! A public static member function.
+        /*!
+            パラメータスキャンのインプットファイルを、ジョブの集合に展開する
+            grid.xmin、grid.xmax、grid.num、eps、matching.point.ratioには、値の代わりに
+            「20000,50000,100000」のようなリストか「-9.0:-7.0:0.5」のような範囲（開始:終了:刻み）を、
+            solver.typeにはリストを書くことができ、それらのすべての組み合わせのジョブを作る
+            また、「sweep.reference」と「sweep.target」の行で、精度の基準の全エネルギーと目標精度を指定できる
+            \param filename インプットファイル名
+            \return 展開したジョブの集合
+        */
+        static SweepSet expandSweep(std::string const & filename);
+
     private:
         //! A private member function (const).
         /*!
@@ -84,6 +126,22 @@ namespace schrac {
         */
         std::pair<std::int32_t, std::optional<ReadInputFile::strvec>> getToken(ci_string const & article);
 
+        //! A private static member function.
+        /*!
+            基底状態の電子配置を、Madelungの規則（CrとCuは例外）で求める
+            \param Z 原子核の電荷（Krまで）
+            \return 電子が占有している殻の配列
+        */
+        static std::vector<Data::Shell> groundStateShells(std::int32_t Z);
+
+        //! A private member function.
+        /*!
+            次に読み込む行の要素名が、指定された要素名かどうかを調べる（ファイルの読み込み位置は変えない）
+            \param article 要素名
+            \return 次に読み込む行の要素名が指定された要素名かどうか
+        */
+        bool isNextArticle(ci_string const & article);
+
         //! A private member function.
         /*!
             原子に関するデータを読み込む
@@ -133,6 +191,22 @@ namespace schrac {
         */
         bool readEq();
 
+        //! A private member function.
+        /*!
+            電子が占有している殻を読み込む
+            「occupation 1s2 2s2 2p6」のように殻と電子の数を並べるか、AUTOで基底状態の電子配置とし、
+            行がなければ、3電子以上の原子は基底状態の電子配置とする
+            \return 読み込みが成功したかどうか
+        */
+        bool readOccupation();
+
+        //! A private member function.
+        /*!
+            Poisson方程式の解法を読み込む
+            \return 読み込みが成功したかどうか
+        */
+        bool readPoissonType();
+
         //! A private member function.
         /*!
             SCFの一次混合の重みを読み込む
@@ -140,6 +214,30 @@ namespace schrac {
         */
         bool readScfMixingWeight();
 
+        //! A private member function.
+        /*!
+            SCFのチェックポイントのファイル名と書き出す間隔、及び再開するチェックポイントのファイル名を読み込む
+            \return 読み込みが成功したかどうか
+        */
+        bool readScfCheckpoint();
+
+        //! A private member function.
+        /*!
+            SCFの電子密度の混合方法と、Pulay混合の履歴の数を読み込む
+            \return 読み込みが成功したかどうか
+        */
+        bool readScfMixingType();
+
+        //! A private member function.
+        /*!
+            Yes|Noの値を、省略可能な要素として読み込む
+            \param article 要素名
+            \param default_value デフォルトの値
+            \param value 読み込んだ値
+            \return 読み込みが成功したかどうか
+        */
+        bool readYesNo(ci_string const & article, bool default_value, bool & value);
+
         //! A private member function.
         /*!
             微分方程式の解法を読み込む
@@ -147,6 +245,33 @@ namespace schrac {
         */
         bool readSolverType();
 
+        //! A private member function.
+        /*!
+            交換相関ポテンシャルの種類を読み込む
+            \return 読み込みが成功したかどうか
+        */
+        bool readXcType();
+
+        template <typename T>
+        //! A private member function.
+        /*!
+            対象の要素の値をその行から読み込む（AUTOならstd::nulloptとする）
+            \param article 要素名
+            \param default_value デフォルトの値
+            \param value 読み込んだ値
+            \return 読み込みが成功したかどうか
+        */
+        bool readValueOrAuto(ci_string const & article, T const & default_value, std::optional<T> & value);
+
+        //! A private member function.
+        /*!
+            AUTOが指定されたメッシュの最小値、最大値及び数を、原子番号、殻の量子数及び固有値の許容誤差から決める
+            \param xmin メッシュの最小値（std::nulloptなら自動で決める）
+            \param xmax メッシュの最大値（std::nulloptなら自動で決める）
+            \param gridnum メッシュの数（std::nulloptなら自動で決める）
+        */
+        void setGrid(std::optional<double> const & xmin, std::optional<double> const & xmax, std::optional<std::int32_t> const & gridnum);
+
         template <typename T>
         //! A private member function.
         /*!
@@ -167,6 +292,16 @@ namespace schrac {
         */
         bool readValueAuto(ci_string const & article, std::optional<T> & value);
 
+        template <typename T>
+        //! A private member function.
+        /*!
+            省略可能な要素の値をその行から読み込む（要素の行がなければデフォルト値とする）
+            \param article 要素名
+            \param default_value デフォルトの値
+            \param value 読み込んだ値
+        */
+        void readValueOptional(ci_string const & article, T const & default_value, T & value);
+
         // #endregion メンバ関数
 
         // #region プロパティ
@@ -189,6 +324,36 @@ namespace schrac {
         */
         static std::streamsize constexpr BUFSIZE = 1024;
 
+        //! A private member variable (constant expression).
+        /*!
+            メッシュを自動で決めるときの刻みdxの最大値（これより粗いと固有値の検索が不安定になる）
+        */
+        static double constexpr GRID_DX_MAX = 0.008;
+
+        //! A private member variable (constant expression).
+        /*!
+            メッシュの刻みdxによる固有値の相対誤差C * (dx^2 * g)^2の係数C（gは動径方程式のy'' = g * yの係数の目安）
+        */
+        static double constexpr GRID_DX_COEFF = 1.0E-2;
+
+        //! A private member variable (constant expression).
+        /*!
+            原点付近の初期値による固有値の相対誤差C * (Z * rmin)^2の係数C
+        */
+        static double constexpr GRID_ORIGIN_COEFF = 20.0;
+
+        //! A private member variable (constant expression).
+        /*!
+            メッシュの最大値を決める方程式を解くときの反復回数
+        */
+        static std::int32_t constexpr GRID_RMAX_ITERATION = 10;
+
+        //! A private member variable (constant expression).
+        /*!
+            最も内側の殻を内向きに積分したときに、解がオーバーフローしないためのκ * rmaxの上限
+        */
+        static double constexpr GRID_OVERFLOW_EXPONENT = 500.0;
+
         //! A private member variable (constant).
         /*!
             「chemical.symbol」の文字列
@@ -207,6 +372,12 @@ namespace schrac {
         */
         static const ci_string EQ_TYPE;
 
+        //! A private member variable (constant).
+        /*!
+            「occupation」の文字列
+        */
+        static const ci_string OCCUPATION;
+
         //! A private member variable (constant).
         /*!
             方程式の種類の文字列の配列
@@ -219,6 +390,36 @@ namespace schrac {
         */
         static const ci_string ORBITAL;
 
+        //! A private member variable (constant).
+        /*!
+            方位量子数l = 0, 1, 2, ...の軌道の記号
+        */
+        static const std::string ORBITAL_SYMBOL;
+
+        //! A private member variable (constant).
+        /*!
+            Poisson方程式の解法の文字列の配列
+        */
+        static const std::array<ci_string, 2> POISSON_TYPE_ARRAY;
+
+        //! A private member variable (constant).
+        /*!
+            デフォルトのPoisson方程式の解法
+        */
+        static const ci_string POISSON_TYPE_DEFAULT;
+
+        //! A private member variable (constant).
+        /*!
+            電子密度の混合方法の文字列の配列
+        */
+        static const std::array<ci_string, 3> SCF_MIXING_TYPE_ARRAY;
+
+        //! A private member variable (constant).
+        /*!
+            デフォルトの電子密度の混合方法
+        */
+        static const ci_string SCF_MIXING_TYPE_DEFAULT;
+
         //! A private member variable (constant).
         /*!
             微分方程式の数値解法の文字列の配列
@@ -243,6 +444,24 @@ namespace schrac {
         */
         static const ci_string SPIN_ORBITAL_DEFAULT;
 
+        //! A private member variable (constant).
+        /*!
+            パラメータスキャンで値を変えることができる行の文字列の配列
+        */
+        static const std::array<ci_string, 6> SWEEP_ARTICLE_ARRAY;
+
+        //! A private member variable (constant).
+        /*!
+            交換相関ポテンシャルの種類の文字列の配列
+        */
+        static const std::array<ci_string, 2> XC_TYPE_ARRAY;
+
+        //! A private member variable (constant).
+        /*!
+            デフォルトの交換相関ポテンシャルの種類
+        */
+        static const ci_string XC_TYPE_DEFAULT;
+
         //! A private member variable.
         /*!
             ファイル読み込み用のストリーム
@@ -375,6 +594,33 @@ namespace schrac {
         }
     }
 
+    template <typename T>
+    bool ReadInputFile::readValueOrAuto(ci_string const & article, T const & default_value, std::optional<T> & value)
+    {
+        auto const val(readData(article, ci_string("DEFAULT")));
+        if (!val) {
+            return false;
+        }
+
+        if (*val == "DEFAULT") {
+            value = std::make_optional<T>(default_value);
+        }
+        else if (*val == "AUTO") {
+            value = std::nullopt;
+        }
+        else {
+            try {
+                value = std::make_optional<T>(boost::lexical_cast<T>(val->c_str()));
+            }
+            catch (boost::bad_lexical_cast const &) {
+                errorMessage(lineindex_ - 1, article, *val);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     template <typename T>
     bool ReadInputFile::readValueAuto(ci_string const & article, std::optional<T> & value)
     {
@@ -403,6 +649,17 @@ namespace schrac {
 
         return true;
     }
+
+    template <typename T>
+    void ReadInputFile::readValueOptional(ci_string const & article, T const & default_value, T & value)
+    {
+        if (isNextArticle(article)) {
+            readValue(article, default_value, value);
+        }
+        else {
+            value = default_value;
+        }
+    }
 }
 
 #endif  // _READINPUTFILE_H_
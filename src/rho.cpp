@@ -7,16 +7,35 @@
 
 #include "diffdata.h"
 #include "rho.h"
-#include <cmath>    // for std::pow
+#include "solvelinearequ.h"
+#include "solvestats.h"
+#include <algorithm>            // for std::fill
+#include <cmath>                // for std::exp, std::log, std::pow
+#include <cstdlib>              // for std::strtod
+#include <fstream>              // for std::ifstream
+#include <memory>               // for std::unique_ptr
+#include <stdexcept>            // for std::runtime_error
+#include <utility>              // for std::move
+#include <boost/assert.hpp>     // for BOOST_ASSERT
+#include <gsl/gsl_spline.h>     // for gsl_interp_accel, gsl_interp_accel_free, gsl_spline, gsl_spline_free
 
 namespace schrac {
     // #region コンストラクタ
 
     Rho::Rho(std::shared_ptr<DiffData> const & pdiffdata) :
         PRho([this] { return std::cref(rho_); }, nullptr),
-        acc_(gsl_interp_accel_alloc(), gsl_interp_accel_free),
-        pdiffdata_(pdiffdata),
-        spline_(gsl_spline_alloc(gsl_interp_cspline, pdiffdata->r_mesh_.size()), gsl_spline_free)
+        PMixingState(
+            [this] { return MixingState{ rho_, rhohist_, reshist_, resdot_ }; },
+            [this](MixingState const & state) {
+                BOOST_ASSERT(state.rho.size() == rho_.size());
+                rho_ = state.rho;
+                rhohist_ = state.rhohist;
+                reshist_ = state.reshist;
+                resdot_ = state.resdot;
+                return state;
+            }),
+        ispline_(pdiffdata->r_mesh_),
+        pdiffdata_(pdiffdata)
     {
         auto const & pdata = pdiffdata_->pdata_;
         if (pdata->chemical_symbol_ == Data::Chemical_Symbol[0]) {
@@ -24,6 +43,11 @@ namespace schrac {
 
             return;
         }
+        else if (!pdata->rho0_file_.empty()) {
+            read_rho0_file(pdata->rho0_file_);
+
+            return;
+        }
         else if (pdata->rho0_c_ == std::nullopt || pdata->rho0_alpha_ == std::nullopt) {
             // デフォルト値を代入
             auto const w = 2.0;
@@ -44,22 +68,240 @@ namespace schrac {
 
     void Rho::init()
     {
-        gsl_spline_init(spline_.get(), pdiffdata_->r_mesh_.data(), rho_.data(), pdiffdata_->r_mesh_.size());
+        ispline_.init(rho_, *pdiffdata_->parena_);
+    }
+
+    dvector Rho::interpolate(dvector const & r, dvector const & f, dvector const & r_mesh)
+    {
+        BOOST_ASSERT(r.size() == f.size());
+
+        dvector x;
+        x.reserve(r.size());
+        for (auto const rr : r) {
+            x.push_back(std::log(rr));
+        }
+
+        std::unique_ptr<gsl_interp_accel, decltype(&gsl_interp_accel_free)> const acc(gsl_interp_accel_alloc(), gsl_interp_accel_free);
+        std::unique_ptr<gsl_spline, decltype(&gsl_spline_free)> const spline(gsl_spline_alloc(gsl_interp_cspline, x.size()), gsl_spline_free);
+        gsl_spline_init(spline.get(), x.data(), f.data(), x.size());
+
+        dvector newf;
+        newf.reserve(r_mesh.size());
+        for (auto const rr : r_mesh) {
+            auto const xr = std::log(rr);
+            if (xr <= x.front()) {
+                newf.push_back(f.front());
+            }
+            else if (xr >= x.back()) {
+                newf.push_back(0.0);
+            }
+            else {
+                newf.push_back(gsl_spline_eval(spline.get(), xr, acc.get()));
+            }
+        }
+
+        return newf;
     }
 
     double Rho::operator()(double r) const
     {
-        return gsl_spline_eval(spline_.get(), r, acc_.get());
+        return (*this)(ispline_.index(std::log(r)), r);
+    }
+
+    double Rho::operator()(std::size_t i, double r) const
+    {
+        if (auto const pstats = SolveStats::current()) {
+            pstats->rho++;
+        }
+
+        return ispline_(i, r);
     }
 
-    void Rho::rhomix(dvector const & newrho)
+    void Rho::rhomix(dvector const & newrho, innerproduct const & dot)
     {
         auto const & pdata = pdiffdata_->pdata_;
+
+        auto res = pdiffdata_->pworkspace_->acquire();
         for (auto i = 0; i <= pdata->grid_num_; i++) {
-            rho_[i] = (1.0 - pdata->scf_mixing_weight_) * rho_[i] +
-                pdata->scf_mixing_weight_ * newrho[i];
+            res[i] = newrho[i] - rho_[i];
         }
+
+        switch (pdata->scf_mixing_type_) {
+        case Data::Mixing_type::SIMPLE:
+            rhomix_simple(res);
+            break;
+
+        case Data::Mixing_type::ANDERSON:
+            rhomix_anderson(res, dot);
+            break;
+
+        case Data::Mixing_type::PULAY:
+            rhomix_pulay(res, dot);
+            break;
+
+        default:
+            BOOST_ASSERT(!"何かがおかしい!");
+            break;
+        }
+
+        pdiffdata_->pworkspace_->release(std::move(res));
     }
 
     // #endregion publicメンバ関数
+
+    // #region privateメンバ関数
+
+    void Rho::read_rho0_file(std::string const & filename)
+    {
+        std::ifstream ifs(filename);
+        if (!ifs.is_open()) {
+            throw std::runtime_error(filename + " が開けませんでした。");
+        }
+
+        // rho_*.csvの各行は「r,r^2ρ(r)」の形式
+        dvector r, rho;
+        std::string line;
+        while (std::getline(ifs, line)) {
+            char * end;
+            auto const rr = std::strtod(line.c_str(), &end);
+
+            // 数値で始まらない行（見出しや空行）は読み飛ばす
+            if (end == line.c_str() || *end != ',') {
+                continue;
+            }
+
+            auto const * const p = end + 1;
+            auto const v = std::strtod(p, &end);
+            if (end == p) {
+                continue;
+            }
+
+            if (rr <= 0.0 || (!r.empty() && rr <= r.back())) {
+                throw std::runtime_error(filename + " のメッシュが正しくありません。");
+            }
+
+            r.push_back(rr);
+            rho.push_back(v / (rr * rr));
+        }
+
+        if (r.size() < 3) {
+            throw std::runtime_error(filename + " は電子密度のファイルではありません。");
+        }
+
+        rho_ = interpolate(r, rho, pdiffdata_->r_mesh_);
+
+        // 補間と書き出したときの桁落ちで全電荷がずれるので、1になるように規格化し直す
+        dvector const one(rho_.size(), 1.0);
+        auto const q = (*pdiffdata_->psimpson_)(rho_, one, 3);
+        for (auto && v : rho_) {
+            v /= q;
+        }
+    }
+
+    void Rho::rhomix_anderson(dvector const & res, innerproduct const & dot)
+    {
+        if (rhohist_.empty()) {
+            rhohist_.push_back(rho_);
+            reshist_.push_back(res);
+            rhomix_simple(res);
+
+            return;
+        }
+
+        auto & rhoold = rhohist_.front();
+        auto & resold = reshist_.front();
+
+        dvector dres;
+        dres.reserve(res.size());
+        for (auto i = 0U; i < res.size(); i++) {
+            dres.push_back(res[i] - resold[i]);
+        }
+
+        // θ = <F, F - Fold> / <F - Fold, F - Fold>
+        auto const dd = dot(dres, dres);
+        auto const theta = dd > 0.0 ? dot(res, dres) / dd : 0.0;
+
+        auto const w = pdiffdata_->pdata_->scf_mixing_weight_;
+        for (auto i = 0U; i < res.size(); i++) {
+            auto const rho = rho_[i];
+            rho_[i] = rho - theta * (rho - rhoold[i]) + w * (res[i] - theta * dres[i]);
+            rhoold[i] = rho;
+        }
+
+        resold = res;
+    }
+
+    void Rho::rhomix_pulay(dvector const & res, innerproduct const & dot)
+    {
+        // 履歴に追加し、残差同士の内積の行列を更新する
+        rhohist_.push_back(rho_);
+        reshist_.push_back(res);
+
+        resdot_.emplace_back();
+        for (auto i = 0U; i < reshist_.size(); i++) {
+            auto const d = dot(reshist_[i], res);
+            resdot_[i].push_back(d);
+            if (i != reshist_.size() - 1) {
+                resdot_.back().push_back(d);
+            }
+        }
+
+        if (reshist_.size() > static_cast<std::size_t>(pdiffdata_->pdata_->scf_mixing_history_)) {
+            rhohist_.pop_front();
+            reshist_.pop_front();
+            resdot_.pop_front();
+            for (auto & row : resdot_) {
+                row.pop_front();
+            }
+        }
+
+        auto const n = reshist_.size();
+        if (n == 1) {
+            rhomix_simple(res);
+
+            return;
+        }
+
+        // Σc_i = 1の条件の下で|Σc_i * F_i|を最小にするc_iを、Lagrangeの未定乗数法で求める
+        // （条件数を小さくするため、最新の残差の内積で割っておく）
+        auto const scale = 1.0 / resdot_.back().back();
+        checkpoint::ArenaAllocator<double> const alloc(*pdiffdata_->parena_);
+        arenavector a((n + 1) * (n + 1), 1.0, alloc), b(n + 1, 0.0, alloc);
+        for (auto i = 0U; i < n; i++) {
+            for (auto j = 0U; j < n; j++) {
+                a[i * (n + 1) + j] = resdot_[i][j] * scale;
+            }
+        }
+        a[n * (n + 1) + n] = 0.0;
+        b[n] = 1.0;
+
+        auto const c = solve_linear_equ(a, b);
+        if (!c) {
+            // 残差が一次従属になったので、履歴を捨てて一次混合する
+            rhohist_.clear();
+            reshist_.clear();
+            resdot_.clear();
+            rhomix_simple(res);
+
+            return;
+        }
+
+        auto const w = pdiffdata_->pdata_->scf_mixing_weight_;
+        std::fill(rho_.begin(), rho_.end(), 0.0);
+        for (auto k = 0U; k < n; k++) {
+            for (auto i = 0U; i < rho_.size(); i++) {
+                rho_[i] += (*c)[k] * (rhohist_[k][i] + w * reshist_[k][i]);
+            }
+        }
+    }
+
+    void Rho::rhomix_simple(dvector const & res)
+    {
+        auto const w = pdiffdata_->pdata_->scf_mixing_weight_;
+        for (auto i = 0U; i < rho_.size(); i++) {
+            rho_[i] += w * res[i];
+        }
+    }
+
+    // #endregion privateメンバ関数
 }
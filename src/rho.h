@@ -5,18 +5,68 @@
     This software is released under the BSD 2-Clause License.
 */
 
-#include "data.h"
+#ifndef _RHO_H_
+#define _RHO_H_
+
+#pragma once
+
+#include "diffdata.h"
+#include "indexedspline.h"
 #include "property.h"
-#include <memory>           // for std::unique_ptr 
+#include <deque>            // for std::deque
+#include <functional>       // for std::function
+#include <memory>           // for std::shared_ptr
+#include <string>           // for std::string
 #include <vector>           // for std::vector
-#include <gsl/gsl_spline.h> // for gsl_interp_accel, gsl_interp_accel_free, gsl_spline, gsl_spline_free
 
 namespace schrac {
     //! A class.
     /*!
         電子密度ρ(r)を求めるクラス
+        ρ(r)の評価はconstで内部の状態を書き換えないので、複数のスレッドから同時に呼び出してよい
     */
     class Rho final {
+        // #region 型エイリアス
+
+    public:
+        using innerproduct = std::function<double(std::vector<double> const &, std::vector<double> const &)>;
+
+        // #endregion 型エイリアス
+
+        // #region 構造体
+
+        //! A struct.
+        /*!
+            電子密度ρ(r)と、混合に使う履歴をまとめた構造体
+        */
+        struct MixingState final {
+            //! A public member variable.
+            /*!
+                密度ρ(r)
+            */
+            std::vector<double> rho;
+
+            //! A public member variable.
+            /*!
+                過去の密度ρ(r)の履歴
+            */
+            std::deque<std::vector<double>> rhohist;
+
+            //! A public member variable.
+            /*!
+                過去の残差ρnew(r) - ρ(r)の履歴
+            */
+            std::deque<std::vector<double>> reshist;
+
+            //! A public member variable.
+            /*!
+                過去の残差同士の内積の行列
+            */
+            std::deque<std::deque<double>> resdot;
+        };
+
+        // #endregion 構造体
+
         // #region コンストラクタ・デストラクタ
 
     public:
@@ -51,10 +101,64 @@ namespace schrac {
 
         //!  A public member function (const).
         /*!
-            新しい電子密度ρnew(r)と、電子密度ρ(r)を一次混合する
+            rを含む区間の添字を指定して、電子密度ρ(r)を返す（区間を探さない）
+            \param i rを含むメッシュの区間[r_i, r_(i + 1)]の添字
+            \param r rの値
+            \return ρ(r)の値
+        */
+        double operator()(std::size_t i, double r) const;
+
+        //!  A public static member function.
+        /*!
+            メッシュ上の関数f(r)を、別のメッシュ上に3次スプライン補間する
+            対数メッシュで細かく分けられた原点付近を正しく扱うため、log(r)について補間する
+            元のメッシュより内側では最も内側の値、外側では0とする
+            \param r 元のメッシュ（単調増加）
+            \param f 元のメッシュ上の関数
+            \param r_mesh 補間先のメッシュ
+            \return 補間先のメッシュ上の関数
+        */
+        static dvector interpolate(dvector const & r, dvector const & f, dvector const & r_mesh);
+
+        //!  A public member function.
+        /*!
+            新しい電子密度ρnew(r)と、電子密度ρ(r)を、scf.Mixing.Typeの方法で混合する
             \param rhonew 新しい電子密度ρnew(r)
+            \param dot 残差ρnew(r) - ρ(r)の内積を求める関数オブジェクト
+        */
+        void rhomix(dvector const & rhonew, innerproduct const & dot);
+
+    private:
+        //!  A private member function.
+        /*!
+            rho0.fileで指定された電子密度のファイル（rho_*.csv）を読み込み、今のメッシュに補間して初期値とする
+            全電荷が1になるように規格化し直す
+            \param filename 電子密度のファイル名
+        */
+        void read_rho0_file(std::string const & filename);
+
+        //!  A private member function.
+        /*!
+            Anderson混合を行う（一つ前の電子密度と残差を使う）
+            \param res 残差ρnew(r) - ρ(r)
+            \param dot 残差の内積を求める関数オブジェクト
         */
-        void rhomix(dvector const & rhonew);
+        void rhomix_anderson(dvector const & res, innerproduct const & dot);
+
+        //!  A private member function.
+        /*!
+            Pulay混合（DIIS）を行う（scf.Mixing.History個前までの電子密度と残差を使う）
+            \param res 残差ρnew(r) - ρ(r)
+            \param dot 残差の内積を求める関数オブジェクト
+        */
+        void rhomix_pulay(dvector const & res, innerproduct const & dot);
+
+        //!  A private member function.
+        /*!
+            一次混合を行う
+            \param res 残差ρnew(r) - ρ(r)
+        */
+        void rhomix_simple(dvector const & res);
 
         // #endregion メンバ関数
 
@@ -63,20 +167,27 @@ namespace schrac {
     public:
         //! A property.
         /*!
-            電子密度が格納された可変長配列へのプロパティ
+            電子密度が格納された可変長配列へのプロパティ（コピーせずに参照を返す）
         */
-        Property< std::vector<double> > const PRho;
+        Property<std::vector<double> const &> const PRho;
+
+        //! A property.
+        /*!
+            電子密度と混合の履歴へのプロパティ（SCFの途中経過の保存と再開に使う）
+            設定した後はinit()を呼ぶ必要がある
+        */
+        Property<MixingState> PMixingState;
 
         // #endregion プロパティ
 
         // #region メンバ変数
 
     private:
-        //! A private member variable.
+        //!  A private member variable.
         /*!
-            gsl_interp_accelへのスマートポインタ
+            区間の添字を指定して評価するためのスプライン補間の係数
         */
-        std::unique_ptr<gsl_interp_accel, decltype(&gsl_interp_accel_free)> const acc_;
+        IndexedSpline ispline_;
 
         //!  A private member variable.
         /*!
@@ -86,15 +197,27 @@ namespace schrac {
 
         //!  A private member variable.
         /*!
-            密度ρ(r)
+            過去の残差ρnew(r) - ρ(r)の履歴
         */
-        std::vector<double> rho_;
+        std::deque<std::vector<double>> reshist_;
 
-        //! A private member variable.
+        //!  A private member variable.
+        /*!
+            過去の残差同士の内積の行列
+        */
+        std::deque<std::deque<double>> resdot_;
+
+        //!  A private member variable.
+        /*!
+            過去の密度ρ(r)の履歴
+        */
+        std::deque<std::vector<double>> rhohist_;
+
+        //!  A private member variable.
         /*!
-            gsl_splineへのスマートポインタ
+            密度ρ(r)
         */
-        std::unique_ptr<gsl_spline, decltype(&gsl_spline_free)> const spline_;
+        std::vector<double> rho_;
 
         // #endregion メンバ変数
 
@@ -123,3 +246,5 @@ namespace schrac {
         // #endregion 禁止されたコンストラクタ・メンバ関数
     };
 }
+
+#endif  // _RHO_H_
@@ -0,0 +1,249 @@
+﻿/*! \file scfcheckpoint.cpp
+    \brief SCFの途中経過をファイルに保存し、そこから再開するためのクラスの実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "scfcheckpoint.h"
+#include <algorithm>            // for std::copy_n, std::find
+#include <cmath>                // for std::exp, std::isnan, std::nan
+#include <cstdio>               // for std::fclose, std::fopen, std::fread, std::fwrite
+#include <cstring>              // for std::memcmp, std::strncpy
+#include <filesystem>           // for std::filesystem::file_size, std::filesystem::rename
+#include <iostream>             // for std::cerr
+#include <stdexcept>            // for std::runtime_error
+#include <system_error>         // for std::error_code
+#include <boost/cast.hpp>       // for boost::numeric_cast
+
+namespace schrac {
+    // #region 無名名前空間
+
+    namespace {
+        //! A function.
+        /*!
+            ヌル終端の固定長の文字列をstd::stringに変換する
+            \param str 固定長の文字列
+            \return 変換した文字列
+        */
+        template <std::size_t N>
+        std::string fixed_string(char const (& str)[N])
+        {
+            return std::string(str, std::find(str, str + N, '\0'));
+        }
+
+        //! A function.
+        /*!
+            保存したときのメッシュを作る
+            \param header チェックポイントのファイルのヘッダ
+            \return 保存したときのメッシュ
+        */
+        dvector make_r_mesh(ScfCheckpoint::BinaryHeader const & header)
+        {
+            auto const dx = (header.xmax - header.xmin) / static_cast<double>(header.grid_num - 1);
+
+            dvector r_mesh;
+            r_mesh.reserve(boost::numeric_cast<std::size_t>(header.grid_num) + 1);
+            for (auto i = 0; i <= header.grid_num; i++) {
+                r_mesh.push_back(std::exp(header.xmin + static_cast<double>(i) * dx));
+            }
+
+            return r_mesh;
+        }
+    }
+
+    // #endregion 無名名前空間
+
+    // #region staticメンバ変数
+
+    char const ScfCheckpoint::BINARY_MAGIC[8] = { 'S', 'C', 'H', 'R', 'A', 'C', 'C', 'P' };
+
+    static_assert(sizeof(ScfCheckpoint::BinaryHeader) == 128, "BinaryHeader must be 128 bytes");
+
+    // #endregion staticメンバ変数
+
+    // #region publicメンバ関数
+
+    ScfCheckpoint::State ScfCheckpoint::load(std::string const & filename, std::shared_ptr<DiffData> const & pdiffdata)
+    {
+        auto const & pdata = pdiffdata->pdata_;
+
+        std::unique_ptr<FILE, decltype(&fclose)> fp(
+            std::fopen(filename.c_str(), "rb"),
+            fclose);
+
+        if (!fp) {
+            throw std::runtime_error(filename + " が開けませんでした。");
+        }
+
+        BinaryHeader header;
+        if (std::fread(&header, sizeof(BinaryHeader), 1, fp.get()) != 1 ||
+            std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) ||
+            header.version != BINARY_VERSION ||
+            header.grid_num < 2) {
+            throw std::runtime_error(filename + " はSCFのチェックポイントのファイルではありません。");
+        }
+
+        if (header.endian != BINARY_ENDIAN) {
+            throw std::runtime_error(filename + " はバイトオーダーの異なる計算機で書き込まれています。");
+        }
+
+        if (fixed_string(header.chemical_symbol) != pdata->chemical_symbol_ || fixed_string(header.orbital) != pdata->orbital_) {
+            throw std::runtime_error(filename + " は" + fixed_string(header.chemical_symbol) + "原子の" + fixed_string(header.orbital) + "軌道の計算のものです。");
+        }
+
+        auto const size = boost::numeric_cast<std::size_t>(header.grid_num) + 1;
+
+        // ヘッダの数を信じて確保する前に、ファイルの大きさと合っているかを確かめる
+        // （Hartreeポテンシャルは再開後に密度から作り直すので、ファイルには含まれない）
+        std::error_code ec;
+        auto const filesize = std::filesystem::file_size(filename, ec);
+        auto const count = !ec && filesize >= sizeof(BinaryHeader) ? (filesize - sizeof(BinaryHeader)) / sizeof(double) : 0;
+        if (ec ||
+            (filesize - sizeof(BinaryHeader)) % sizeof(double) ||
+            size > count ||
+            header.histnum > (count - size) / (2 * size) ||
+            (header.dotnum != 0 && header.dotnum != header.histnum) ||
+            count != size * (1 + 2 * header.histnum) + header.dotnum * header.dotnum) {
+            throw std::runtime_error(filename + " は壊れています。");
+        }
+
+        auto const read = [&fp, &filename](std::size_t n) {
+            dvector v(n);
+            if (std::fread(v.data(), sizeof(double), n, fp.get()) != n) {
+                throw std::runtime_error(filename + " の読み込みに失敗しました。");
+            }
+
+            return v;
+        };
+
+        State state;
+        state.iteration = header.iteration;
+        state.E = header.E;
+        if (!std::isnan(header.dE)) {
+            state.dE = header.dE;
+        }
+
+        state.mixing.rho = read(size);
+
+        for (auto i = 0U; i < header.histnum; i++) {
+            state.mixing.rhohist.push_back(read(size));
+        }
+        for (auto i = 0U; i < header.histnum; i++) {
+            state.mixing.reshist.push_back(read(size));
+        }
+        for (auto i = 0U; i < header.dotnum; i++) {
+            auto const row = read(boost::numeric_cast<std::size_t>(header.dotnum));
+            state.mixing.resdot.emplace_back(row.begin(), row.end());
+        }
+
+        auto & mixing = state.mixing;
+        auto const clearhistory = [&mixing] {
+            mixing.rhohist.clear();
+            mixing.reshist.clear();
+            mixing.resdot.clear();
+        };
+
+        if (header.grid_num != pdata->grid_num_ || header.xmin != pdata->xmin_ || header.xmax != pdata->xmax_) {
+            // 残差の内積は今のメッシュでは意味がないので、履歴は捨てる
+            mixing.rho = Rho::interpolate(make_r_mesh(header), mixing.rho, pdiffdata->r_mesh_);
+            clearhistory();
+
+            *pdata->pout_ << filename << " はメッシュが異なるので、密度を補間し、混合の履歴は使いません。" << std::endl;
+        }
+        else if (header.eq_type != static_cast<std::int32_t>(pdata->eq_type_) ||
+                 header.mixing_type != static_cast<std::int32_t>(pdata->scf_mixing_type_)) {
+            clearhistory();
+
+            *pdata->pout_ << filename << " は方程式か電子密度の混合方法が異なるので、混合の履歴は使いません。" << std::endl;
+        }
+        else {
+            // Pulay混合の履歴の数が減っていれば、古いものから捨てる
+            while (mixing.rhohist.size() > static_cast<std::size_t>(pdata->scf_mixing_history_)) {
+                mixing.rhohist.pop_front();
+                mixing.reshist.pop_front();
+                if (!mixing.resdot.empty()) {
+                    mixing.resdot.pop_front();
+                    for (auto & row : mixing.resdot) {
+                        row.pop_front();
+                    }
+                }
+            }
+        }
+
+        return state;
+    }
+
+    bool ScfCheckpoint::save(std::string const & filename, std::shared_ptr<DiffData> const & pdiffdata, State const & state)
+    {
+        auto const & pdata = pdiffdata->pdata_;
+        auto const size = boost::numeric_cast<std::size_t>(pdata->grid_num_) + 1;
+
+        BOOST_ASSERT(state.mixing.rho.size() == size);
+        BOOST_ASSERT(state.mixing.rhohist.size() == state.mixing.reshist.size());
+
+        auto const tmpname = filename + ".tmp";
+        {
+            std::unique_ptr<FILE, decltype(&fclose)> fp(
+                std::fopen(tmpname.c_str(), "wb"),
+                fclose);
+
+            if (!fp) {
+                std::cerr << tmpname << " が作成できませんでした。" << std::endl;
+                return false;
+            }
+
+            BinaryHeader header = {};
+            std::copy_n(BINARY_MAGIC, sizeof(BINARY_MAGIC), header.magic);
+            header.version = BINARY_VERSION;
+            header.endian = BINARY_ENDIAN;
+            header.eq_type = static_cast<std::int32_t>(pdata->eq_type_);
+            header.grid_num = pdata->grid_num_;
+            header.iteration = state.iteration;
+            header.mixing_type = static_cast<std::int32_t>(pdata->scf_mixing_type_);
+            header.histnum = state.mixing.rhohist.size();
+            header.dotnum = state.mixing.resdot.size();
+            header.xmin = pdata->xmin_;
+            header.xmax = pdata->xmax_;
+            header.Z = pdata->Z_;
+            header.E = state.E;
+            header.dE = state.dE ? *state.dE : std::nan("");
+            std::strncpy(header.chemical_symbol, pdata->chemical_symbol_.c_str(), sizeof(header.chemical_symbol) - 1);
+            std::strncpy(header.orbital, pdata->orbital_.c_str(), sizeof(header.orbital) - 1);
+
+            auto const write = [&fp](double const * p, std::size_t n) {
+                return std::fwrite(p, sizeof(double), n, fp.get()) == n;
+            };
+
+            auto ok = std::fwrite(&header, sizeof(BinaryHeader), 1, fp.get()) == 1 &&
+                      write(state.mixing.rho.data(), size);
+
+            for (auto const & rho : state.mixing.rhohist) {
+                ok = ok && write(rho.data(), size);
+            }
+            for (auto const & res : state.mixing.reshist) {
+                ok = ok && write(res.data(), size);
+            }
+            for (auto const & row : state.mixing.resdot) {
+                dvector const v(row.begin(), row.end());
+                ok = ok && write(v.data(), v.size());
+            }
+
+            if (!ok || std::fflush(fp.get())) {
+                std::cerr << tmpname << " への書き込みに失敗しました。" << std::endl;
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmpname, filename, ec);
+        if (ec) {
+            std::cerr << filename << " が作成できませんでした。" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    // #endregion publicメンバ関数
+}
@@ -0,0 +1,248 @@
+﻿/*! \file scfcheckpoint.h
+    \brief SCFの途中経過をファイルに保存し、そこから再開するためのクラスの宣言
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _SCFCHECKPOINT_H_
+#define _SCFCHECKPOINT_H_
+
+#pragma once
+
+#include "rho.h"
+#include <cstdint>      // for std::int32_t, std::uint32_t, std::uint64_t
+#include <optional>     // for std::optional
+#include <string>       // for std::string
+#include <vector>       // for std::vector
+
+namespace schrac {
+    //! A class.
+    /*!
+        SCFの途中経過（密度、固有値、混合の履歴）をバイナリ形式の
+        ファイルに保存し、そこから再開するためのクラス
+    */
+    class ScfCheckpoint final {
+        // #region 構造体
+
+    public:
+        //! A struct.
+        /*!
+            チェックポイントのファイルの先頭に置かれるヘッダ
+            ファイルは、このヘッダ、密度ρ(r)、histnum個の密度の履歴、
+            histnum個の残差の履歴、dotnum×dotnumの残差同士の内積の行列の順に並ぶ
+            （メッシュ上の量はどれもdouble型がgrid_num + 1個連続したもの）
+            数値はすべて書き込んだ計算機のバイトオーダーで格納される（endianで判別する）
+        */
+        struct BinaryHeader final {
+            //! A public member variable.
+            /*!
+                ファイルの識別子（"SCHRACCP"）
+            */
+            char magic[8];
+
+            //! A public member variable.
+            /*!
+                ファイルのバージョン
+            */
+            std::uint32_t version;
+
+            //! A public member variable.
+            /*!
+                バイトオーダーの判別用の値（BINARY_ENDIAN）
+            */
+            std::uint32_t endian;
+
+            //! A public member variable.
+            /*!
+                解いた方程式のタイプ（Data::Eq_typeの値）
+            */
+            std::int32_t eq_type;
+
+            //! A public member variable.
+            /*!
+                メッシュの数
+            */
+            std::int32_t grid_num;
+
+            //! A public member variable.
+            /*!
+                保存したときのSCFのループ回数
+            */
+            std::int32_t iteration;
+
+            //! A public member variable.
+            /*!
+                電子密度を合成する方法（Data::Mixing_typeの値）
+            */
+            std::int32_t mixing_type;
+
+            //! A public member variable.
+            /*!
+                密度と残差の履歴の数
+            */
+            std::uint64_t histnum;
+
+            //! A public member variable.
+            /*!
+                残差同士の内積の行列の行数（Pulay混合以外は0）
+            */
+            std::uint64_t dotnum;
+
+            //! A public member variable.
+            /*!
+                メッシュの最小値
+            */
+            double xmin;
+
+            //! A public member variable.
+            /*!
+                メッシュの最大値
+            */
+            double xmax;
+
+            //! A public member variable.
+            /*!
+                原子核の電荷
+            */
+            double Z;
+
+            //! A public member variable.
+            /*!
+                保存したときの固有値
+            */
+            double E;
+
+            //! A public member variable.
+            /*!
+                一つ前のSCFのループからの固有値の変化量（なければNaN）
+            */
+            double dE;
+
+            //! A public member variable.
+            /*!
+                元素記号（ヌル終端）
+            */
+            char chemical_symbol[8];
+
+            //! A public member variable.
+            /*!
+                計算対象の軌道（ヌル終端）
+            */
+            char orbital[8];
+
+            //! A public member variable.
+            /*!
+                予約領域（0で埋める）
+            */
+            char reserved[24];
+        };
+
+        //! A struct.
+        /*!
+            保存する、あるいは読み込んだSCFの途中経過
+        */
+        struct State final {
+            //! A public member variable.
+            /*!
+                SCFのループ回数
+            */
+            std::int32_t iteration = 0;
+
+            //! A public member variable.
+            /*!
+                固有値
+            */
+            double E = 0.0;
+
+            //! A public member variable.
+            /*!
+                一つ前のSCFのループからの固有値の変化量
+            */
+            std::optional<double> dE;
+
+            //! A public member variable.
+            /*!
+                次のSCFのループで使う密度と、混合の履歴
+            */
+            Rho::MixingState mixing;
+        };
+
+        // #endregion 構造体
+
+        // #region メンバ関数
+
+        //!  A public static member function.
+        /*!
+            チェックポイントのファイルを読み込む
+            メッシュが異なる場合は、密度を今のメッシュに補間し、混合の履歴は捨てる
+            ヘッダのメッシュの数と履歴の数がファイルの大きさと合わなければ、壊れたファイルとして扱う
+            \param filename チェックポイントのファイル名
+            \param pdiffdata 微分方程式のデータオブジェクト（今のメッシュ）
+            \return 読み込んだSCFの途中経過
+        */
+        static State load(std::string const & filename, std::shared_ptr<DiffData> const & pdiffdata);
+
+        //!  A public static member function.
+        /*!
+            チェックポイントのファイルを書き出す
+            一時ファイルに書き出してから置き換えるので、途中で中断されても前のファイルは壊れない
+            \param filename チェックポイントのファイル名
+            \param pdiffdata 微分方程式のデータオブジェクト
+            \param state 保存するSCFの途中経過
+            \return 書き出しに成功したかどうか
+        */
+        static bool save(std::string const & filename, std::shared_ptr<DiffData> const & pdiffdata, State const & state);
+
+        // #endregion メンバ関数
+
+        // #region メンバ変数
+
+        //!  A public static member variable (constant expression).
+        /*!
+            バイトオーダーの判別用の値
+        */
+        static std::uint32_t constexpr BINARY_ENDIAN = 0x01020304;
+
+        //!  A public static member variable (constant expression).
+        /*!
+            チェックポイントのファイルのバージョン
+        */
+        static std::uint32_t constexpr BINARY_VERSION = 2;
+
+    private:
+        //!  A private static member variable (constant).
+        /*!
+            チェックポイントのファイルの識別子
+        */
+        static char const BINARY_MAGIC[8];
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        ScfCheckpoint() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        ScfCheckpoint(ScfCheckpoint const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        ScfCheckpoint & operator=(ScfCheckpoint const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _SCFCHECKPOINT_H_
@@ -8,26 +8,32 @@
 #include "eigenvaluesearch.h"
 #include "normalization.h"
 #include "readinputfile.h"
+#include "scfcheckpoint.h"
 #include "scfloop.h"
 #include "simpson.h"
+#include "checkpoint/profiler.h"
+#include <algorithm>                            // for std::fill
 #include <iomanip>                              // for std::setw    
-#include <iostream>                             // for std::cout
+#include <ostream>                              // for std::endl
 #include <stdexcept>                            // for std::runtime_error
 #include <boost/math/constants/constants.hpp>   // for boost::math::constants
 
 namespace schrac {
     // #region コンストラクタ
 
-    ScfLoop::ScfLoop(std::pair<std::string, bool> const & arg) :
+    ScfLoop::ScfLoop(std::pair<std::string, bool> const & arg, std::ostream & os) :
+        ScfLoop(read_input(arg, os))
+    {
+    }
+
+    ScfLoop::ScfLoop(std::shared_ptr<Data> const & pdata) :
         PData([this]{ return std::cref(pdata_); }, nullptr),
         PDiffData([this]{ return std::cref(pdiffdata_); }, nullptr),
         PEhartree([this]{ return std::cref(ehartree_); }, nullptr),
-        ehartree_(std::nullopt)
+        PIteration([this]{ return iteration_; }, nullptr),
+        ehartree_(std::nullopt),
+        pdata_(pdata)
     {
-        ReadInputFile rif(arg);         // ファイルを読み込む
-        rif.readFile();
-        pdata_ = rif.PData;
-
         initialize();
         
         if (pdata_->chemical_symbol_ == Data::Chemical_Symbol[0]) {
@@ -48,19 +54,19 @@ namespace schrac {
 
     void ScfLoop::message() const
     {
-        std::cout << pdata_->chemical_symbol_
+        *pdata_->pout_ << pdata_->chemical_symbol_
             << "原子の"
             << pdata_->orbital_
             << "軌道";
 
         if (pdata_->eq_type_ == Data::Eq_type::DIRAC && pdata_->spin_orbital_ == Data::ALPHA) {
-            std::cout << "、スピン上向き";
+            *pdata_->pout_ << "、スピン上向き";
         }
         else if (pdata_->eq_type_ == Data::Eq_type::DIRAC && pdata_->spin_orbital_ == Data::BETA) {
-            std::cout << "、スピン下向き";
+            *pdata_->pout_ << "、スピン下向き";
         }
 
-        std::cout << "の波動関数と固有値を計算します。\n";
+        *pdata_->pout_ << "の波動関数と固有値を計算します。\n";
     }
 
     ScfLoop::mypair ScfLoop::operator()()
@@ -73,19 +79,38 @@ namespace schrac {
         }
     }
 
+    std::shared_ptr<Data> ScfLoop::read_input(std::pair<std::string, bool> const & arg, std::ostream & os)
+    {
+        ReadInputFile rif(arg);         // ファイルを読み込む
+        rif.readFile();
+
+        auto const pdata = rif.PData();
+        pdata->pout_ = &os;
+
+        if (pdata->grid_auto_) {
+            os << "Grid: xmin = " << pdata->xmin_
+               << ", xmax = " << pdata->xmax_
+               << ", num = " << pdata->grid_num_
+               << " (tolerance = " << pdata->grid_tolerance_ << ")" << std::endl;
+        }
+
+        return pdata;
+    }
+
     // #endregion publicメンバ関数
 
     // #region privateメンバ関数
     
-    bool ScfLoop::check_converge(dvector const & newrho, std::int32_t scfloop)
+    bool ScfLoop::check_converge(dvector const & newrho, std::int32_t scfloop, std::int32_t solvecount)
     {
         auto const normrd = std::abs(req_normrd(newrho, prho_->PRho));
 
         req_hartree_energy(newrho, pvh_->Vhart);
-        std::cout << std::setw(2) << "Iteration # "
+        *pdata_->pout_ << std::setw(2) << "Iteration # "
             << scfloop
             << ": NormRD = " << normrd
             << ", Energy = " << req_energy(pdiffdata_->E_)
+            << ", ODE solves = " << solvecount
             << std::endl;
 
         return normrd < pdata_->scf_criterion_;
@@ -99,25 +124,54 @@ namespace schrac {
         for (auto i = 0; i <= pdata_->grid_num_; i++) {
             pdiffdata_->r_mesh_.push_back(std::exp(pdata_->xmin_ + static_cast<double>(i) * pdiffdata_->dx_));
         }
+
+        pdiffdata_->psimpson_ = std::make_shared<Simpson>(pdiffdata_->dx_, pdiffdata_->r_mesh_);
     }
 
     void ScfLoop::make_vhartree()
     {
         pdiffsolver_->solve_poisson();
-        pvh_->set_vhartree_boundary_condition(pdata_->Z_);
-        pvh_->vhart_init();
+
+        // 遠方でHartreeポテンシャルがQ / r（Qは密度ρ(r)の全電荷）になるようにする
+        auto one = pdiffdata_->pworkspace_->acquire();
+        std::fill(one.begin(), one.end(), 1.0);
+        pvh_->set_vhartree_boundary_condition((*pdiffdata_->psimpson_)(prho_->PRho(), one, 3));
+        pvh_->vhart_init(*pdiffdata_->parena_);
+        pdiffdata_->pworkspace_->release(std::move(one));
     }
 
-    void ScfLoop::req_hartree_energy(dvector const & rho, dvector const & vhartree)
+    void ScfLoop::print_stats(SolveStats const & stats, std::int32_t solvecount)
     {
-        dvector u2;
-        u2.reserve(pdata_->grid_num_ + 1);
-        for (auto i = 0; i <= pdata_->grid_num_; i++) {
-            u2.push_back(sqr(pdiffdata_->r_mesh_[i]) * rho[i]);
+        if (!SolveStats::enabled()) {
+            return;
+        }
+
+        stats.print(*pdata_->pout_, "Eigenvalue search", solvecount);
+
+        // H原子の場合はPoisson方程式を解かない
+        if (prho_) {
+            pdiffsolver_->stats_.print(*pdata_->pout_, "Poisson", 1);
+            pdiffsolver_->stats_ = SolveStats();
         }
+    }
+
+    void ScfLoop::save_checkpoint(std::int32_t scfloop, double E, std::optional<double> const & dE) const
+    {
+        CHECKPOINT_SCOPE("ScfLoop::save_checkpoint");
+
+        ScfCheckpoint::State state;
+        state.iteration = scfloop;
+        state.E = E;
+        state.dE = dE;
+        state.mixing = prho_->PMixingState;
+
+        ScfCheckpoint::save(pdata_->scf_checkpoint_, pdiffdata_, state);
+    }
 
-        Simpson simpson(pdiffdata_->dx_);
-        ehartree_.emplace(simpson(vhartree, u2, pdiffdata_->r_mesh_, 1));
+    void ScfLoop::req_hartree_energy(dvector const & rho, dvector const & vhartree)
+    {
+        // ∫VH(r)ρ(r)r^2dr
+        ehartree_.emplace((*pdiffdata_->psimpson_)(vhartree, rho, 3));
     }
 
     double ScfLoop::req_energy(double eigen) const
@@ -127,26 +181,31 @@ namespace schrac {
 
     double ScfLoop::req_normrd(dvector const & newrho, dvector const & oldrho) const
     {
-        using namespace boost::math::constants;
         BOOST_ASSERT(newrho.size() == oldrho.size());
 
-        dvector residual;
-        residual.reserve(newrho.size());
-
+        auto residual = pdiffdata_->pworkspace_->acquire();
         for (auto i = 0; i <= pdata_->grid_num_; i++) {
-            residual.push_back(newrho[i] - oldrho[i]);
+            residual[i] = newrho[i] - oldrho[i];
         }
 
-        Simpson const simpson(pdiffdata_->dx_);
-        return 4.0 * pi<double>() * simpson(residual, residual, pdiffdata_->r_mesh_, 3);
+        auto const normrd = req_inner_product(residual, residual);
+        pdiffdata_->pworkspace_->release(std::move(residual));
+
+        return normrd;
+    }
+
+    double ScfLoop::req_inner_product(dvector const & f, dvector const & g) const
+    {
+        using namespace boost::math::constants;
+
+        return 4.0 * pi<double>() * (*pdiffdata_->psimpson_)(f, g, 3);
     }
 
     dvector ScfLoop::req_newrho(dvector const & rf) const
     {
-        dvector newrho;
-        newrho.reserve(pdata_->grid_num_ + 1);
+        auto newrho = pdiffdata_->pworkspace_->acquire();
         for (auto i = 0; i <= pdata_->grid_num_; i++) {
-            newrho.push_back(sqr(rf[i]));
+            newrho[i] = sqr(rf[i]);
         }
 
         return newrho;
@@ -160,34 +219,87 @@ namespace schrac {
             throw std::runtime_error("固有値が見つかりませんでした。終了します。");
         }
 
+        *pdata_->pout_ << "固有値の検索で微分方程式を解いた回数 = " << evs.PSolveCount() << std::endl;
+        print_stats(evs.PSolveStats, evs.PSolveCount);
+        iteration_ = 1;
+
         return nomalization(evs.PDiffSolver);
     }
 
     ScfLoop::mymap ScfLoop::scfrun()
     {
+        CHECKPOINT_SCOPE("ScfLoop::scfrun");
+
         auto scfloop = 1;
         ScfLoop::mymap wavefunctions;
+
+        // 前回のSCFの固有値と、その変化量（次の固有値検索のウォームスタートに使う）
+        std::optional<double> Eprev, dEprev;
+
+        // チェックポイントから再開する場合は、保存したときの次のループから始める
+        if (!pdata_->scf_restart_.empty()) {
+            auto const state = ScfCheckpoint::load(pdata_->scf_restart_, pdiffdata_);
+            prho_->PMixingState(state.mixing);
+            Eprev = state.E;
+            dEprev = state.dE;
+            scfloop = state.iteration + 1;
+
+            *pdata_->pout_ << pdata_->scf_restart_ << " から、Iteration # " << scfloop << " のSCFを再開します。" << std::endl;
+        }
+
         for (; scfloop <= pdata_->scf_maxiter_; scfloop++) {
+            CHECKPOINT_SCOPE("SCF iteration");
+
             prho_->init();
             make_vhartree();
 
-            EigenValueSearch evs(pdata_, pdiffdata_, prho_, pvh_);
+            EigenValueSearch evs(pdata_, pdiffdata_, prho_, pvh_, Eprev, dEprev);
 
             if (!evs.search()) {
                 throw std::runtime_error("固有値が見つかりませんでした。終了します。");
             }
 
+            auto const E = evs.PDiffSolver()->E_;
+            if (Eprev) {
+                dEprev = E - *Eprev;
+            }
+            Eprev = E;
+
+            // 並列の検索でワーカーが解いた分も含めて数える
+            CHECKPOINT_COUNT("DiffSolver::solve_diff_equ (all threads)", evs.PSolveCount());
+
+            // 前のループの波動関数の配列は、作業領域に返却して使い回す
+            for (auto && wf : wavefunctions) {
+                pdiffdata_->pworkspace_->release(std::move(wf.second));
+            }
             wavefunctions = nomalization(evs.PDiffSolver);
-            auto const newrho = req_newrho(wavefunctions.at("2 Eigen function"));
-            if (check_converge(newrho, scfloop)) {
+
+            auto newrho = req_newrho(wavefunctions.at("2 Eigen function"));
+            auto const converged = check_converge(newrho, scfloop, evs.PSolveCount);
+            print_stats(evs.PSolveStats, evs.PSolveCount);
+            if (!converged) {
+                prho_->rhomix(newrho, [this](dvector const & f, dvector const & g) { return req_inner_product(f, g); });
+            }
+            pdiffdata_->pworkspace_->release(std::move(newrho));
+
+            // このループで使った作業用の配列をまとめて解放する
+            pdiffdata_->parena_->reset();
+
+            if (converged) {
                 break;
             }
-            prho_->rhomix(newrho);
+
+            // 最後のループでも書き出しておき、scf.maxIterを増やして再開できるようにする
+            if (!pdata_->scf_checkpoint_.empty() &&
+                (scfloop % pdata_->scf_checkpoint_interval_ == 0 || scfloop == pdata_->scf_maxiter_)) {
+                save_checkpoint(scfloop, E, dEprev);
+            }
         }
 
-        if (scfloop == pdata_->scf_maxiter_) {
+        if (scfloop > pdata_->scf_maxiter_) {
             throw std::runtime_error("SCFが収束しませんでした。終了します。");
         }
+        iteration_ = scfloop;
 
         return wavefunctions;
     }
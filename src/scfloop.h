@@ -11,7 +11,9 @@
 #pragma once
 
 #include "diffsolver.h"
+#include <iostream>         // for std::cout, std::ostream
 #include <optional>			// for std::optional
+#include <boost/container/flat_map.hpp>  // for boost::container::flat_map
 
 namespace schrac {
     class ScfLoop final {
@@ -27,10 +29,18 @@ namespace schrac {
 
         //! A constructor.
         /*!
-            唯一のコンストラクタ
+            インプットファイルを読み込んで初期化するコンストラクタ
             \param arg インプットファイル名とTBBを使用するかどうかのstd::pair
+            \param os 計算の経過や結果を書き出すストリーム
         */
-        explicit ScfLoop(std::pair<std::string, bool> const & arg);
+        explicit ScfLoop(std::pair<std::string, bool> const & arg, std::ostream & os = std::cout);
+
+        //! A constructor.
+        /*!
+            読み込んだデータで初期化するコンストラクタ
+            \param pdata データオブジェクト
+        */
+        explicit ScfLoop(std::shared_ptr<Data> const & pdata);
         
         //! A destructor.
         /*!
@@ -55,6 +65,15 @@ namespace schrac {
         */
         ScfLoop::mypair operator()();
 
+        //! A public static member function.
+        /*!
+            インプットファイルを読み込む
+            \param arg インプットファイル名とTBBを使用するかどうかのstd::pair
+            \param os 計算の経過や結果を書き出すストリーム
+            \return 読み込んだデータ
+        */
+        static std::shared_ptr<Data> read_input(std::pair<std::string, bool> const & arg, std::ostream & os = std::cout);
+
         // #endregion publicメンバ関数
 
         // #region privateメンバ関数
@@ -65,9 +84,10 @@ namespace schrac {
             与えられた密度ρ(r)で、SCFが収束したかどうか判定する
             \param newrho ρ(r)
             \param scfloop SCFのループ回数
+            \param solvecount 固有値の検索で微分方程式を解いた回数
             \return SCFが収束したかどうか
         */
-        bool check_converge(dvector const & newrho, std::int32_t scfloop);
+        bool check_converge(dvector const & newrho, std::int32_t scfloop, std::int32_t solvecount);
 
         //! A private member function.
         /*!
@@ -81,6 +101,15 @@ namespace schrac {
         */
         void make_vhartree();
 
+        //! A private member function.
+        /*!
+            --statsが指定されていれば、エネルギーの試行ごとの微分方程式の求解の統計と、
+            このSCFのステップでPoisson方程式を解いたときの統計を表示する（後者はリセットする）
+            \param stats 固有値の検索で微分方程式を解いたときの統計
+            \param solvecount 固有値の検索で微分方程式を解いた回数
+        */
+        void print_stats(SolveStats const & stats, std::int32_t solvecount);
+
         //! A private member function.
         /*!
             与えられた固有値、密度及びHartreeポテンシャルから全エネルギーを求める
@@ -99,6 +128,15 @@ namespace schrac {
         */
         void req_hartree_energy(dvector const & rho, dvector const & vhartree);
 
+        //! A private member function.
+        /*!
+            残差ノルムと同じ重みで、二つの関数の内積4π∫f(r)g(r)r^2drを求める
+            \param f 関数f(r)
+            \param g 関数g(r)
+            \return 内積
+        */
+        double req_inner_product(dvector const & f, dvector const & g) const;
+
         //! A private member function.
         /*!
             残差ノルムを求める
@@ -112,7 +150,7 @@ namespace schrac {
         /*!
             RF(r)から、新しい密度ρnew(r)を求める
             \param rf RF(r)
-            \return 密度ρnew(r)
+            \return 密度ρnew(r)（作業領域から借りた配列なので、使い終わったら返却する）
         */
         dvector req_newrho(dvector const & rf) const;
 
@@ -122,6 +160,15 @@ namespace schrac {
         */
         mymap run();
 
+        //! A private member function (const).
+        /*!
+            SCFの途中経過をscf.checkpointのファイルに書き出す（混合した後の、次のループで使う密度を保存する）
+            \param scfloop SCFのループ回数
+            \param E このループで得られた固有値
+            \param dE 一つ前のループからの固有値の変化量
+        */
+        void save_checkpoint(std::int32_t scfloop, double E, std::optional<double> const & dE) const;
+
         //! A private member function.
         /*!
             実際にSCFを実行する
@@ -154,6 +201,13 @@ namespace schrac {
         */
         Property<std::optional<double>> const PEhartree;
 
+        //! A property.
+        /*!
+            SCFのループ回数を得る（水素原子の場合は1）
+            \return SCFのループ回数
+        */
+        Property<std::int32_t> const PIteration;
+
         // #endregion プロパティ
 
         // #region メンバ変数
@@ -165,6 +219,12 @@ namespace schrac {
         */
         std::optional<double> ehartree_;
 
+        //!  A private member variable.
+        /*!
+            SCFのループ回数
+        */
+        std::int32_t iteration_ = 0;
+
         //!  A private member variable (constant).
         /*!
             データオブジェクト
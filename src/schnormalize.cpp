@@ -7,13 +7,55 @@
 
 #include "schnormalize.h"
 #include "simpson.h"
+#include <algorithm>        // for std::copy
 #include <cmath>            // for std::pow
 #include <utility>          // for std::move
 
 namespace schrac {
     // #region publicメンバ関数
 
+    double SchNormalize::energy_correction()
+    {
+        connect();
+
+        // 内側の解をL(rMP)が連続になるように規格化したときのM(r)の不連続
+        auto const [L, M] = pdiffsolver_->getMPval();
+        auto const D = M[0] - (L[0] / L[1]) * M[1];
+
+        // ΔE = r ** (2l + 1) * L(rMP) * D / (2 * ∫(rR(r)) ** 2 dr)
+        auto const rmp = pdiffdata_->r_mesh_[pdiffdata_->mp_o_];
+        return std::pow(rmp, 2 * pdata_->l_ + 1) * L[0] * D / (2.0 * (*pdiffdata_->psimpson_)(pf_, pf_, 1));
+    }
+
     void SchNormalize::evaluate()
+    {
+        connect();
+        normalize();
+
+        for (auto i = 0; i <= pdata_->grid_num_; i++) {
+            rho_[i] = sqr(pf_[i]);
+        }
+    }
+
+    Normalize<SchNormalize>::mymap SchNormalize::getresult()
+    {
+        auto r = pdiffdata_->pworkspace_->acquire();
+        std::copy(pdiffdata_->r_mesh_.begin(), pdiffdata_->r_mesh_.end(), r.begin());
+
+        Normalize<SchNormalize>::mymap wf;
+        wf["1 Mesh (r)"] = std::move(r);
+        wf["2 Eigen function"] = std::move(rf_);
+        wf["3 Rho (mutiplied 4 * pi * r ** 2)"] = std::move(rho_);
+        wf["4 Eigen function (mutiplied r)"] = std::move(pf_);
+
+        return wf;
+    }
+
+    // #endregion publicメンバ関数
+
+    // #region privateメンバ関数
+
+    void SchNormalize::connect()
     {
         auto const mp_im1 = pdiffdata_->mp_i_ - 1;
 
@@ -25,57 +67,28 @@ namespace schrac {
         auto const ratio = (std::get<0>(mpval))[0] / (std::get<0>(mpval))[1];
 
         auto const mp_o = pdiffdata_->mp_o_;
-        
-        L_.reserve(pdata_->grid_num_ + 1);
-        L_.assign(lo.begin(), lo.end());
-
-        rf_.reserve(pdata_->grid_num_ + 1);
-        pf_.reserve(pdata_->grid_num_ + 1);
-
-        M_.reserve(pdata_->grid_num_ + 1);
-        M_.assign(pdiffdata_->mo_.begin(), pdiffdata_->mo_.end());
 
         for (auto i = 0; i <= mp_o; i++) {
-            rf_.push_back(std::pow(pdiffdata_->r_mesh_[i], pdata_->l_) * lo[i]);
-            pf_.push_back(pdiffdata_->r_mesh_[i] * rf_[i]);
-        }        
-
-        for (auto i = mp_im1; i >= 0; i--) {
-            L_.push_back(ratio * li[i]);
-            M_.push_back(ratio * pdiffdata_->mi_[i]);
-
-            rf_.push_back(std::pow(r_mesh_i[i], pdata_->l_) * L_.back());
-            pf_.push_back(r_mesh_i[i] * rf_.back());
+            rf_[i] = std::pow(pdiffdata_->r_mesh_[i], pdata_->l_) * lo[i];
+            pf_[i] = pdiffdata_->r_mesh_[i] * rf_[i];
         }
 
-        normalize();
-
-        rho_.reserve(pdata_->grid_num_ + 1);
-        for (auto const v : pf_) {
-            rho_.push_back(sqr(v));
+        // 内側の解は、r_mesh_i[i]がr_mesh_[grid_num - i]と同じ点
+        for (auto i = mp_im1; i >= 0; i--) {
+            auto const k = pdata_->grid_num_ - i;
+            rf_[k] = std::pow(r_mesh_i[i], pdata_->l_) * (ratio * li[i]);
+            pf_[k] = r_mesh_i[i] * rf_[k];
         }
     }
 
-    Normalize<SchNormalize>::mymap SchNormalize::getresult() const
-    {
-        Normalize<SchNormalize>::mymap wf;
-        wf["1 Mesh (r)"] = pdiffdata_->r_mesh_;
-        wf["2 Eigen function"] = std::move(rf_);
-        wf["3 Rho (mutiplied 4 * pi * r ** 2)"] = std::move(rho_);
-        wf["4 Eigen function (mutiplied r)"] = std::move(pf_);
-
-        return wf;
-    }
-
     void SchNormalize::normalize()
     {
-        Simpson simpson(pdiffdata_->dx_);
-        auto const n = 1.0 / std::sqrt(simpson(pf_, pdiffdata_->r_mesh_));
+        auto const n = 1.0 / std::sqrt((*pdiffdata_->psimpson_)(pf_, pf_, 1));
         for (auto i = 0; i <= pdata_->grid_num_; i++) {
             rf_[i] *= n;
             pf_[i] *= n;
         }
     }
 
-    // #endregion publicメンバ関数
+    // #endregion privateメンバ関数
 }
@@ -36,15 +36,19 @@ namespace schrac {
             \param pdiffsolver 微分方程式のデータオブジェクト
         */
         SchNormalize(std::shared_ptr<DiffSolver> const & pdiffsolver) :
-            Normalize<SchNormalize>(pdiffsolver)
+            Normalize<SchNormalize>(pdiffsolver),
+            pf_(pdiffdata_->pworkspace_->acquire())
         {
         }
 
         //! A destructor.
         /*!
-            デフォルトデストラクタ
+            デストラクタ（借りた配列を作業領域に返却する）
         */
-        ~SchNormalize() = default;
+        ~SchNormalize()
+        {
+            pdiffdata_->pworkspace_->release(std::move(pf_));
+        }
 
         // #endregion コンストラクタ・デストラクタ
 
@@ -58,16 +62,29 @@ namespace schrac {
         
         //! A public member function.
         /*!
-            求めた結果を返す
+            求めた結果を返す（波動関数と電子密度は、このオブジェクトからムーブする）
             \return メッシュと波動関数が格納されたmap
         */
-        Normalize<SchNormalize>::mymap getresult() const;
+        Normalize<SchNormalize>::mymap getresult();
+
+        //! A public member function.
+        /*!
+            マッチングポイントでのM(r)の不連続から、一次の摂動論によるエネルギー固有値の補正を求める
+            \return エネルギー固有値の補正
+        */
+        double energy_correction();
 
         // #endregion publicメンバ関数
 
         // #region privateメンバ関数
 
     private:
+        //! A private member function.
+        /*!
+            外側と内側の解をつなげて、（正規化されていない）波動関数を作る
+        */
+        void connect();
+
         //! A private member function.
         /*!
             波動関数を正規化する
@@ -80,7 +97,7 @@ namespace schrac {
         
         //! A private member variable.
         /*!
-            角度方向のrをかけた固有関数
+            角度方向のrをかけた固有関数（作業領域から借りた、メッシュの点の数の大きさの配列）
         */
         dvector pf_;
 
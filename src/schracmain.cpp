@@ -5,14 +5,20 @@
     This software is released under the BSD 2-Clause License.
 */
 
+#include "batchrun.h"
 #include "checkpoint/checkpoint.h"
+#include "checkpoint/profiler.h"
 #include "energy.h"
 #include "getcomlineoption.h"
 #include "goexit.h"
 #include "normalization.h"
 #include "scfloop.h"
+#include "shellscf.h"
+#include "solvestats.h"
+#include "sweeprun.h"
 #include "wavefunctionsave.h"
 #include <cstdlib>                              // for EXIT_FAILURE, EXIT_SUCCESS
+#include <fstream>                              // for std::ofstream
 #include <iostream>                             // for std::cerr
 #include <optional>								// for std::optional
 #include <boost/format.hpp>                     // for boost::format
@@ -48,30 +54,112 @@ int main(int argc, char * argv[])
 
     cp.checkpoint("コマンドラインオプション解析処理", __LINE__);
 
+    // 計測結果の表示か書き出しが指定されている場合だけ、関数ごとの計測を行う
+    checkpoint::Profiler::enable(mg.getprofile() || !mg.getprofilejsonname().empty());
+    SolveStats::enable(mg.getstats());
+
+    auto const profileoutput = [&mg] {
+        if (mg.getprofile()) {
+            checkpoint::Profiler::report();
+        }
+
+        if (!mg.getprofilejsonname().empty()) {
+            std::ofstream ofs(mg.getprofilejsonname());
+            checkpoint::Profiler::json(ofs);
+            if (!ofs) {
+                std::cerr << mg.getprofilejsonname() << " が作成できませんでした。" << std::endl;
+            }
+        }
+    };
+
+    // バイナリファイルの変換が指定されている場合は、変換だけを行って終了
+    if (!mg.getconvertname().empty()) {
+        auto const ok = WaveFunctionSave::convert(mg.getconvertname());
+        goexit();
+
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // バッチ実行かパラメータスキャンが指定されている場合は、すべてのジョブを実行して終了
+    if (!mg.getbatchname().empty() || !mg.getsweepname().empty()) {
+        try {
+            auto const ok = !mg.getbatchname().empty() ?
+                BatchRun(
+                    BatchRun::make_joblist(mg.getbatchname()),
+                    mg.getjobs(),
+                    mg.getpairdata().second,
+                    mg.getoutputtype())() :
+                SweepRun(
+                    mg.getsweepname(),
+                    mg.getjobs(),
+                    mg.getpairdata().second,
+                    mg.getoutputtype())();
+
+            cp.checkpoint("バッチ実行処理", __LINE__);
+            cp.checkpoint_print();
+            cp.totalpassageoftime();
+            checkpoint::usedmem();
+            profileoutput();
+            goexit();
+
+            return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        catch (std::runtime_error const & e) {
+            std::cerr << e.what() << std::endl;
+            goexit();
+            return EXIT_FAILURE;
+        }
+    }
+
     try {
-        ScfLoop sl(mg.getpairdata());
+        auto const pdata = ScfLoop::read_input(mg.getpairdata());
+
+        if (!pdata->shells_.empty()) {
+            // 電子が複数の殻を占有している場合は、すべての殻を解く
+            ShellScf ss(pdata);
+
+            cp.checkpoint("初期化処理", __LINE__);
 
-        cp.checkpoint("初期化処理", __LINE__);
+            auto const results = ss();
 
-        auto [pdiffdata, wavefunctions] = sl();
+            cp.checkpoint("微分方程式の積分と固有値探索処理及び規格化処理", __LINE__);
 
-        cp.checkpoint("微分方程式の積分と固有値探索処理及び規格化処理", __LINE__);
+            ss.express_energy();
 
-        Energy(
-            pdiffdata,
-            wavefunctions.at("1 Mesh (r)"),
-            wavefunctions.at("2 Eigen function"),
-            pdiffdata->pdata_->Z_).express_energy(sl.PEhartree);
+            cp.checkpoint("エネルギー出力処理", __LINE__);
 
-        cp.checkpoint("エネルギー出力処理", __LINE__);
+            for (auto const & [pdiffdata, wavefunctions] : results) {
+                WaveFunctionSave wfs(wavefunctions, pdiffdata->pdata_, mg.getoutputtype());
+                wfs();
+            }
 
-		WaveFunctionSave wfs(wavefunctions, pdiffdata->pdata_);
-		wfs();
+            cp.checkpoint("ファイル書き込み処理", __LINE__);
+        }
+        else {
+            ScfLoop sl(pdata);
 
-		cp.checkpoint("ファイル書き込み処理", __LINE__);
+            cp.checkpoint("初期化処理", __LINE__);
+
+            auto [pdiffdata, wavefunctions] = sl();
+
+            cp.checkpoint("微分方程式の積分と固有値探索処理及び規格化処理", __LINE__);
+
+            Energy(
+                pdiffdata,
+                wavefunctions.at("2 Eigen function"),
+                pdiffdata->pdata_->Z_).express_energy(sl.PEhartree);
+
+            cp.checkpoint("エネルギー出力処理", __LINE__);
+
+            WaveFunctionSave wfs(wavefunctions, pdiffdata->pdata_, mg.getoutputtype());
+            wfs();
+
+            cp.checkpoint("ファイル書き込み処理", __LINE__);
+        }
     }
     catch (std::runtime_error const & e) {
         std::cerr << e.what() << std::endl;
+        profileoutput();
         goexit();
         return EXIT_FAILURE;
     }
@@ -81,6 +169,8 @@ int main(int argc, char * argv[])
 
     checkpoint::usedmem();
 
+    profileoutput();
+
     goexit();
 
     return EXIT_SUCCESS;
@@ -0,0 +1,436 @@
+﻿/*! \file shellscf.cpp
+    \brief 電子が複数の殻を占有している原子のSCFを行うクラスの実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "normalization.h"
+#include "shellscf.h"
+#include "simpson.h"
+#include "checkpoint/profiler.h"
+#include <algorithm>                                // for std::fill
+#include <cmath>                                    // for std::abs, std::exp, std::pow
+#include <iomanip>                                  // for std::setw
+#include <memory>                                   // for std::make_unique, std::unique_ptr
+#include <ostream>                                  // for std::endl
+#include <stdexcept>                                // for std::runtime_error
+#include <utility>                                  // for std::move
+#include <vector>                                   // for std::vector
+#include <boost/assert.hpp>                         // for BOOST_ASSERT
+#include <boost/math/constants/constants.hpp>       // for boost::math::constants
+#include <boost/math/special_functions/laguerre.hpp> // for boost::math::laguerre
+#include <tbb/parallel_for.h>                       // for tbb::parallel_for
+#include <tbb/task_arena.h>                         // for tbb::this_task_arena::isolate
+
+namespace schrac {
+    // #region コンストラクタ
+
+    ShellScf::ShellScf(std::shared_ptr<Data> const & pdata) :
+        PIteration([this]{ return iteration_; }, nullptr),
+        pdata_(pdata),
+        pxc_(pdata->xc_type_ == Data::Xc_type::LDA ? std::make_unique<Xc>(pdata->grid_num_ + 1) : nullptr)
+    {
+        BOOST_ASSERT(!pdata_->shells_.empty());
+
+        orbitals_.reserve(pdata_->shells_.size());
+        for (auto const & shell : pdata_->shells_) {
+            Orbital orbital;
+            orbital.occupation = shell.occupation;
+
+            orbital.pdata = std::make_shared<Data>(*pdata_);
+            orbital.pdata->n_ = shell.n;
+            orbital.pdata->l_ = shell.l;
+            orbital.pdata->orbital_ = shell.orbital;
+
+            // 固有値の範囲は殻ごとに大きく異なるので、search.LowerEは使わずに殻ごとの近似値から検索する
+            orbital.pdata->search_lowerE_ = std::nullopt;
+
+            // マッチングポイントがAUTOなら、殻ごとに有効核電荷の古典的転回点に置く
+            if (pdata_->mat_po_auto_) {
+                orbital.pdata->mat_po_ratio_ = DiffData::turning_point_ratio(*orbital.pdata, slater_zeff(shell));
+            }
+
+            orbital.pdiffdata = std::make_shared<DiffData>(orbital.pdata);
+            orbital.pdiffdata->r_mesh_.reserve(pdata_->grid_num_ + 1);
+            for (auto i = 0; i <= pdata_->grid_num_; i++) {
+                orbital.pdiffdata->r_mesh_.push_back(std::exp(pdata_->xmin_ + static_cast<double>(i) * orbital.pdiffdata->dx_));
+            }
+            orbital.pdiffdata->psimpson_ = std::make_shared<Simpson>(orbital.pdiffdata->dx_, orbital.pdiffdata->r_mesh_);
+
+            orbital.prho = std::make_shared<Rho>(orbital.pdiffdata);
+            orbital.prho->PMixingState({ initial_rho(shell, *orbital.pdiffdata), {}, {}, {} });
+            orbital.pvh = std::make_shared<Vhartree>(orbital.pdiffdata->r_mesh_);
+            orbital.pdiffsolver = std::make_shared<DiffSolver>(orbital.pdata, orbital.pdiffdata, orbital.prho, orbital.pvh);
+
+            orbitals_.push_back(std::move(orbital));
+        }
+
+        message();
+    }
+
+    // #endregion コンストラクタ
+
+    // #region publicメンバ関数
+
+    double ShellScf::express_energy() const
+    {
+        auto & os = *pdata_->pout_;
+
+        auto eigen = 0.0;
+        for (auto const & orbital : orbitals_) {
+            os << "E(Eigenvalue, " << orbital.pdata->orbital_ << ")\t= " << orbital.pdiffdata->E_ << std::endl;
+            eigen += static_cast<double>(orbital.occupation) * orbital.pdiffdata->E_;
+        }
+
+        // 固有値の和は、運動エネルギー、Coulombエネルギー、Hartreeエネルギーの2倍及び交換相関ポテンシャルの期待値の和になる
+        os << "E(Kinetic Energy)\t= " << eigen - ecoulomb_ - 2.0 * ehartree_ - evxc_ << std::endl;
+        os << "E(Coulomb Energy)\t= " << ecoulomb_ << std::endl;
+        os << "E(Hartree Energy)\t= " << ehartree_ << std::endl;
+
+        if (pxc_) {
+            os << "E(XC Energy)\t\t= " << exc_ << std::endl;
+        }
+
+        auto const etotal = eigen - ehartree_ + exc_ - evxc_;
+        os << "E(Total Energy)\t\t= " << etotal << std::endl;
+
+        return etotal;
+    }
+
+    void ShellScf::message() const
+    {
+        *pdata_->pout_ << pdata_->chemical_symbol_ << "原子の";
+
+        for (auto const & shell : pdata_->shells_) {
+            *pdata_->pout_ << (&shell == &pdata_->shells_.front() ? "" : " ") << shell.orbital << shell.occupation;
+        }
+
+        *pdata_->pout_ << "の電子配置で、各殻の波動関数と固有値を計算します。\n";
+
+        if (pxc_) {
+            *pdata_->pout_ << "交換相関ポテンシャルには局所密度近似（LDA）を使います。\n";
+        }
+    }
+
+    ShellScf::mypairs ShellScf::operator()()
+    {
+        CHECKPOINT_SCOPE("ShellScf::operator()");
+
+        auto scfloop = 1;
+        for (; scfloop <= pdata_->scf_maxiter_; scfloop++) {
+            CHECKPOINT_SCOPE("SCF iteration");
+
+            // 各殻の電子一つが作るHartreeポテンシャルを求めてから、それらを足し合わせる
+            for_each_orbital([this](std::size_t i) { make_vhone(orbitals_[i]); });
+
+            // 交換相関ポテンシャルは全電子の密度だけで決まるので、殻ごとではなくメッシュ上で一度だけ求める
+            if (pxc_) {
+                make_vxc();
+            }
+
+            for_each_orbital([this](std::size_t i) { make_vhartree(orbitals_[i]); });
+
+            // 固有値検索のオブジェクトは出力ストリームの書式を変えるので、先に一つずつ作っておく
+            std::vector<std::unique_ptr<EigenValueSearch>> evs;
+            evs.reserve(orbitals_.size());
+            for (auto const & orbital : orbitals_) {
+                evs.push_back(std::make_unique<EigenValueSearch>(
+                    orbital.pdata, orbital.pdiffdata, orbital.prho, orbital.pvh, orbital.Eprev, orbital.dEprev));
+            }
+
+            for_each_orbital([this, &evs](std::size_t i) { search(orbitals_[i], *evs[i]); });
+
+            auto const converged = check_converge(scfloop);
+            print_stats();
+
+            for_each_orbital([this, converged](std::size_t i) {
+                auto & orbital = orbitals_[i];
+                if (!converged) {
+                    orbital.prho->rhomix(orbital.newrho, [this, &orbital](dvector const & f, dvector const & g) {
+                        return req_inner_product(orbital, f, g);
+                    });
+                }
+                orbital.pdiffdata->pworkspace_->release(std::move(orbital.newrho));
+
+                // このループで使った作業用の配列をまとめて解放する
+                orbital.pdiffdata->parena_->reset();
+            });
+
+            if (converged) {
+                break;
+            }
+        }
+
+        if (scfloop > pdata_->scf_maxiter_) {
+            throw std::runtime_error("SCFが収束しませんでした。終了します。");
+        }
+        iteration_ = scfloop;
+
+        // -ZΣq∫RF(r)^2 / r dr
+        ecoulomb_ = 0.0;
+        for (auto const & orbital : orbitals_) {
+            auto const & rf = orbital.wavefunctions.at("2 Eigen function");
+            ecoulomb_ -= pdata_->Z_ * static_cast<double>(orbital.occupation) * (*orbital.pdiffdata->psimpson_)(rf, rf, 2);
+        }
+
+        mypairs result;
+        result.reserve(orbitals_.size());
+        for (auto & orbital : orbitals_) {
+            result.emplace_back(orbital.pdiffdata, std::move(orbital.wavefunctions));
+        }
+
+        return result;
+    }
+
+    // #endregion publicメンバ関数
+
+    // #region privateメンバ関数
+
+    bool ShellScf::check_converge(std::int32_t scfloop)
+    {
+        // 残差は全電子の密度の残差を電子一つ当たりに直したものとする（He原子の1s2ではScfLoopと同じ値になる）
+        auto const & front = orbitals_.front();
+        auto residual = front.pdiffdata->pworkspace_->acquire();
+        std::fill(residual.begin(), residual.end(), 0.0);
+
+        auto electrons = 0.0;
+        for (auto const & orbital : orbitals_) {
+            electrons += static_cast<double>(orbital.occupation);
+        }
+
+        // Hartreeエネルギー 1/2Σq∫VH(r)ρ(r)r^2dr、交換相関エネルギーΣq∫εxc(r)ρ(r)r^2dr、
+        // 交換相関ポテンシャルの期待値Σq∫Vxc(r)ρ(r)r^2dr及び固有値の和を求める
+        // （VH(r)の配列には交換相関ポテンシャルも足してあるので、後でその分を引く）
+        auto eigen = 0.0;
+        auto solvecount = 0;
+        ehartree_ = 0.0;
+        exc_ = 0.0;
+        evxc_ = 0.0;
+        for (auto const & orbital : orbitals_) {
+            auto const & rho = orbital.prho->PRho();
+            auto const q = static_cast<double>(orbital.occupation);
+            for (auto i = 0U; i < residual.size(); i++) {
+                residual[i] += q * (orbital.newrho[i] - rho[i]) / electrons;
+            }
+
+            ehartree_ += 0.5 * q * (*orbital.pdiffdata->psimpson_)(orbital.pvh->Vhart, orbital.newrho, 3);
+            if (pxc_) {
+                exc_ += q * (*orbital.pdiffdata->psimpson_)(pxc_->Exc, orbital.newrho, 3);
+                evxc_ += q * (*orbital.pdiffdata->psimpson_)(pxc_->Vxc, orbital.newrho, 3);
+            }
+            eigen += q * orbital.pdiffdata->E_;
+            solvecount += orbital.solvecount;
+        }
+
+        ehartree_ -= 0.5 * evxc_;
+
+        auto const normrd = std::abs(req_inner_product(front, residual, residual));
+        front.pdiffdata->pworkspace_->release(std::move(residual));
+
+        *pdata_->pout_ << std::setw(2) << "Iteration # "
+            << scfloop
+            << ": NormRD = " << normrd
+            << ", Energy = " << eigen - ehartree_ + exc_ - evxc_
+            << ", ODE solves = " << solvecount
+            << std::endl;
+
+        return normrd < pdata_->scf_criterion_;
+    }
+
+    template <typename Function>
+    void ShellScf::for_each_orbital(Function && func)
+    {
+        auto const size = orbitals_.size();
+
+        // 殻ごとのオブジェクトは独立なので、殻の数だけタスクを作る
+        // （殻の中の固有値検索が並列処理を待つ間に、別の殻のタスクを横取りしないように隔離する）
+        if (pdata_->usetbb_) {
+            tbb::parallel_for(std::size_t(0), size, [&func](std::size_t i) {
+                tbb::this_task_arena::isolate([&func, i] { func(i); });
+            });
+        }
+        else {
+            for (auto i = 0U; i < size; i++) {
+                func(i);
+            }
+        }
+    }
+
+    dvector ShellScf::initial_rho(Data::Shell const & shell, DiffData const & diffdata) const
+    {
+        // Rnl(r) ∝ x^l * exp(-x / 2) * L_{n - l - 1}^{2l + 1}(x)、x = 2Zeff * r / n
+        auto const zeff = slater_zeff(shell);
+        auto const n = static_cast<unsigned>(shell.n);
+        auto const l = static_cast<unsigned>(shell.l);
+
+        dvector rho;
+        rho.reserve(diffdata.r_mesh_.size());
+        for (auto const r : diffdata.r_mesh_) {
+            auto const x = 2.0 * zeff * r / static_cast<double>(n);
+            rho.push_back(sqr(std::pow(x, l) * std::exp(-0.5 * x) * boost::math::laguerre(n - l - 1, 2 * l + 1, x)));
+        }
+
+        dvector const one(rho.size(), 1.0);
+        auto const q = (*diffdata.psimpson_)(rho, one, 3);
+        for (auto && v : rho) {
+            v /= q;
+        }
+
+        return rho;
+    }
+
+    void ShellScf::make_vhartree(Orbital & orbital)
+    {
+        auto vhart = orbital.pdiffdata->pworkspace_->acquire();
+        std::fill(vhart.begin(), vhart.end(), 0.0);
+
+        for (auto const & other : orbitals_) {
+            // 交換相関ポテンシャルを使う場合は、自己相互作用は交換相関ポテンシャルに任せる
+            auto const q = static_cast<double>(other.occupation - (!pxc_ && &other == &orbital ? 1 : 0));
+            if (q == 0.0) {
+                continue;
+            }
+
+            for (auto i = 0U; i < vhart.size(); i++) {
+                vhart[i] += q * other.vhone[i];
+            }
+        }
+
+        // 交換相関ポテンシャルも足しておけば、微分方程式のポテンシャルの数表にそのまま含まれる
+        if (pxc_) {
+            dvector const & vxc = pxc_->Vxc;
+            for (auto i = 0U; i < vhart.size(); i++) {
+                vhart[i] += vxc[i];
+            }
+        }
+
+        orbital.pvh->Vhart(vhart);
+        orbital.pvh->vhart_init(*orbital.pdiffdata->parena_);
+        orbital.pdiffdata->pworkspace_->release(std::move(vhart));
+    }
+
+    void ShellScf::make_vhone(Orbital & orbital) const
+    {
+        orbital.prho->init();
+        orbital.pdiffsolver->solve_poisson();
+
+        // 遠方でHartreeポテンシャルが1 / rになるようにする
+        auto one = orbital.pdiffdata->pworkspace_->acquire();
+        std::fill(one.begin(), one.end(), 1.0);
+        orbital.pvh->set_vhartree_boundary_condition((*orbital.pdiffdata->psimpson_)(orbital.prho->PRho(), one, 3));
+        orbital.pdiffdata->pworkspace_->release(std::move(one));
+
+        orbital.vhone = orbital.pvh->Vhart;
+    }
+
+    void ShellScf::make_vxc()
+    {
+        auto const & front = orbitals_.front();
+        auto rho = front.pdiffdata->pworkspace_->acquire();
+        std::fill(rho.begin(), rho.end(), 0.0);
+
+        for (auto const & orbital : orbitals_) {
+            auto const & rhoone = orbital.prho->PRho();
+            auto const q = static_cast<double>(orbital.occupation);
+            for (auto i = 0U; i < rho.size(); i++) {
+                rho[i] += q * rhoone[i];
+            }
+        }
+
+        (*pxc_)(rho);
+        front.pdiffdata->pworkspace_->release(std::move(rho));
+    }
+
+    void ShellScf::print_stats()
+    {
+        if (!SolveStats::enabled()) {
+            return;
+        }
+
+        SolveStats stats, poisson;
+        auto solvecount = 0;
+        for (auto & orbital : orbitals_) {
+            stats += orbital.stats;
+            poisson += orbital.pdiffsolver->stats_;
+            solvecount += orbital.solvecount;
+            orbital.pdiffsolver->stats_ = SolveStats();
+        }
+
+        stats.print(*pdata_->pout_, "Eigenvalue search", solvecount);
+        poisson.print(*pdata_->pout_, "Poisson", static_cast<std::int32_t>(orbitals_.size()));
+    }
+
+    double ShellScf::req_inner_product(Orbital const & orbital, dvector const & f, dvector const & g) const
+    {
+        using namespace boost::math::constants;
+
+        return 4.0 * pi<double>() * (*orbital.pdiffdata->psimpson_)(f, g, 3);
+    }
+
+    void ShellScf::search(Orbital & orbital, EigenValueSearch & evs)
+    {
+        if (!evs.search()) {
+            throw std::runtime_error(orbital.pdata->orbital_ + "軌道の固有値が見つかりませんでした。終了します。");
+        }
+
+        auto const E = evs.PDiffSolver()->E_;
+        if (orbital.Eprev) {
+            orbital.dEprev = E - *orbital.Eprev;
+        }
+        orbital.Eprev = E;
+
+        // 並列の検索でワーカーが解いた分も含めて数える
+        CHECKPOINT_COUNT("DiffSolver::solve_diff_equ (all threads)", evs.PSolveCount());
+        orbital.solvecount = evs.PSolveCount;
+        orbital.stats = evs.PSolveStats;
+
+        // 前のループの波動関数の配列は、作業領域に返却して使い回す
+        for (auto && wf : orbital.wavefunctions) {
+            orbital.pdiffdata->pworkspace_->release(std::move(wf.second));
+        }
+        orbital.wavefunctions = nomalization(evs.PDiffSolver);
+
+        auto const & rf = orbital.wavefunctions.at("2 Eigen function");
+        orbital.newrho = orbital.pdiffdata->pworkspace_->acquire();
+        for (auto i = 0U; i < rf.size(); i++) {
+            orbital.newrho[i] = sqr(rf[i]);
+        }
+    }
+
+    double ShellScf::slater_zeff(Data::Shell const & shell) const
+    {
+        auto sigma = 0.0;
+        for (auto const & other : pdata_->shells_) {
+            // 自分自身は遮蔽に含めない
+            auto const q = static_cast<double>(other.occupation - (other.n == shell.n && other.l == shell.l ? 1 : 0));
+
+            if (shell.l <= 1) {
+                // s、p電子は、同じ主量子数のs、p電子から0.35（1s電子同士は0.30）、
+                // 主量子数が一つ小さい電子から0.85、それより内側の電子から1.0だけ遮蔽される
+                if (other.n == shell.n && other.l <= 1) {
+                    sigma += (shell.n == 1 ? 0.30 : 0.35) * q;
+                }
+                else if (other.n + 1 == shell.n) {
+                    sigma += 0.85 * q;
+                }
+                else if (other.n + 1 < shell.n) {
+                    sigma += q;
+                }
+            }
+            else {
+                // d、f電子は、同じ殻の電子から0.35、それより内側の群の電子から1.0だけ遮蔽される
+                if (other.n == shell.n && other.l == shell.l) {
+                    sigma += 0.35 * q;
+                }
+                else if (other.n < shell.n || (other.n == shell.n && other.l < shell.l)) {
+                    sigma += q;
+                }
+            }
+        }
+
+        return pdata_->Z_ - sigma;
+    }
+
+    // #endregion privateメンバ関数
+}
@@ -0,0 +1,341 @@
+﻿/*! \file shellscf.h
+    \brief 電子が複数の殻を占有している原子のSCFを行うクラスの宣言
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _SHELLSCF_H_
+#define _SHELLSCF_H_
+
+#pragma once
+
+#include "eigenvaluesearch.h"
+#include "scfloop.h"
+#include "xc.h"
+#include <cstddef>          // for std::size_t
+#include <memory>           // for std::unique_ptr
+#include <optional>         // for std::optional
+#include <vector>           // for std::vector
+
+namespace schrac {
+    //! A class.
+    /*!
+        Li原子からKr原子までのように、電子が複数の殻を占有している原子のSCFを行うクラス
+        各殻の電子は、他のすべての電子（同じ殻の電子からは自分の分を除く）が作るHartreeポテンシャルの中を運動するとし、
+        交換相関ポテンシャルを使う場合は、全電子のHartreeポテンシャルと交換相関ポテンシャルの中を運動するとする
+        SCFの各ループでは、すべての殻の動径方程式をTBBのタスクで同時に解く
+    */
+    class ShellScf final {
+        // #region 構造体
+
+        //! A struct.
+        /*!
+            一つの殻の計算に使うオブジェクトを集めた構造体
+            殻ごとにメッシュとSimpsonの公式のオブジェクトを持つので、異なる殻は別々のスレッドで計算できる
+        */
+        struct Orbital final {
+            //! A public member variable.
+            /*!
+                殻を占有している電子の数
+            */
+            std::int32_t occupation;
+
+            //! A public member variable.
+            /*!
+                この殻のデータオブジェクト（n_、l_、orbital_以外はインプットファイルのデータと同じ）
+            */
+            std::shared_ptr<Data> pdata;
+
+            //! A public member variable.
+            /*!
+                この殻の微分方程式のデータオブジェクト
+            */
+            std::shared_ptr<DiffData> pdiffdata;
+
+            //! A public member variable.
+            /*!
+                Poisson方程式を解くソルバー
+            */
+            std::shared_ptr<DiffSolver> pdiffsolver;
+
+            //! A public member variable.
+            /*!
+                この殻の電子一つ分の密度ρ(r)
+            */
+            std::shared_ptr<Rho> prho;
+
+            //! A public member variable.
+            /*!
+                この殻の電子が感じるHartreeポテンシャル（交換相関ポテンシャルを使う場合は、それも足してある）
+            */
+            std::shared_ptr<Vhartree> pvh;
+
+            //! A public member variable.
+            /*!
+                この殻の電子一つが作るHartreeポテンシャル
+            */
+            dvector vhone;
+
+            //! A public member variable.
+            /*!
+                このループで得た新しい密度ρnew(r)（作業領域から借りた配列）
+            */
+            dvector newrho;
+
+            //! A public member variable.
+            /*!
+                前回のSCFの固有値（次の固有値検索のウォームスタートに使う）
+            */
+            std::optional<double> Eprev;
+
+            //! A public member variable.
+            /*!
+                前回のSCFでの固有値の変化量
+            */
+            std::optional<double> dEprev;
+
+            //! A public member variable.
+            /*!
+                このループで固有値の検索で微分方程式を解いた回数
+            */
+            std::int32_t solvecount = 0;
+
+            //! A public member variable.
+            /*!
+                このループで固有値の検索で微分方程式を解いたときの統計
+            */
+            SolveStats stats;
+
+            //! A public member variable.
+            /*!
+                規格化された波動関数
+            */
+            ScfLoop::mymap wavefunctions;
+        };
+
+        // #endregion 構造体
+
+    public:
+        // #region 型エイリアス
+
+        using mypairs = std::vector < ScfLoop::mypair > ;
+
+        // #endregion 型エイリアス
+
+        // #region コンストラクタ・デストラクタ
+
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param pdata データオブジェクト（shells_が空であってはならない）
+        */
+        explicit ShellScf(std::shared_ptr<Data> const & pdata);
+
+        //! A destructor.
+        /*!
+            デフォルトデストラクタ
+        */
+        ~ShellScf() = default;
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region publicメンバ関数
+
+        //! A public member function (const).
+        /*!
+            各殻の固有値と、原子の各エネルギーを表示する
+            \return 全エネルギー
+        */
+        double express_energy() const;
+
+        //! A public member function (const).
+        /*!
+            対象の原子と電子配置についてメッセージを表示する
+        */
+        void message() const;
+
+        //! A public member function.
+        /*!
+            SCFを行う
+            \return 内側の殻から順に並べた、各殻の計算結果
+        */
+        ShellScf::mypairs operator()();
+
+        // #endregion publicメンバ関数
+
+        // #region privateメンバ関数
+
+    private:
+        //! A private member function.
+        /*!
+            すべての殻の新しい密度から、SCFが収束したかどうか判定する
+            \param scfloop SCFのループ回数
+            \return SCFが収束したかどうか
+        */
+        bool check_converge(std::int32_t scfloop);
+
+        //! A private member function.
+        /*!
+            すべての殻について関数を呼び出す（TBBを使用する場合は並列に呼び出す）
+            \param func 殻の添字を引数に取る関数
+        */
+        template <typename Function>
+        void for_each_orbital(Function && func);
+
+        //! A private member function (const).
+        /*!
+            有効核電荷の水素様原子の動径波動関数の2乗を、密度の初期値として求める
+            \param shell 殻
+            \param diffdata 殻の微分方程式のデータ
+            \return 規格化された密度ρ0(r)
+        */
+        dvector initial_rho(Data::Shell const & shell, DiffData const & diffdata) const;
+
+        //! A private member function.
+        /*!
+            殻の電子が感じるHartreeポテンシャルを、各殻の電子一つが作るHartreeポテンシャルを足し合わせて求める
+            \param orbital 殻
+        */
+        void make_vhartree(Orbital & orbital);
+
+        //! A private member function (const).
+        /*!
+            殻の電子一つが作るHartreeポテンシャルを求める
+            \param orbital 殻
+        */
+        void make_vhone(Orbital & orbital) const;
+
+        //! A private member function.
+        /*!
+            全電子の密度から、すべての殻で共通の交換相関ポテンシャルを求める
+        */
+        void make_vxc();
+
+        //! A private member function.
+        /*!
+            --statsが指定されていれば、このループのすべての殻の固有値の検索とPoisson方程式の求解の統計を表示する
+            （後者はリセットする）
+        */
+        void print_stats();
+
+        //! A private member function (const).
+        /*!
+            殻の電子一つ分の密度の残差ノルムと同じ重みで、二つの関数の内積4π∫f(r)g(r)r^2drを求める
+            \param orbital 殻
+            \param f 関数f(r)
+            \param g 関数g(r)
+            \return 内積
+        */
+        double req_inner_product(Orbital const & orbital, dvector const & f, dvector const & g) const;
+
+        //! A private member function.
+        /*!
+            殻の固有値を求め、波動関数を規格化して新しい密度を求める
+            \param orbital 殻
+            \param evs 殻の固有値検索のオブジェクト
+        */
+        void search(Orbital & orbital, EigenValueSearch & evs);
+
+        //! A private member function (const).
+        /*!
+            Slaterの規則で殻の有効核電荷を求める
+            \param shell 殻
+            \return 有効核電荷
+        */
+        double slater_zeff(Data::Shell const & shell) const;
+
+        // #endregion privateメンバ関数
+
+        // #region プロパティ
+
+    public:
+        //! A property.
+        /*!
+            SCFのループ回数を得る
+            \return SCFのループ回数
+        */
+        Property<std::int32_t> const PIteration;
+
+        // #endregion プロパティ
+
+        // #region メンバ変数
+
+    private:
+        //!  A private member variable.
+        /*!
+            原子核と電子のCoulombエネルギー
+        */
+        double ecoulomb_ = 0.0;
+
+        //!  A private member variable.
+        /*!
+            Hartreeエネルギー（交換相関ポテンシャルを使わない場合は、同じ殻の電子の自己相互作用は除く）
+        */
+        double ehartree_ = 0.0;
+
+        //!  A private member variable.
+        /*!
+            交換相関エネルギー
+        */
+        double exc_ = 0.0;
+
+        //!  A private member variable.
+        /*!
+            交換相関ポテンシャルの期待値∫Vxc(r)ρ(r)r^2dr
+        */
+        double evxc_ = 0.0;
+
+        //!  A private member variable.
+        /*!
+            SCFのループ回数
+        */
+        std::int32_t iteration_ = 0;
+
+        //!  A private member variable.
+        /*!
+            内側の殻から順に並べた、各殻の計算に使うオブジェクト
+        */
+        std::vector<Orbital> orbitals_;
+
+        //!  A private member variable (constant).
+        /*!
+            データオブジェクト
+        */
+        std::shared_ptr<Data> const pdata_;
+
+        //!  A private member variable (constant).
+        /*!
+            交換相関ポテンシャルのオブジェクト（交換相関ポテンシャルを使わない場合はnullptr）
+        */
+        std::unique_ptr<Xc> const pxc_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        ShellScf() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        ShellScf(ShellScf const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        ShellScf & operator=(ShellScf const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _SHELLSCF_H_
@@ -6,7 +6,9 @@
 */
 
 #include "simpson.h"
-#include <cmath>        // for std::pow
+#include "checkpoint/profiler.h"
+#include <cmath>                // for std::pow
+#include <boost/assert.hpp>     // for BOOST_ASSERT
 
 namespace schrac {
     double Simpson::operator()(Simpson::dvector const & f, Simpson::dvector const & r) const
@@ -16,6 +18,8 @@ namespace schrac {
 
     double Simpson::operator()(Simpson::dvector const & f, Simpson::dvector const & g, Simpson::dvector const & r, std::int32_t n) const
     {
+        CHECKPOINT_SCOPE("Simpson");
+
         auto sum = 0.0;
         auto const max = f.size() - 2;
         for (auto i = 0U; i < max; i += 2) {
@@ -27,4 +31,45 @@ namespace schrac {
         
         return sum * dx_ / 3.0;
     }
+
+    double Simpson::operator()(Simpson::dvector const & f, Simpson::dvector const & g, std::int32_t n) const
+    {
+        CHECKPOINT_SCOPE("Simpson");
+
+        BOOST_ASSERT(f.size() == size_ && g.size() == size_);
+        BOOST_ASSERT(n >= 1 && n <= NMAX);
+
+        auto const & w = weights_[n - 1];
+        auto const size = w.size();
+
+        auto sum = 0.0;
+        for (auto i = 0U; i < size; i++) {
+            sum += w[i] * f[i] * g[i];
+        }
+
+        return sum;
+    }
+
+    std::array<Simpson::dvector, Simpson::NMAX> Simpson::makeweights(double dx, Simpson::dvector const & r)
+    {
+        // operator()(f, g, r, n)と同じく、点の数が偶数なら最後の点は使わない
+        auto const size = r.size() - (r.size() + 1) % 2;
+        dvector coef(size, 0.0);
+        for (auto i = 0U; i + 2 < size; i += 2) {
+            coef[i] += 1.0;
+            coef[i + 1] += 4.0;
+            coef[i + 2] += 1.0;
+        }
+
+        std::array<dvector, NMAX> weights;
+        for (auto n = 1; n <= NMAX; n++) {
+            auto & w = weights[n - 1];
+            w.reserve(size);
+            for (auto i = 0U; i < size; i++) {
+                w.push_back(coef[i] * std::pow(r[i], n) * dx / 3.0);
+            }
+        }
+
+        return weights;
+    }
 }
@@ -10,8 +10,10 @@
 
 #pragma once
 
-#include <cstdint>  // for std::int32_t
-#include <vector>   // for std::vector
+#include <array>            // for std::array
+#include <cstddef>          // for std::size_t
+#include <cstdint>          // for std::int32_t
+#include <vector>           // for std::vector
 
 namespace schrac {
     //! A class.
@@ -25,6 +27,17 @@ namespace schrac {
 
         // #endregion 型エイリアス
 
+        // #region 定数
+
+    public:
+        //! A public member variable (constant expression).
+        /*!
+            重みを用意するr ** nのnの最大値
+        */
+        static auto constexpr NMAX = 3;
+
+        // #endregion 定数
+
         // #region コンストラクタ・デストラクタ
 
     public:
@@ -33,7 +46,17 @@ namespace schrac {
             唯一のコンストラクタ
             \param dx メッシュの間隔
         */
-        Simpson(double dx) : dx_(dx)
+        Simpson(double dx) : dx_(dx), size_(0), weights_()
+        {
+        }
+
+        //! A constructor.
+        /*!
+            メッシュを与えるコンストラクタ（n = 1, ..., NMAXについてr ** n * dxの重みを作っておく）
+            \param dx メッシュの間隔
+            \param r rのメッシュが格納されたstd::vector
+        */
+        Simpson(double dx, dvector const & r) : dx_(dx), size_(r.size()), weights_(makeweights(dx, r))
         {
         }
 
@@ -67,6 +90,27 @@ namespace schrac {
         */
         double operator()(dvector const & f, dvector const & g, dvector const & r, std::int32_t n) const;
 
+        //! A public member function (const).
+        /*!
+            f(r) * g(r) * r ** nを、作っておいた重みを使ってシンプソンの公式で積分する
+            （メッシュを与えるコンストラクタで構築したときのみ使える）
+            \param f 関数f(r)のstd::vector
+            \param g 関数g(r)のstd::vector
+            \param n r ** nのnの値（1 <= n <= NMAX）
+            \return 積分した値
+        */
+        double operator()(dvector const & f, dvector const & g, std::int32_t n) const;
+
+    private:
+        //! A private static member function.
+        /*!
+            n = 1, ..., NMAXについて、シンプソンの公式の係数とdx / 3をかけたr ** nの重みを作る
+            \param dx メッシュの間隔
+            \param r rのメッシュが格納されたstd::vector
+            \return nごとの重み（n - 1番目の要素がr ** nの重み）
+        */
+        static std::array<dvector, NMAX> makeweights(double dx, dvector const & r);
+
         // #endregion メンバ関数
         
         // #region メンバ変数
@@ -78,6 +122,18 @@ namespace schrac {
         */
         double const dx_;
 
+        //! A private member variable (const).
+        /*!
+            rのメッシュの点の数（メッシュ自体は重みを作るときにしか使わないので持たない）
+        */
+        std::size_t const size_;
+
+        //! A private member variable (const).
+        /*!
+            nごとの重み（構築した後は読むだけなので、複数のスレッドから同時に使える）
+        */
+        std::array<dvector, NMAX> const weights_;
+
         // #endregion メンバ変数
         
         // #region 禁止されたコンストラクタ・メンバ関数
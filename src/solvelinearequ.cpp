@@ -6,43 +6,49 @@
 */
 
 #include "solvelinearequ.h"
+#include "gslerrorhandleroff.h"
 #include <cstdint>          // for std::int32_t
-#include <memory>           // for std::unique_ptr
-#include <stdexcept>        // for std::runtime_error
-#include <string>           // for std::to_string
+#include <gsl/gsl_errno.h>  // for GSL_SUCCESS
 #include <gsl/gsl_linalg.h> // for gsl_linalg
 
 namespace schrac {
-    myvector solve_linear_equ(std::array<double, AMMAX * AMMAX> & a, myvector & b)
+    std::optional<myvector> solve_linear_equ(std::array<double, AMMAX * AMMAX> & a, myvector & b)
     {
-        // save original handler, install new handler
-        auto old_handler = gsl_set_error_handler(
-            [](char const * reason, char const * file, std::int32_t line, std::int32_t)
-        {
-            auto const str = std::string(reason) + "\nFile: " + file + "\nline: " + std::to_string(line);
-            throw std::runtime_error(str);
-        });
+        // LU分解で書き換えられるので、スタック上にコピーしてから解く
+        auto av = a;
+        myvector solution;
+        std::array<std::size_t, AMMAX> perm;
+        if (!solve_linear_equ(av.data(), b.data(), solution.data(), perm.data(), AMMAX)) {
+            return std::nullopt;
+        }
+
+        return std::make_optional(solution);
+    }
 
-        auto m = gsl_matrix_view_array(a.data(), AMMAX, AMMAX);
-        auto const v = gsl_vector_view_array(b.data(), AMMAX);
+    bool solve_linear_equ(double * a, double const * b, double * x, std::size_t * perm, std::size_t n)
+    {
+        // GSLの関数からC++の例外を投げないように、エラーハンドラを無効にして戻り値で判定する
+        GslErrorHandlerOff const handleroff;
 
-        std::unique_ptr<gsl_vector, decltype(&gsl_vector_free)> x(
-            gsl_vector_alloc(AMMAX),
-            gsl_vector_free);
+        auto m = gsl_matrix_view_array(a, n, n);
+        auto const v = gsl_vector_const_view_array(b, n);
+        auto xv = gsl_vector_view_array(x, n);
 
-        std::unique_ptr<gsl_permutation, decltype(&gsl_permutation_free)> p(
-            gsl_permutation_alloc(AMMAX),
-            gsl_permutation_free);
+        // gsl_permutation_alloc()でヒープを確保しないように、呼び出し側の領域を使う
+        gsl_permutation p = { n, perm };
 
         std::int32_t s;
-        gsl_linalg_LU_decomp(&m.matrix, p.get(), &s);
-        gsl_linalg_LU_solve(&m.matrix, p.get(), &v.vector, x.get());
-        myvector solution{ 0.0, 0.0, 0.0 };
-        std::copy(x->data, x->data + AMMAX, solution.begin());
-
-        // restore original handler
-        gsl_set_error_handler(old_handler);
-
-        return solution;
+        if (gsl_linalg_LU_decomp(&m.matrix, &p, &s) != GSL_SUCCESS) {
+            return false;
+        }
+
+        // Uの対角成分に0があれば、行列は特異なので解けない
+        for (auto i = 0U; i < n; i++) {
+            if (a[i * n + i] == 0.0) {
+                return false;
+            }
+        }
+
+        return gsl_linalg_LU_solve(&m.matrix, &p, &v.vector, &xv.vector) == GSL_SUCCESS;
     }
 }
@@ -11,6 +11,11 @@
 #pragma once
 
 #include <array>    // for std::array
+#include <cstddef>  // for std::size_t
+#include <memory>   // for std::allocator_traits
+#include <optional> // for std::optional
+#include <utility>  // for std::move
+#include <vector>   // for std::vector
 
 namespace schrac {
     //!  A static variable (constant expression).
@@ -29,9 +34,44 @@ namespace schrac {
         連立一次方程式を解く
         \param a 連立一次方程式Ax = bにおける左辺の行列A
         \param b 連立一次方程式Ax = bにおける右辺のベクトルb
-        \return 方程式の解ベクトル
+        \return 方程式の解ベクトル（行列が特異で解けなければstd::nullopt）
     */
-    myvector solve_linear_equ(std::array<double, AMMAX * AMMAX> & a, myvector & b);
+    std::optional<myvector> solve_linear_equ(std::array<double, AMMAX * AMMAX> & a, myvector & b);
+
+    //! A function.
+    /*!
+        任意の次元の連立一次方程式を、呼び出し側が用意した領域を使って解く
+        \param a 連立一次方程式Ax = bにおける左辺の行列A（行優先で格納し、LU分解で書き換えられる）
+        \param b 連立一次方程式Ax = bにおける右辺のベクトルb
+        \param x 方程式の解ベクトルを書き込む領域
+        \param perm LU分解の置換を書き込む領域
+        \param n 方程式の次元
+        \return 解けたかどうか（行列が特異ならfalse）
+    */
+    bool solve_linear_equ(double * a, double const * b, double * x, std::size_t * perm, std::size_t n);
+
+    //! A template function.
+    /*!
+        任意の次元の連立一次方程式を解く
+        解ベクトルと作業領域は、bと同じアロケーターで確保する
+        \param a 連立一次方程式Ax = bにおける左辺の行列A（行優先で格納する）
+        \param b 連立一次方程式Ax = bにおける右辺のベクトルb
+        \return 方程式の解ベクトル（行列が特異で解けなければstd::nullopt）
+    */
+    template <typename Allocator>
+    std::optional<std::vector<double, Allocator>> solve_linear_equ(std::vector<double, Allocator> & a, std::vector<double, Allocator> & b)
+    {
+        using sizeallocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::size_t>;
+
+        auto const n = b.size();
+        std::vector<double, Allocator> x(n, b.get_allocator());
+        std::vector<std::size_t, sizeallocator> perm(n, sizeallocator(b.get_allocator()));
+        if (!solve_linear_equ(a.data(), b.data(), x.data(), perm.data(), n)) {
+            return std::nullopt;
+        }
+
+        return std::make_optional(std::move(x));
+    }
 }
 
 #endif  // _SOLVELINEAREQU_H_
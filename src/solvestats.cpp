@@ -0,0 +1,53 @@
+﻿/*! \file solvestats.cpp
+    \brief 微分方程式の求解の統計を数えるクラスの実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "solvestats.h"
+#include <algorithm>            // for std::max
+#include <boost/format.hpp>     // for boost::format
+
+namespace schrac {
+    // #region staticメンバ変数
+
+    std::atomic<bool> SolveStats::enabled_(false);
+
+    // #endregion staticメンバ変数
+
+    // #region publicメンバ関数
+
+    SolveStats & SolveStats::operator+=(SolveStats const & rhs)
+    {
+        derivs += rhs.derivs;
+        tablehits += rhs.tablehits;
+        accepted += rhs.accepted;
+        rejected += rhs.rejected;
+        observed += rhs.observed;
+        vhartree += rhs.vhartree;
+        dvhartree += rhs.dvhartree;
+        rho += rhs.rho;
+
+        return *this;
+    }
+
+    void SolveStats::print(std::ostream & os, char const * label, std::int32_t solves) const
+    {
+        auto const persolve = [solves](std::uint64_t n) {
+            return static_cast<double>(n) / static_cast<double>(std::max(solves, 1));
+        };
+
+        os << boost::format("  %s: solves = %d, derivs = %d (%.1f/solve, table hits = %d), "
+                            "steps = %d accepted (%.1f/solve) / %d rejected, observer calls = %d, "
+                            "Vhartree::vhartree = %d, Vhartree::dvhartree_dr = %d, Rho::operator() = %d\n")
+            % label
+            % solves
+            % derivs % persolve(derivs) % tablehits
+            % accepted % persolve(accepted) % rejected
+            % observed
+            % vhartree % dvhartree % rho;
+    }
+
+    // #endregion publicメンバ関数
+}
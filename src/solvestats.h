@@ -0,0 +1,202 @@
+﻿/*! \file solvestats.h
+    \brief 微分方程式の求解の統計を数えるクラスの宣言
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _SOLVESTATS_H_
+#define _SOLVESTATS_H_
+
+#pragma once
+
+#include <atomic>       // for std::atomic
+#include <cstdint>      // for std::int32_t, std::uint64_t
+#include <ostream>      // for std::ostream
+
+namespace schrac {
+    //! A class.
+    /*!
+        微分方程式の求解の統計（右辺の評価回数、ステップ数、スプライン補間の回数など）を数えるクラス
+        数える先はスレッドごとにScopeで設定し、設定されていないスレッドでは何も数えない
+    */
+    class SolveStats final {
+        // #region クラス内クラスの宣言
+
+    public:
+        //! A class.
+        /*!
+            コンストラクタからデストラクタまでの間、このスレッドの数える先を設定するクラス
+        */
+        class Scope final {
+        public:
+            //! A constructor.
+            /*!
+                唯一のコンストラクタ
+                \param stats 数える先（統計が無効のときは設定しない）
+            */
+            explicit Scope(SolveStats & stats) : pprev_(pcurrent_)
+            {
+                if (SolveStats::enabled()) {
+                    pcurrent_ = &stats;
+                }
+            }
+
+            //! A destructor.
+            /*!
+                数える先を元に戻す
+            */
+            ~Scope()
+            {
+                pcurrent_ = pprev_;
+            }
+
+        private:
+            //! A private member variable (constant).
+            /*!
+                元の数える先
+            */
+            SolveStats * const pprev_;
+
+            //! A private constructor (deleted).
+            /*!
+                デフォルトコンストラクタ（禁止）
+            */
+            Scope() = delete;
+
+            //! A private copy constructor (deleted).
+            /*!
+                コピーコンストラクタ（禁止）
+            */
+            Scope(Scope const &) = delete;
+
+            //! A private member function (deleted).
+            /*!
+                operator=()の宣言（禁止）
+                \param コピー元のオブジェクト（未使用）
+                \return コピー元のオブジェクト
+            */
+            Scope & operator=(Scope const &) = delete;
+        };
+
+        // #endregion クラス内クラスの宣言
+
+        // #region メンバ関数
+
+        //! A public static member function.
+        /*!
+            このスレッドの数える先を返す
+            \return このスレッドの数える先（数えないときはnullptr）
+        */
+        static SolveStats * current()
+        {
+            return pcurrent_;
+        }
+
+        //! A public static member function.
+        /*!
+            統計を数えるかどうかを設定する
+            \param enable 統計を数えるかどうか
+        */
+        static void enable(bool enable)
+        {
+            enabled_.store(enable, std::memory_order_relaxed);
+        }
+
+        //! A public static member function.
+        /*!
+            統計を数えるかどうかを返す
+            \return 統計を数えるかどうか
+        */
+        static bool enabled()
+        {
+            return enabled_.load(std::memory_order_relaxed);
+        }
+
+        //! A public member function.
+        /*!
+            他の統計を足し合わせる
+            \param rhs 足し合わせる統計
+            \return 足し合わせた後の自分自身
+        */
+        SolveStats & operator+=(SolveStats const & rhs);
+
+        //! A public member function (const).
+        /*!
+            統計を一行で表示する
+            \param os 表示先のストリーム
+            \param label 行の先頭に表示する名前
+            \param solves 微分方程式を解いた回数（一回あたりの値を求めるのに使う）
+        */
+        void print(std::ostream & os, char const * label, std::int32_t solves) const;
+
+        // #endregion メンバ関数
+
+        // #region メンバ変数
+
+        //! A public member variable.
+        /*!
+            微分方程式の右辺の評価回数
+        */
+        std::uint64_t derivs = 0;
+
+        //! A public member variable.
+        /*!
+            右辺の評価のうち、ポテンシャルの数表の値を使った回数
+        */
+        std::uint64_t tablehits = 0;
+
+        //! A public member variable.
+        /*!
+            受け入れられたステップ数
+        */
+        std::uint64_t accepted = 0;
+
+        //! A public member variable.
+        /*!
+            刻み幅の制御で棄却されたステップ数
+        */
+        std::uint64_t rejected = 0;
+
+        //! A public member variable.
+        /*!
+            odeintのオブザーバが呼ばれた回数
+        */
+        std::uint64_t observed = 0;
+
+        //! A public member variable.
+        /*!
+            Vhartree::vhartreeの呼び出し回数
+        */
+        std::uint64_t vhartree = 0;
+
+        //! A public member variable.
+        /*!
+            Vhartree::dvhartree_drの呼び出し回数
+        */
+        std::uint64_t dvhartree = 0;
+
+        //! A public member variable.
+        /*!
+            Rho::operator()の呼び出し回数
+        */
+        std::uint64_t rho = 0;
+
+    private:
+        //! A private static member variable.
+        /*!
+            統計を数えるかどうか
+        */
+        static std::atomic<bool> enabled_;
+
+        //! A private static member variable (thread local).
+        /*!
+            このスレッドの数える先
+        */
+        static inline thread_local SolveStats * pcurrent_ = nullptr;
+
+        // #endregion メンバ変数
+    };
+}
+
+#endif  // _SOLVESTATS_H_
@@ -0,0 +1,171 @@
+﻿/*! \file sweeprun.cpp
+    \brief パラメータスキャンを行うクラスの実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "sweeprun.h"
+#include <algorithm>            // for std::max_element, std::sort
+#include <cmath>                // for std::fabs
+#include <cstdio>               // for std::fclose, std::fopen, std::fprintf
+#include <fstream>              // for std::ofstream
+#include <iostream>             // for std::cerr, std::cout
+#include <memory>               // for std::unique_ptr
+#include <optional>             // for std::optional
+#include <stdexcept>            // for std::runtime_error
+#include <boost/format.hpp>     // for boost::format
+
+namespace schrac {
+    // #region staticメンバ変数
+
+    std::string const SweepRun::SUMMARYFILENAME = "sweep_summary.csv";
+
+    // #endregion staticメンバ変数
+
+    // #region コンストラクタ
+
+    SweepRun::SweepRun(std::string const & inpname, std::int32_t jobs, bool usetbb, WaveFunctionSave::Output_type output_type) :
+        dir_(std::filesystem::path(inpname).replace_extension().string() + "_sweep"),
+        jobs_(jobs),
+        output_type_(output_type),
+        sweepset_(ReadInputFile::expandSweep(inpname)),
+        usetbb_(usetbb)
+    {
+    }
+
+    // #endregion コンストラクタ
+
+    // #region publicメンバ関数
+
+    bool SweepRun::operator()()
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+        if (ec) {
+            throw std::runtime_error(dir_.string() + " が作成できませんでした");
+        }
+
+        // ジョブごとのインプットファイルを書き出す
+        std::vector<std::string> joblist;
+        for (auto const & [label, text] : sweepset_.jobs) {
+            auto const inpname = (dir_ / (label + ".inp")).string();
+            std::ofstream ofs(inpname);
+            ofs << text;
+            if (!ofs) {
+                throw std::runtime_error(inpname + " が作成できませんでした");
+            }
+
+            joblist.push_back(inpname);
+        }
+
+        BatchRun br(joblist, jobs_, usetbb_, output_type_, (dir_ / BatchRun::SUMMARYFILENAME).string());
+        auto const ok = br();
+
+        write_summary(br.Results);
+
+        return ok;
+    }
+
+    // #endregion publicメンバ関数
+
+    // #region privateメンバ関数
+
+    void SweepRun::write_summary(std::vector<BatchRun::JobResult> const & results) const
+    {
+        // 精度の基準となる全エネルギーを決める
+        // （指定がなければ、メッシュが最も多く、次に許容誤差が最も小さく、次にメッシュの範囲が最も広い、
+        //   最も精度の高い設定のジョブを基準にする）
+        auto reference = sweepset_.reference;
+        if (!reference) {
+            auto const itr = std::max_element(results.begin(), results.end(), [](auto const & lhs, auto const & rhs) {
+                if (lhs.ok != rhs.ok) {
+                    return !lhs.ok;
+                }
+
+                if (lhs.grid_num != rhs.grid_num) {
+                    return lhs.grid_num < rhs.grid_num;
+                }
+
+                if (lhs.eps != rhs.eps) {
+                    return lhs.eps > rhs.eps;
+                }
+
+                return lhs.xmax - lhs.xmin < rhs.xmax - rhs.xmin;
+            });
+
+            if (itr != results.end() && itr->ok) {
+                reference = itr->Etotal;
+                std::cout << "\n基準のジョブ: " << std::filesystem::path(itr->inpname).stem().string() << std::endl;
+            }
+        }
+
+        if (!reference) {
+            std::cerr << "成功したジョブがないため、精度を評価できません。" << std::endl;
+            return;
+        }
+
+        // 計算時間の短い順に並べる
+        std::vector<std::size_t> order;
+        for (auto i = 0U; i < results.size(); i++) {
+            if (results[i].ok) {
+                order.push_back(i);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&results](auto lhs, auto rhs) {
+            return results[lhs].time < results[rhs].time;
+        });
+
+        std::optional<std::size_t> cheapest(std::nullopt);
+        if (sweepset_.target) {
+            for (auto const i : order) {
+                if (std::fabs(results[i].Etotal - *reference) <= *sweepset_.target) {
+                    cheapest = i;
+                    break;
+                }
+            }
+        }
+
+        std::unique_ptr<FILE, decltype(&fclose)> fp(
+            std::fopen((dir_ / SUMMARYFILENAME).string().c_str(), "w"),
+            fclose);
+
+        if (!fp) {
+            std::cerr << (dir_ / SUMMARYFILENAME).string() << " が作成できませんでした。" << std::endl;
+            return;
+        }
+
+        std::cout << boost::format("\n基準の全エネルギー = %.15f\n") % *reference;
+        std::cout << boost::format("%-60s %-22s %-10s %-5s %-12s %s\n")
+            % "Job" % "Total energy" % "|dE|" % "Iter." % "Time (msec)" % "Peak memory (kB)";
+        std::fputs("Job,Total energy,|dE|,Iterations,Time (msec),Peak memory (kB),Meets target\n", fp.get());
+
+        for (auto const i : order) {
+            auto const & result = results[i];
+            auto const label = std::filesystem::path(result.inpname).stem().string();
+            auto const dE = std::fabs(result.Etotal - *reference);
+            auto const meets = sweepset_.target && dE <= *sweepset_.target;
+
+            std::cout << boost::format("%-60s %-22.15f %-10.3e %-5d %-12.4f %d%s\n")
+                % label % result.Etotal % dE % result.iteration % result.time % result.peakmem
+                % (cheapest && *cheapest == i ? "  <=" : "");
+            std::fprintf(fp.get(), "%s,%.15f,%.3e,%d,%.4f,%u,%s\n",
+                label.c_str(), result.Etotal, dE, result.iteration, result.time, result.peakmem,
+                sweepset_.target ? (meets ? "Yes" : "No") : "");
+        }
+
+        if (sweepset_.target) {
+            if (cheapest) {
+                std::cout << boost::format("\n目標精度 %.3e を満たす最も速い設定: %s\n")
+                    % *sweepset_.target % std::filesystem::path(results[*cheapest].inpname).stem().string();
+            }
+            else {
+                std::cout << boost::format("\n目標精度 %.3e を満たす設定はありませんでした。\n") % *sweepset_.target;
+            }
+        }
+
+        std::cout << '\n' << (dir_ / SUMMARYFILENAME).string() << " に精度と計算時間の一覧を書き込みました。" << std::endl;
+    }
+
+    // #endregion privateメンバ関数
+}
@@ -0,0 +1,137 @@
+﻿/*! \file sweeprun.h
+    \brief パラメータスキャンを行うクラスの宣言
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _SWEEPRUN_H_
+#define _SWEEPRUN_H_
+
+#pragma once
+
+#include "batchrun.h"
+#include "readinputfile.h"
+#include <cstdint>      // for std::int32_t
+#include <filesystem>   // for std::filesystem::path
+#include <string>       // for std::string
+
+namespace schrac {
+    //! A class.
+    /*!
+        パラメータスキャンを行うクラス
+        インプットファイルをReadInputFile::expandSweepでジョブの集合に展開し、
+        インプットファイル名から拡張子を除き「_sweep」を付けたディレクトリに、
+        ジョブごとのインプットファイルを書き出してBatchRunでまとめて実行する
+    */
+    class SweepRun final {
+        // #region コンストラクタ・デストラクタ
+
+    public:
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param inpname パラメータスキャンのインプットファイル名
+            \param jobs 同時に実行するジョブの数（0以下なら自動）
+            \param usetbb 各ジョブの中でもTBBを使用するかどうか
+            \param output_type 波動関数を書き出すファイルの形式
+        */
+        SweepRun(std::string const & inpname, std::int32_t jobs, bool usetbb, WaveFunctionSave::Output_type output_type);
+
+        //! A destructor.
+        /*!
+            デフォルトデストラクタ
+        */
+        ~SweepRun() = default;
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ関数
+
+        //! A public member function.
+        /*!
+            すべてのジョブを実行し、精度と計算時間の一覧を書き出す
+            \return すべてのジョブが成功したかどうか
+        */
+        bool operator()();
+
+    private:
+        //! A private member function (const).
+        /*!
+            精度と計算時間の一覧を表示し、ファイルに書き出す
+            sweep.referenceが指定されていなければ、最も計算時間のかかったジョブの全エネルギーを基準とする
+            \param results ジョブの結果の可変長配列
+        */
+        void write_summary(std::vector<BatchRun::JobResult> const & results) const;
+
+        // #endregion メンバ関数
+
+        // #region メンバ変数
+
+    public:
+        //! A public static member variable (constant).
+        /*!
+            精度と計算時間の一覧を書き出すファイル名
+        */
+        static std::string const SUMMARYFILENAME;
+
+    private:
+        //! A private member variable (constant).
+        /*!
+            ジョブごとのインプットファイルと結果を書き出すディレクトリ
+        */
+        std::filesystem::path const dir_;
+
+        //! A private member variable (constant).
+        /*!
+            同時に実行するジョブの数
+        */
+        std::int32_t const jobs_;
+
+        //! A private member variable (constant).
+        /*!
+            波動関数を書き出すファイルの形式
+        */
+        WaveFunctionSave::Output_type const output_type_;
+
+        //! A private member variable (constant).
+        /*!
+            展開したジョブの集合
+        */
+        ReadInputFile::SweepSet const sweepset_;
+
+        //! A private member variable (constant).
+        /*!
+            各ジョブの中でもTBBを使用するかどうか
+        */
+        bool const usetbb_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        SweepRun() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        SweepRun(SweepRun const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        SweepRun & operator=(SweepRun const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _SWEEPRUN_H_
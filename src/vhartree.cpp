@@ -6,52 +6,65 @@
 */
 
 #include "vhartree.h"
+#include "solvestats.h"
 #include <array>                // for std::array
+#include <cmath>                // for std::log
 #include <boost/assert.hpp>     // for BOOST_ASSERT
 
 namespace schrac {
     // #region コンストラクタ
     
     Vhartree::Vhartree(std::vector<double> const & r_mesh) :
-        Vhart([this]{ return std::cref(vhart_); }, [this](std::vector<double> const & v) { return vhart_ = v; }),
-        acc_(gsl_interp_accel_alloc(), gsl_interp_accel_free),
-        r_mesh_(r_mesh),
-        spline_(gsl_spline_alloc(gsl_interp_cspline, r_mesh.size()), gsl_spline_free)
+        Vhart([this]{ return std::cref(vhart_); }, [this](std::vector<double> const & v) { return std::cref(vhart_ = v); }),
+        ispline_(r_mesh),
+        r_mesh_(r_mesh)
     {
         vhart_.reserve(r_mesh.size());
     }
 
-    Vhartree::Vhartree(Vhartree const & rhs) :
-        Vhartree(rhs.r_mesh_)
-    {
-        vhart_ = rhs.vhart_;
-        gsl_spline_init(spline_.get(), r_mesh_.data(), vhart_.data(), r_mesh_.size());
-    }
-
     // #endregion コンストラクタ
 
     // #region publicメンバ関数
 
     double Vhartree::dvhartree_dr(double r) const
     {
-        return gsl_spline_eval_deriv(spline_.get(), r, acc_.get());
+        return dvhartree_dr(index(std::log(r)), r);
     }
 
-    void Vhartree::set_vhartree_boundary_condition(double Z)
+    double Vhartree::dvhartree_dr(std::size_t i, double r) const
     {
+        if (auto const pstats = SolveStats::current()) {
+            pstats->dvhartree++;
+        }
+
+        return ispline_.deriv(i, r);
+    }
+
+    void Vhartree::set_vhartree_boundary_condition(double Q)
+    {
+        auto const shift = Q / r_mesh_.back() - vhart_.back();
         for (auto && v : vhart_) {
-            v += (Z / r_mesh_.back() - vhart_.back());
+            v += shift;
         }
     }
 
-    void Vhartree::vhart_init()
+    void Vhartree::vhart_init(checkpoint::Arena & arena)
     {
-        gsl_spline_init(spline_.get(), r_mesh_.data(), vhart_.data(), r_mesh_.size());
+        ispline_.init(vhart_, arena);
     }
 
     double Vhartree::vhartree(double r) const
     {
-        return gsl_spline_eval(spline_.get(), r, acc_.get());
+        return vhartree(index(std::log(r)), r);
+    }
+
+    double Vhartree::vhartree(std::size_t i, double r) const
+    {
+        if (auto const pstats = SolveStats::current()) {
+            pstats->vhartree++;
+        }
+
+        return ispline_(i, r);
     }
 
     // #endregion publicメンバ関数
@@ -11,14 +11,15 @@
 #pragma once
 
 #include "diffdata.h"
+#include "indexedspline.h"
 #include "property.h"
-#include <memory>           // for std::unique_ptr
-#include <gsl/gsl_spline.h> // for gsl_interp_accel, gsl_interp_accel_free, gsl_spline, gsl_spline_free
+#include <vector>           // for std::vector
 
 namespace schrac {
     //! A class.
     /*!
         Hartreeポテンシャルを求めるクラス
+        値の評価はconstで内部の状態を書き換えないので、複数のスレッドから同時に呼び出してよい
     */
     class Vhartree final {
         // #region コンストラクタ・デストラクタ
@@ -31,12 +32,6 @@ namespace schrac {
         */
         Vhartree(std::vector<double> const & r_mesh);
 
-        //! A private copy constructor.
-        /*!
-            コピーコンストラクタ
-        */
-        Vhartree(Vhartree const & rhs);
-
         //! A destructor.
         /*!
             デフォルトデストラクタ
@@ -53,18 +48,39 @@ namespace schrac {
         */
         double dvhartree_dr(double r) const;
 
+        //!  A public member function (const).
+        /*!
+            rを含む区間の添字を指定して、Hartreeポテンシャルの微分値を返す（区間を探さない）
+            \param i rを含むメッシュの区間[r_i, r_(i + 1)]の添字
+            \param r 極座標のr
+            \return Hartreeポテンシャルの微分値
+        */
+        double dvhartree_dr(std::size_t i, double r) const;
+
+        //!  A public member function (const).
+        /*!
+            x = log(r)を含むメッシュの区間の添字を返す
+            \param x xの値
+            \return 区間の添字
+        */
+        std::size_t index(double x) const
+        {
+            return ispline_.index(x);
+        }
+
         //!  A public member function.
         /*!
             Hartreeポテンシャルが境界条件を満たすようにセットする
-            \param Z 原子核の電荷
+            \param Q 電子密度の全電荷
         */
-        void set_vhartree_boundary_condition(double Z);
+        void set_vhartree_boundary_condition(double Q);
 
         //!  A public member function.
         /*!
             Hartreeポテンシャルを初期化する
+            \param arena スプライン補間の係数を求めるときの作業用の配列を確保するアリーナ
         */
-        void vhart_init();
+        void vhart_init(checkpoint::Arena & arena);
 
         //!  A public member function (const).
         /*!
@@ -74,6 +90,15 @@ namespace schrac {
         */
         double vhartree(double r) const;
 
+        //!  A public member function (const).
+        /*!
+            rを含む区間の添字を指定して、Hartreeポテンシャルの値を返す（区間を探さない）
+            \param i rを含むメッシュの区間[r_i, r_(i + 1)]の添字
+            \param r 極座標のr
+            \return Hartreeポテンシャルの値
+        */
+        double vhartree(std::size_t i, double r) const;
+
         // #endregion メンバ関数
 
         // #region プロパティ
@@ -81,9 +106,9 @@ namespace schrac {
     public:
         //! A property.
         /*!
-            Hartreeポテンシャルが格納された可変長配列へのプロパティ
+            Hartreeポテンシャルが格納された可変長配列へのプロパティ（コピーせずに参照を返す）
         */
-        Property<std::vector<double>> Vhart;
+        Property<std::vector<double> const &> Vhart;
 
         // #endregion プロパティ
 
@@ -92,9 +117,9 @@ namespace schrac {
     private:
         //! A private member variable.
         /*!
-            gsl_interp_accelへのスマートポインタ
+            区間の添字を指定して評価するためのスプライン補間の係数
         */
-        std::unique_ptr<gsl_interp_accel, decltype(&gsl_interp_accel_free)> const acc_;
+        IndexedSpline ispline_;
         
         //! A private member variable.
         /*!
@@ -102,12 +127,6 @@ namespace schrac {
         */
         std::vector<double> const r_mesh_;
 
-        //! A private member variable.
-        /*!
-            gsl_interp_typeへのスマートポインタ
-        */
-        std::unique_ptr<gsl_spline, decltype(&gsl_spline_free)> const spline_;
-
         //! A private member variable.
         /*!
             Hartreeポテンシャルが格納された可変長配列
@@ -125,6 +144,12 @@ namespace schrac {
         */
         Vhartree() = delete;
 
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        Vhartree(Vhartree const &) = delete;
+
         //! A private member function (deleted).
         /*!
             operator=()の宣言（禁止）
@@ -6,16 +6,136 @@
 */
 
 #include "wavefunctionsave.h"
-#include <cstdlib>              // for std::fclose, std::fprintf
+#include <algorithm>            // for std::copy_n, std::min
+#include <cstdio>               // for std::fclose, std::fopen, std::fprintf, std::fread, std::fseek, std::fwrite
+#include <cstring>              // for std::memcmp, std::strncpy
 #include <iostream>             // for std::cerr
+#include <system_error>         // for std::error_code
+#include <boost/cast.hpp>       // for boost::numeric_cast
 
 namespace schrac {
-    WaveFunctionSave::WaveFunctionSave(boost::container::flat_map<std::string, std::vector<double>> const & wf, std::shared_ptr<Data> const & pdata) :
+    // #region staticメンバ変数
+
+    char const WaveFunctionSave::BINARY_MAGIC[8] = { 'S', 'C', 'H', 'R', 'A', 'C', 'W', 'F' };
+
+    static_assert(sizeof(WaveFunctionSave::BinaryHeader) == 128, "BinaryHeader must be 128 bytes");
+    static_assert(sizeof(WaveFunctionSave::ColumnHeader) == 64, "ColumnHeader must be 64 bytes");
+
+    // #endregion staticメンバ変数
+
+    // #region コンストラクタ
+
+    WaveFunctionSave::WaveFunctionSave(boost::container::flat_map<std::string, std::vector<double>> const & wf, std::shared_ptr<Data> const & pdata, Output_type output_type, std::filesystem::path const & outdir) :
+        output_type_(output_type),
+        outdir_(outdir),
         wf_(wf),
         pdata_(pdata)
     {
     }
-    
+
+    // #endregion コンストラクタ
+
+    // #region publicメンバ関数
+
+    bool WaveFunctionSave::convert(std::string const & filename)
+    {
+        std::unique_ptr<FILE, decltype(&fclose)> fp(
+            std::fopen(filename.c_str(), "rb"),
+            fclose);
+
+        if (!fp) {
+            std::cerr << filename << " が開けませんでした。" << std::endl;
+            return false;
+        }
+
+        BinaryHeader header;
+        if (std::fread(&header, sizeof(BinaryHeader), 1, fp.get()) != 1 ||
+            std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) ||
+            header.version != BINARY_VERSION) {
+            std::cerr << filename << " は波動関数のバイナリファイルではありません。" << std::endl;
+            return false;
+        }
+
+        if (header.endian != BINARY_ENDIAN) {
+            std::cerr << filename << " はバイトオーダーの異なる計算機で書き込まれています。" << std::endl;
+            return false;
+        }
+
+        // ヘッダの数を信じて確保する前に、ファイルの大きさと合っているかを確かめる
+        std::error_code ec;
+        auto const filesize = std::filesystem::file_size(filename, ec);
+        if (ec ||
+            filesize < sizeof(BinaryHeader) ||
+            header.columnnum > (filesize - sizeof(BinaryHeader)) / sizeof(ColumnHeader) ||
+            header.size > filesize / sizeof(double)) {
+            std::cerr << filename << " は壊れています。" << std::endl;
+            return false;
+        }
+
+        std::vector<ColumnHeader> columns(boost::numeric_cast<std::size_t>(header.columnnum));
+        if (std::fread(columns.data(), sizeof(ColumnHeader), columns.size(), fp.get()) != columns.size()) {
+            std::cerr << filename << " の読み込みに失敗しました。" << std::endl;
+            return false;
+        }
+
+        // 各列のデータがファイルの中に収まっているかを確かめる
+        for (auto const & column : columns) {
+            if (column.offset > filesize || header.size > (filesize - column.offset) / sizeof(double)) {
+                std::cerr << filename << " は壊れています。" << std::endl;
+                return false;
+            }
+        }
+
+        boost::container::flat_map<std::string, std::vector<double>> wf;
+        for (auto const & column : columns) {
+            std::vector<double> v(boost::numeric_cast<std::size_t>(header.size));
+            if (std::fseek(fp.get(), boost::numeric_cast<long>(column.offset), SEEK_SET) ||
+                std::fread(v.data(), sizeof(double), v.size(), fp.get()) != v.size()) {
+                std::cerr << filename << " の読み込みに失敗しました。" << std::endl;
+                return false;
+            }
+
+            wf.emplace(std::string(column.name, std::find(column.name, column.name + sizeof(column.name), '\0')), std::move(v));
+        }
+
+        auto const pdata = std::make_shared<Data>();
+        pdata->chemical_symbol_ = std::string(header.chemical_symbol, std::find(header.chemical_symbol, header.chemical_symbol + sizeof(header.chemical_symbol), '\0'));
+        pdata->eq_type_ = static_cast<Data::Eq_type>(header.eq_type);
+        pdata->grid_num_ = header.grid_num;
+        pdata->j_ = header.j;
+        pdata->kappa_ = header.kappa;
+        pdata->l_ = boost::numeric_cast<std::uint8_t>(header.l);
+        pdata->n_ = boost::numeric_cast<std::uint8_t>(header.n);
+        pdata->orbital_ = std::string(header.orbital, std::find(header.orbital, header.orbital + sizeof(header.orbital), '\0'));
+        pdata->spin_orbital_ = ci_string(header.spin_orbital, std::find(header.spin_orbital, header.spin_orbital + sizeof(header.spin_orbital), '\0'));
+        pdata->xmax_ = header.xmax;
+        pdata->xmin_ = header.xmin;
+        pdata->Z_ = header.Z;
+
+        return WaveFunctionSave(wf, pdata, Output_type::CSV)();
+    }
+
+    bool WaveFunctionSave::operator()()
+    {
+        switch (output_type_) {
+        case Output_type::BINARY:
+            return save_binary();
+            break;
+
+        case Output_type::CSV:
+            return save_csv();
+            break;
+
+        default:
+            BOOST_ASSERT(!"何かがおかしい！");
+            return false;
+        }
+    }
+
+    // #endregion publicメンバ関数
+
+    // #region privateメンバ関数
+
     std::optional<std::string> WaveFunctionSave::get_spin_orbital() const
     {
         switch (pdata_->eq_type_) {
@@ -39,12 +159,8 @@ namespace schrac {
         }
     }
 
-    std::tuple<std::string, std::string, std::string> WaveFunctionSave::make_filename() const
+    std::string WaveFunctionSave::make_basename() const
     {
-        auto waveffilename("wavefunction_");
-        auto rhofilename("rho_");
-        auto wffilename("wf_");
-
         auto filename = pdata_->chemical_symbol_ + '_';
         filename += pdata_->orbital_.c_str();
 
@@ -53,12 +169,96 @@ namespace schrac {
             filename += '_' + *pspin_orbital;
         }
 
-        filename += ".csv";
+        return filename;
+    }
 
-        return std::forward_as_tuple(waveffilename + filename, rhofilename + filename, wffilename + filename);
+    std::tuple<std::string, std::string, std::string> WaveFunctionSave::make_filename() const
+    {
+        auto waveffilename("wavefunction_");
+        auto rhofilename("rho_");
+        auto wffilename("wf_");
+
+        auto const filename = make_basename() + ".csv";
+
+        return std::make_tuple(
+            (outdir_ / (waveffilename + filename)).string(),
+            (outdir_ / (rhofilename + filename)).string(),
+            (outdir_ / (wffilename + filename)).string());
     }
 
-    bool WaveFunctionSave::operator()()
+    bool WaveFunctionSave::save_binary() const
+    {
+        auto const filename = (outdir_ / ("wavefunction_" + make_basename() + ".bin")).string();
+
+        std::unique_ptr<FILE, decltype(&fclose)> fp(
+            std::fopen(filename.c_str(), "wb"),
+            fclose);
+
+        if (!fp) {
+            std::cerr << "波動関数のファイルが作成できませんでした。" << std::endl;
+            return false;
+        }
+
+        BinaryHeader header = {};
+        std::copy_n(BINARY_MAGIC, sizeof(BINARY_MAGIC), header.magic);
+        header.version = BINARY_VERSION;
+        header.endian = BINARY_ENDIAN;
+        header.size = wf_.begin()->second.size();
+        header.columnnum = wf_.size();
+        header.eq_type = static_cast<std::int32_t>(pdata_->eq_type_);
+        header.grid_num = pdata_->grid_num_;
+        header.n = pdata_->n_;
+        header.l = pdata_->l_;
+        header.Z = pdata_->Z_;
+        if (pdata_->eq_type_ != Data::Eq_type::SCH) {
+            header.j = pdata_->j_;
+            header.kappa = pdata_->kappa_;
+        }
+        header.xmin = pdata_->xmin_;
+        header.xmax = pdata_->xmax_;
+        std::strncpy(header.chemical_symbol, pdata_->chemical_symbol_.c_str(), sizeof(header.chemical_symbol) - 1);
+        std::strncpy(header.orbital, pdata_->orbital_.c_str(), sizeof(header.orbital) - 1);
+        if (pdata_->eq_type_ == Data::Eq_type::DIRAC) {
+            std::strncpy(header.spin_orbital, pdata_->spin_orbital_.c_str(), sizeof(header.spin_orbital) - 1);
+        }
+
+        // 各列のデータの位置を、BINARY_ALIGNの倍数に揃えて決める
+        auto const align = [](std::uint64_t pos) { return (pos + BINARY_ALIGN - 1) / BINARY_ALIGN * BINARY_ALIGN; };
+        std::vector<ColumnHeader> columns(wf_.size());
+        auto pos = align(sizeof(BinaryHeader) + sizeof(ColumnHeader) * columns.size());
+        auto itr(wf_.begin());
+        for (auto & column : columns) {
+            BOOST_ASSERT(itr->first.size() < sizeof(column.name));
+            BOOST_ASSERT(itr->second.size() == header.size);
+
+            std::fill(std::begin(column.name), std::end(column.name), '\0');
+            std::copy_n(itr->first.c_str(), std::min(itr->first.size(), sizeof(column.name) - 1), column.name);
+            column.offset = pos;
+            pos = align(pos + sizeof(double) * header.size);
+            ++itr;
+        }
+
+        auto ok = std::fwrite(&header, sizeof(BinaryHeader), 1, fp.get()) == 1 &&
+                  std::fwrite(columns.data(), sizeof(ColumnHeader), columns.size(), fp.get()) == columns.size();
+
+        itr = wf_.begin();
+        for (auto const & column : columns) {
+            ok = ok && !std::fseek(fp.get(), boost::numeric_cast<long>(column.offset), SEEK_SET) &&
+                 std::fwrite(itr->second.data(), sizeof(double), itr->second.size(), fp.get()) == itr->second.size();
+            ++itr;
+        }
+
+        if (!ok) {
+            std::cerr << "波動関数のファイルへの書き込みに失敗しました。" << std::endl;
+            return false;
+        }
+
+        *pdata_->pout_ << filename << " に波動関数を書き込みました。" << std::endl;
+
+        return true;
+    }
+
+    bool WaveFunctionSave::save_csv() const
     {
         auto [waveffilename, rhofilename, wffilename] = make_filename();
 
@@ -95,6 +295,11 @@ namespace schrac {
         }
         std::fputs("\n", waveffp.get());
         
+        // 行ごとに文字列で検索しないように、列を先に取り出しておく
+        auto const & mesh(wf_.at("1 Mesh (r)"));
+        auto const & eigen(wf_.at("2 Eigen function"));
+        auto const & rho(wf_.at("3 Rho (mutiplied 4 * pi * r ** 2)"));
+
         auto const size = wf_.begin()->second.size();
         for (auto i = 0U; i < size; i++) {
             for (auto itr(wf_.begin()); itr != end; ++itr) {
@@ -102,18 +307,20 @@ namespace schrac {
             }
             std::fputs("\n", waveffp.get());
 
-            std::fprintf(rhofp.get(), "%.15f,", wf_["1 Mesh (r)"][i]);
-            std::fprintf(rhofp.get(), "%.15f\n", wf_["3 Rho (mutiplied 4 * pi * r ** 2)"][i]);
+            std::fprintf(rhofp.get(), "%.15f,", mesh[i]);
+            std::fprintf(rhofp.get(), "%.15f\n", rho[i]);
 
-            std::fprintf(wffp.get(), "%.15f,", wf_["1 Mesh (r)"][i]);
-            std::fprintf(wffp.get(), "%.15f\n", wf_["2 Eigen function"][i]);
+            std::fprintf(wffp.get(), "%.15f,", mesh[i]);
+            std::fprintf(wffp.get(), "%.15f\n", eigen[i]);
         }
 
-        std::cout << waveffilename << " に波動関数を、 " << rhofilename
+        *pdata_->pout_ << waveffilename << " に波動関数を、 " << rhofilename
             << " に電子密度を、" << wffilename
             << " に動径波動関数を書き込みました。"
             << std::endl;
 
         return true;
     }
+
+    // #endregion privateメンバ関数
 }
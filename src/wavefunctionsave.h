@@ -11,8 +11,11 @@
 #pragma once
 
 #include "data.h"
+#include <cstdint>                      // for std::int32_t, std::uint32_t, std::uint64_t
+#include <filesystem>                   // for std::filesystem::path
 #include <memory>                       // for std::shared_ptr
 #include <optional>						// for std::optional
+#include <string>                       // for std::string
 #include <tuple>                        // for std::tuple
 #include <vector>                       // for std::vector
 #include <boost/container/flat_map.hpp> // for boost::container::flat_map
@@ -23,16 +26,173 @@ namespace schrac {
         得られた波動関数をファイルに書き出すクラス
     */
     class WaveFunctionSave final {
-        // #region コンストラクタ・デストラクタ
+        // #region 列挙型
 
     public:
+        //!  A enumerated type
+        /*!
+            出力ファイルの形式を表す列挙型
+        */
+        enum class Output_type {
+            // バイナリ形式
+            BINARY,
+            // CSV形式
+            CSV
+        };
+
+        // #endregion 列挙型
+
+        // #region 構造体
+
+        //! A struct.
+        /*!
+            バイナリ形式のファイルの先頭に置かれるヘッダ
+            ファイルは、このヘッダ、columnnum個のColumnHeader、各列のデータの順に並ぶ
+            各列のデータはdouble型がsize個連続したもので、ファイル先頭から
+            BINARY_ALIGN（バイト）の倍数の位置に置かれるので、mmapしてそのまま参照できる
+            数値はすべて書き込んだ計算機のバイトオーダーで格納される（endianで判別する）
+        */
+        struct BinaryHeader final {
+            //! A public member variable.
+            /*!
+                ファイルの識別子（"SCHRACWF"）
+            */
+            char magic[8];
+
+            //! A public member variable.
+            /*!
+                ファイル形式のバージョン
+            */
+            std::uint32_t version;
+
+            //! A public member variable.
+            /*!
+                バイトオーダーの判別用の値（BINARY_ENDIAN）
+            */
+            std::uint32_t endian;
+
+            //! A public member variable.
+            /*!
+                一つの列に含まれるデータの数
+            */
+            std::uint64_t size;
+
+            //! A public member variable.
+            /*!
+                列の数
+            */
+            std::uint64_t columnnum;
+
+            //! A public member variable.
+            /*!
+                解いた方程式のタイプ（Data::Eq_typeの値）
+            */
+            std::int32_t eq_type;
+
+            //! A public member variable.
+            /*!
+                メッシュの数
+            */
+            std::int32_t grid_num;
+
+            //! A public member variable.
+            /*!
+                主量子数
+            */
+            std::int32_t n;
+
+            //! A public member variable.
+            /*!
+                方位量子数
+            */
+            std::int32_t l;
+
+            //! A public member variable.
+            /*!
+                原子核の電荷
+            */
+            double Z;
+
+            //! A public member variable.
+            /*!
+                全角運動量（Schrödinger方程式の場合は0）
+            */
+            double j;
+
+            //! A public member variable.
+            /*!
+                量子数κ（Schrödinger方程式の場合は0）
+            */
+            double kappa;
+
+            //! A public member variable.
+            /*!
+                メッシュの最小値
+            */
+            double xmin;
+
+            //! A public member variable.
+            /*!
+                メッシュの最大値
+            */
+            double xmax;
+
+            //! A public member variable.
+            /*!
+                元素記号（ヌル終端）
+            */
+            char chemical_symbol[8];
+
+            //! A public member variable.
+            /*!
+                計算対象の軌道（ヌル終端）
+            */
+            char orbital[8];
+
+            //! A public member variable.
+            /*!
+                スピン軌道（ヌル終端、Dirac方程式以外は空文字列）
+            */
+            char spin_orbital[8];
+
+            //! A public member variable.
+            /*!
+                予約領域（0で埋める）
+            */
+            char reserved[16];
+        };
+
+        //! A struct.
+        /*!
+            バイナリ形式のファイルの、各列の情報
+        */
+        struct ColumnHeader final {
+            //! A public member variable.
+            /*!
+                列の名前（ヌル終端）
+            */
+            char name[56];
+
+            //! A public member variable.
+            /*!
+                列のデータのファイル先頭からの位置（バイト）
+            */
+            std::uint64_t offset;
+        };
+
+        // #endregion 構造体
+
+        // #region コンストラクタ・デストラクタ
+
         //! A constructor.
         /*!
             唯一のコンストラクタ
             \param pdata データオブジェクト
             \param wf 波動関数が格納されたハッシュ
+            \param output_type 出力ファイルの形式
+            \param outdir ファイルを書き出すディレクトリ（空ならカレントディレクトリ）
         */
-        WaveFunctionSave(boost::container::flat_map<std::string, std::vector<double>> const & wf, std::shared_ptr<Data> const & pdata);
+        WaveFunctionSave(boost::container::flat_map<std::string, std::vector<double>> const & wf, std::shared_ptr<Data> const & pdata, Output_type output_type = Output_type::CSV, std::filesystem::path const & outdir = std::filesystem::path());
 
         //! A destructor.
         /*!
@@ -43,7 +203,7 @@ namespace schrac {
         // #endregion コンストラクタ・デストラクタ
 
         // #region メンバ関数
-    
+
     private:
         //!  A private member function.
         /*!
@@ -52,6 +212,13 @@ namespace schrac {
         */
         std::optional<std::string> get_spin_orbital() const;
 
+        //!  A private member function.
+        /*!
+            ファイル名の共通部分（"He_1s"など）を生成する関数
+            \return ファイル名の共通部分
+        */
+        std::string make_basename() const;
+
         //!  A private member function.
         /*!
             ファイル名を生成する関数
@@ -59,7 +226,29 @@ namespace schrac {
         */
         std::tuple<std::string, std::string, std::string> make_filename() const;
 
+        //!  A private member function.
+        /*!
+            バイナリ形式のファイルを書き出す関数
+            \return ファイル出力処理が成功したかどうか
+        */
+        bool save_binary() const;
+
+        //!  A private member function.
+        /*!
+            CSV形式のファイルを書き出す関数
+            \return ファイル出力処理が成功したかどうか
+        */
+        bool save_csv() const;
+
     public:
+        //!  A public static member function.
+        /*!
+            バイナリ形式のファイルを読み込み、CSV形式のファイルに変換する
+            \param filename バイナリ形式のファイル名
+            \return 変換に成功したかどうか
+        */
+        static bool convert(std::string const & filename);
+
         //!  A public member function.
         /*!
             実際にファイル出力処理を実行する関数
@@ -69,9 +258,46 @@ namespace schrac {
 
         // #endregion メンバ関数
 
-    private:
         // #region メンバ変数
-        
+
+    public:
+        //!  A public static member variable (constant expression).
+        /*!
+            バイナリ形式のファイルで、各列のデータの位置を揃える単位（バイト）
+        */
+        static std::uint64_t constexpr BINARY_ALIGN = 64;
+
+        //!  A public static member variable (constant expression).
+        /*!
+            バイトオーダーの判別用の値
+        */
+        static std::uint32_t constexpr BINARY_ENDIAN = 0x01020304;
+
+        //!  A public static member variable (constant expression).
+        /*!
+            バイナリ形式のファイルのバージョン
+        */
+        static std::uint32_t constexpr BINARY_VERSION = 1;
+
+    private:
+        //!  A private static member variable (constant).
+        /*!
+            バイナリ形式のファイルの識別子
+        */
+        static char const BINARY_MAGIC[8];
+
+        //!  A private member variable.
+        /*!
+            出力ファイルの形式
+        */
+        Output_type const output_type_;
+
+        //!  A private member variable.
+        /*!
+            ファイルを書き出すディレクトリ
+        */
+        std::filesystem::path const outdir_;
+
         //!  A private member variable.
         /*!
             波動関数が格納されたboost::container::flat_map
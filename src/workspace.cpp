@@ -0,0 +1,52 @@
+﻿/*! \file workspace.cpp
+    \brief メッシュ上の関数を格納する作業領域を使い回すクラスの実装
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "workspace.h"
+#include <utility>  // for std::move
+
+namespace schrac {
+    // #region コンストラクタ
+
+    Workspace::Workspace(std::size_t size) :
+        size_(size)
+    {
+        free_.reserve(RESERVE);
+    }
+
+    // #endregion コンストラクタ
+
+    // #region publicメンバ関数
+
+    std::vector<double> Workspace::acquire()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        if (free_.empty()) {
+            return std::vector<double>(size_);
+        }
+
+        auto v = std::move(free_.back());
+        free_.pop_back();
+
+        return v;
+    }
+
+    void Workspace::release(std::vector<double> && v)
+    {
+        if (v.capacity() < size_) {
+            return;
+        }
+
+        // 容量は足りているので、大きさを戻してもヒープは確保しない
+        v.resize(size_);
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        free_.push_back(std::move(v));
+    }
+
+    // #endregion publicメンバ関数
+}
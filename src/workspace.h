@@ -0,0 +1,116 @@
+﻿/*! \file workspace.h
+    \brief メッシュ上の関数を格納する作業領域を使い回すクラスの宣言
+
+    Copyright © 2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _WORKSPACE_H_
+#define _WORKSPACE_H_
+
+#pragma once
+
+#include <cstddef>  // for std::size_t
+#include <mutex>    // for std::mutex
+#include <vector>   // for std::vector
+
+namespace schrac {
+    //! A class.
+    /*!
+        メッシュの点の数と同じ大きさのstd::vector<double>を貸し出し、返却されたものを次の貸し出しで使い回すクラス
+        SCFの一回の実行につき一つ作り、正規化やSCFのループの各段階で使う配列をここから借りることで、
+        エネルギーやSCFのループを変えるたびにヒープを確保し直さないようにする
+    */
+    class Workspace final {
+        // #region コンストラクタ・デストラクタ
+
+    public:
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param size 貸し出す配列の大きさ（メッシュの点の数）
+        */
+        explicit Workspace(std::size_t size);
+
+        //! A destructor.
+        /*!
+            デフォルトデストラクタ
+        */
+        ~Workspace() = default;
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ関数
+
+        //! A public member function.
+        /*!
+            配列を借りる（中身は不定で、返却されたものがなければ新しく確保する）
+            \return 大きさがsizeの配列
+        */
+        std::vector<double> acquire();
+
+        //! A public member function.
+        /*!
+            借りた配列を返却する（ムーブ済みなど、大きさが足りないものは捨てる）
+            \param v 返却する配列
+        */
+        void release(std::vector<double> && v);
+
+        // #endregion メンバ関数
+
+        // #region メンバ変数
+
+    private:
+        //! A private static member variable (constant expression).
+        /*!
+            返却された配列を保持する領域の、最初に確保しておく大きさ
+        */
+        static std::size_t constexpr RESERVE = 16;
+
+        //! A private member variable.
+        /*!
+            返却された配列
+        */
+        std::vector<std::vector<double>> free_;
+
+        //! A private member variable.
+        /*!
+            貸し出しと返却を排他制御するミューテックス
+        */
+        std::mutex mtx_;
+
+        //! A private member variable (constant).
+        /*!
+            貸し出す配列の大きさ
+        */
+        std::size_t const size_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        Workspace() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        Workspace(Workspace const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        Workspace & operator=(Workspace const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _WORKSPACE_H_
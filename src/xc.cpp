@@ -0,0 +1,74 @@
+﻿/*! \file xc.cpp
+    \brief 局所密度近似の交換相関ポテンシャルを求めるクラスの実装
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#include "xc.h"
+#include "checkpoint/profiler.h"
+#include <cmath>                                // for std::cbrt, std::log, std::sqrt
+#include <boost/assert.hpp>                     // for BOOST_ASSERT
+#include <boost/math/constants/constants.hpp>   // for boost::math::constants
+
+namespace schrac {
+    // #region コンストラクタ
+
+    Xc::Xc(std::size_t size) :
+        Exc([this]{ return std::cref(exc_); }, nullptr),
+        Vxc([this]{ return std::cref(vxc_); }, nullptr),
+        exc_(size),
+        vxc_(size)
+    {
+    }
+
+    // #endregion コンストラクタ
+
+    // #region publicメンバ関数
+
+    void Xc::operator()(dvector const & rho)
+    {
+        CHECKPOINT_SCOPE("Xc");
+
+        using namespace boost::math::constants;
+
+        BOOST_ASSERT(rho.size() == exc_.size());
+
+        // εx = -(3 / 4) * (9 / (4π^2))^(1 / 3) / rs
+        auto const cx = -0.75 * std::cbrt(9.0 / (4.0 * pi_sqr<double>()));
+
+        auto const size = rho.size();
+        for (auto i = 0U; i < size; i++) {
+            if (rho[i] < Xc::RHOMIN) {
+                exc_[i] = 0.0;
+                vxc_[i] = 0.0;
+                continue;
+            }
+
+            // ρ(r)はr^2をかけて積分すると電子の数になるので、電子密度はn = ρ / (4π)となり、rs = (3 / (4πn))^(1 / 3) = (3 / ρ)^(1 / 3)
+            auto const rs = std::cbrt(3.0 / rho[i]);
+
+            auto const ex = cx / rs;
+            auto const vx = 4.0 / 3.0 * ex;
+
+            double ec, vc;
+            if (rs < 1.0) {
+                auto const lnrs = std::log(rs);
+                ec = Xc::PZ_A * lnrs + Xc::PZ_B + Xc::PZ_C * rs * lnrs + Xc::PZ_D * rs;
+                vc = Xc::PZ_A * lnrs + (Xc::PZ_B - Xc::PZ_A / 3.0) +
+                     2.0 / 3.0 * Xc::PZ_C * rs * lnrs + (2.0 * Xc::PZ_D - Xc::PZ_C) / 3.0 * rs;
+            }
+            else {
+                auto const sqrtrs = std::sqrt(rs);
+                auto const denominator = 1.0 + Xc::PZ_BETA1 * sqrtrs + Xc::PZ_BETA2 * rs;
+                ec = Xc::PZ_GAMMA / denominator;
+                vc = ec * (1.0 + 7.0 / 6.0 * Xc::PZ_BETA1 * sqrtrs + 4.0 / 3.0 * Xc::PZ_BETA2 * rs) / denominator;
+            }
+
+            exc_[i] = ex + ec;
+            vxc_[i] = vx + vc;
+        }
+    }
+
+    // #endregion publicメンバ関数
+}
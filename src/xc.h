@@ -0,0 +1,166 @@
+﻿/*! \file xc.h
+    \brief 局所密度近似の交換相関ポテンシャルを求めるクラスの宣言
+
+    Copyright ©  2015 @dc1394 All Rights Reserved.
+    This software is released under the BSD 2-Clause License.
+*/
+
+#ifndef _XC_H_
+#define _XC_H_
+
+#pragma once
+
+#include "property.h"
+#include <cstddef>          // for std::size_t
+#include <vector>           // for std::vector
+
+namespace schrac {
+    //! A class.
+    /*!
+        局所密度近似（LDA）の交換相関エネルギー密度と交換相関ポテンシャルを、メッシュ上でまとめて求めるクラス
+        交換はSlaterの交換、相関はPerdew-Zunger（1981）のパラメータ化を使い、スピン分極は考えない
+    */
+    class Xc final {
+        // #region 型エイリアス
+
+        using dvector = std::vector<double>;
+
+        // #endregion 型エイリアス
+
+        // #region コンストラクタ・デストラクタ
+
+    public:
+        //! A constructor.
+        /*!
+            唯一のコンストラクタ
+            \param size メッシュの点の数
+        */
+        explicit Xc(std::size_t size);
+
+        //! A destructor.
+        /*!
+            デフォルトデストラクタ
+        */
+        ~Xc() = default;
+
+        // #endregion コンストラクタ・デストラクタ
+
+        // #region メンバ関数
+
+        //! A public member function.
+        /*!
+            全電子の密度から、メッシュのすべての点の交換相関エネルギー密度と交換相関ポテンシャルを求める
+            \param rho 全電子の密度ρ(r)（∫ρ(r)r^2drが電子の数になるように規格化されたもの）
+        */
+        void operator()(dvector const & rho);
+
+        // #endregion メンバ関数
+
+        // #region プロパティ
+
+        //! A property.
+        /*!
+            電子一つ当たりの交換相関エネルギー密度εxc(r)へのプロパティ（コピーせずに参照を返す）
+        */
+        Property<dvector const &> const Exc;
+
+        //! A property.
+        /*!
+            交換相関ポテンシャルVxc(r)へのプロパティ（コピーせずに参照を返す）
+        */
+        Property<dvector const &> const Vxc;
+
+        // #endregion プロパティ
+
+        // #region メンバ変数
+
+    private:
+        //!  A private static member variable (constant expression).
+        /*!
+            これより密度が小さい点では、交換相関エネルギー密度と交換相関ポテンシャルを0とする
+        */
+        static auto constexpr RHOMIN = 1.0E-30;
+
+        //!  A private static member variable (constant expression).
+        /*!
+            Perdew-Zungerの相関のパラメータ（rs < 1）
+        */
+        static auto constexpr PZ_A = 0.0311;
+
+        //!  A private static member variable (constant expression).
+        /*!
+            Perdew-Zungerの相関のパラメータ（rs < 1）
+        */
+        static auto constexpr PZ_B = -0.048;
+
+        //!  A private static member variable (constant expression).
+        /*!
+            Perdew-Zungerの相関のパラメータ（rs < 1）
+        */
+        static auto constexpr PZ_C = 0.0020;
+
+        //!  A private static member variable (constant expression).
+        /*!
+            Perdew-Zungerの相関のパラメータ（rs < 1）
+        */
+        static auto constexpr PZ_D = -0.0116;
+
+        //!  A private static member variable (constant expression).
+        /*!
+            Perdew-Zungerの相関のパラメータ（rs >= 1）
+        */
+        static auto constexpr PZ_GAMMA = -0.1423;
+
+        //!  A private static member variable (constant expression).
+        /*!
+            Perdew-Zungerの相関のパラメータ（rs >= 1）
+        */
+        static auto constexpr PZ_BETA1 = 1.0529;
+
+        //!  A private static member variable (constant expression).
+        /*!
+            Perdew-Zungerの相関のパラメータ（rs >= 1）
+        */
+        static auto constexpr PZ_BETA2 = 0.3334;
+
+        //! A private member variable.
+        /*!
+            交換相関エネルギー密度εxc(r)
+        */
+        dvector exc_;
+
+        //! A private member variable.
+        /*!
+            交換相関ポテンシャルVxc(r)
+        */
+        dvector vxc_;
+
+        // #endregion メンバ変数
+
+        // #region 禁止されたコンストラクタ・メンバ関数
+
+        //! A private constructor (deleted).
+        /*!
+            デフォルトコンストラクタ（禁止）
+        */
+        Xc() = delete;
+
+        //! A private copy constructor (deleted).
+        /*!
+            コピーコンストラクタ（禁止）
+        */
+        Xc(Xc const &) = delete;
+
+        //! A private member function (deleted).
+        /*!
+            operator=()の宣言（禁止）
+            \param コピー元のオブジェクト（未使用）
+            \return コピー元のオブジェクト
+        */
+        Xc & operator=(Xc const &) = delete;
+
+        // #endregion 禁止されたコンストラクタ・メンバ関数
+    };
+}
+
+#endif  // _XC_H_